@@ -4,6 +4,18 @@
 #include "application.hpp"
 #include "model.hpp"
 #include "structs.hpp"
+#include "frame_ring.hpp"
+#include "instance_batch.hpp"
+#include "line_batch.hpp"
+#include "scene_graph.hpp"
+#include "star_catalog.hpp"
+#include "text_batch.hpp"
+#include "texture_array.hpp"
+#include "uniform_handle.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
 
 // gpu representation of model
 
@@ -13,31 +25,20 @@ struct UBO_Data
     glm::fmat4 projection_matrix;
 };
 
-// encapsulates all stars on the scene
-struct StarField
-{
-    std::vector<GLfloat> points;
-    std::vector<GLfloat> colors;
-    int count;
-    GLuint points_vbo;
-    GLuint colors_vbo;
-    GLuint vba;
-    
-    void Init();
-    void render(const shader_program& shader) const;
-};
-
-// encapsulates a circle representing planet's orbit
-struct Orbit
+// body orbiting its parent, placed through its scene graph node
+struct Body
 {
-    std::vector<GLfloat> points;
-    GLuint points_vbo;
-    int count;
-    GLuint vba;
-    
-    void Init();
-    void bind(const shader_program& shader) const;
-    void render(const glm::fmat4& model, const shader_program& shader) const;
+    std::string name;
+    float distance;
+    float rotation;     //angular speed around parent
+    float scale;
+    glm::fvec3 color;
+    int flags;          //shader flags, Cel shading is added when enabled
+    bool normal_map;    //whether normal mapping is added when enabled
+    std::size_t node;
+    std::size_t orbit_node; //circle of orbit, scene_graph::NO_PARENT if not orbiting
+    texture_layer diffuse;  //surface maps, resolved once textures are loaded
+    texture_layer normal;   //the diffuse layer for bodies without normal map
 };
 
 class ApplicationSolar : public Application {
@@ -47,7 +48,8 @@ class ApplicationSolar : public Application {
   // free allocated objects
   ~ApplicationSolar();
 
-  void updateUBO();
+  // upload uniform block data of this frame and bind it
+  void updateUBO() const;
   // update uniform locations and values
   void uploadUniforms();
   // update projection matrix
@@ -63,28 +65,72 @@ class ApplicationSolar : public Application {
  protected:
   void initializeShaderPrograms();
   void initializeGeometry();
+  // build hierarchy of bodies
+  void initializeScene();
   void initializeTextures();
+  // store array layers of the surface maps in bodies and sky
+  void assignTextureLayers(std::map<std::string, texture_layer> const& layers);
   void initializeFramebuffer();
   void initializeUBO();
   void updateView();
+  // queue text, all text is drawn at once at the end of the frame
     void drawText(float x, float y, float size, const std::string& text, glm::fvec4 color) const;
-  // all drawing code of a single planet encapsulated here
-    glm::fmat4 drawPlanet(float distance, float rotation, glm::fmat4 position, float scale, glm::fvec3 color, const std::string& name, int flags) const;
+  // queue a single planet for instanced drawing
+    void drawPlanet(const glm::fmat4& model_matrix, const glm::fmat3& normal_matrix, float scale, glm::fvec3 color,
+                    texture_layer const& diffuse, texture_layer const& normal, int flags, std::size_t& lod_level) const;
 
   // cpu representation of model
   model_object planet_object;
-  StarField star_field;
-  Orbit orbit;
+  // procedural stars and the faintest magnitude drawn
+  std::unique_ptr<star_catalog> m_stars{};
+  float m_star_limit;
+  // transforms of bodies and orbits, animated every frame
+  mutable scene_graph m_scene{};
+  std::vector<Body> m_bodies{};
+  std::size_t m_sky_node;
+  std::vector<std::size_t> m_orbit_nodes{};
+  // nodes of bodies followed by the sky, and their matrices of the current frame
+  std::vector<std::size_t> m_body_nodes{};
+  mutable std::vector<glm::fmat4> m_body_models{};
+  mutable std::vector<glm::fmat4> m_body_views{};
+  mutable std::vector<glm::fmat3> m_body_normals{};
+  // world bounds of bodies without the sky and of orbits, and the visible ones
+  mutable std::vector<bounding_sphere> m_body_spheres{};
+  mutable std::vector<std::size_t> m_visible_bodies{};
+  mutable std::vector<bounding_sphere> m_orbit_spheres{};
+  mutable std::vector<std::size_t> m_visible_orbits{};
+  mutable std::vector<glm::fmat4> m_orbit_matrices{};
   int m_cel;    //Cel shading toggle
   std::map<std::string, GLuint> m_textures{};
+  // surface map of the skysphere, the maps of bodies are kept in m_bodies
+  texture_layer m_sky_layer{};
   int m_nmap;
   GLuint framebuffer; //for off-screen rendering
   GLuint screen_texture; //off-screen rendering target
   int effect; //enabled effects flags
   GLuint quad_vbo; //vertex buffer for a full-screen quad
   GLuint quad_vba;
-  GLuint ubo;
+  // streamed uniform block data, one range per frame
+  std::unique_ptr<frame_ring> m_ubo_ring{};
   UBO_Data ubo_data;
+  // current level of detail of each body and the sky, indexed like m_body_nodes, kept for hysteresis
+  mutable std::vector<std::size_t> m_lod_levels{};
+  // planets collected during render
+  mutable instance_batch m_planet_batch{};
+  // orbit circles collected during render
+  mutable line_batch m_line_batch{};
+  // text collected during render
+  mutable text_batch m_text_batch{};
+  // uniforms set every frame
+  uniform_handle<GLfloat> m_star_limit_magnitude{};
+  uniform_handle<glm::fvec3> m_light_position{};
+  uniform_handle<GLint> m_planet_diffuse{};
+  uniform_handle<GLint> m_planet_normal{};
+  uniform_handle<GLint> m_rtt_texture{};
+  uniform_handle<GLint> m_rtt_effects{};
+  uniform_handle<GLfloat> m_rtt_width{};
+  uniform_handle<GLfloat> m_rtt_height{};
+  uniform_handle<GLint> m_font_texture{};
 };
 
 #endif
\ No newline at end of file
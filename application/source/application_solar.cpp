@@ -4,7 +4,20 @@
 #include "utils.hpp"
 #include "shader_loader.hpp"
 #include "model_loader.hpp"
+#include "mesh_simplifier.hpp"
+#include "quantizer.hpp"
+#include "instance_batch.hpp"
+#include "line_batch.hpp"
+#include "matrix_batch.hpp"
+#include "culling.hpp"
+#include "star_catalog.hpp"
+#include "text_batch.hpp"
+#include "texture_array.hpp"
+#include "texture_cache.hpp"
 #include "texture_loader.hpp"
+#include "uniform_handle.hpp"
+#include "gpu_profiler.hpp"
+#include "gl_state.hpp"
 
 #include <glbinding/gl/gl.h>
 // use gl definitions from glbinding 
@@ -19,7 +32,9 @@ using namespace gl;
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtc/random.hpp>
 
+#include <cstdint>
 #include <iostream>
+#include <limits>
 
 #ifdef __APPLE__
 //assuming __APPLE__ means Retina screen which has 4x smaller pixels
@@ -30,6 +45,21 @@ static const unsigned int VIEWPORT_WIDTH = 640u;
 static const unsigned int VIEWPORT_HEIGHT = 480u;
 #endif
 
+// uniform block binding point of camera matrices
+static const GLuint UBO_BINDING = 0;
+// bytes of uniform data streamed per frame
+static const GLsizeiptr UBO_FRAME_SIZE = 4096;
+// radius of the skysphere around the camera
+static const float SKY_SCALE = 500.0f;
+// orbits are unit circles scaled to their distance
+static const bounding_sphere ORBIT_BOUNDS{glm::fvec3{0.0f}, 1.0f};
+static const glm::fvec4 ORBIT_COLOR{1.0f, 0.0f, 0.0f, 1.0f};
+// stars on a sphere around the sun
+static const std::size_t STAR_COUNT = std::size_t(1) << 20;
+static const float STAR_RADIUS = 50.0f;
+// change of magnitude limit per key press
+static const float STAR_LIMIT_STEP = 0.5f;
+
 //control flags for planet shader execution
 //meant to be combined using | operator
 enum shader_flags{
@@ -48,89 +78,6 @@ enum postprocessing_effects{
 };
 
 
-void StarField::Init()
-{
-    count = 400;    //number of stars
-    //generate random points on a sphere
-    for (int i = 0; i<count; i++)
-    {
-        glm::fvec3 point = glm::sphericalRand(50.0f);
-        points.push_back(point.x);
-        points.push_back(point.y);
-        points.push_back(point.z);
-        
-        colors.push_back(glm::linearRand(0.0f, 1.0f));
-        colors.push_back(glm::linearRand(0.0f, 1.0f));
-        colors.push_back(glm::linearRand(0.0f, 1.0f));
-    }
-    
-    glGenBuffers(1, &points_vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, points_vbo);
-    glBufferData(GL_ARRAY_BUFFER, points.size() * sizeof(GL_FLOAT), &points[0], GL_STATIC_DRAW);
-    glGenBuffers(1, &colors_vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, colors_vbo);
-    glBufferData(GL_ARRAY_BUFFER, colors.size() * sizeof(GL_FLOAT), &colors[0], GL_STATIC_DRAW);
-    
-    glGenVertexArrays(1, &vba);
-    glBindVertexArray(vba);
-    glBindBuffer(GL_ARRAY_BUFFER, points_vbo);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, NULL);
-    glBindBuffer(GL_ARRAY_BUFFER, colors_vbo);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, NULL);
-    glEnableVertexAttribArray(0);
-    glEnableVertexAttribArray(1);
-    
-    //glPointSize(10.0);
-}
-
-void StarField::render(const shader_program& shader) const
-{
-    glUseProgram(shader.handle);
-    
-    glBindVertexArray(vba);
-    glDrawArrays(GL_POINTS, 0, count);
-}
-
-void Orbit::Init()
-{
-    count = 100;    //number of points forming a circle
-    
-    //generate equidistant points on a circle
-    float step = 2 * M_PI / count;
-    for (int i = 0; i<count; i++)
-    {
-        points.push_back(cos(i * step));
-        points.push_back(0.0f);
-        points.push_back(sin(i * step));
-    }
-    
-    glGenBuffers(1, &points_vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, points_vbo);
-    glBufferData(GL_ARRAY_BUFFER, points.size() * sizeof(GL_FLOAT), &points[0], GL_STATIC_DRAW);
-    
-    glGenVertexArrays(1, &vba);
-    glBindVertexArray(vba);
-    glBindBuffer(GL_ARRAY_BUFFER, points_vbo);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, NULL);
-    glEnableVertexAttribArray(0);
-    
-    //glPointSize(10.0);
-}
-
-void Orbit::bind(const shader_program& shader) const
-{
-    glUseProgram(shader.handle);
-    
-    glBindVertexArray(vba);
-}
-
-void Orbit::render(const glm::fmat4& model, const shader_program& shader) const
-{
-    glUniformMatrix4fv(shader.u_locs.at("ModelMatrix"),
-                       1, GL_FALSE, glm::value_ptr(model));
-    glDrawArrays(GL_LINE_LOOP, 0, count);
-}
-
 ApplicationSolar::ApplicationSolar(std::string const& resource_path)
  :Application{resource_path}
  ,planet_object{}
@@ -140,12 +87,47 @@ ApplicationSolar::ApplicationSolar(std::string const& resource_path)
     effect = FX_NONE;
     initializeUBO();
     initializeGeometry();
+    initializeScene();
     initializeShaderPrograms();
     initializeTextures();
     initializeFramebuffer();
     m_view_transform = glm::translate(m_view_transform, glm::fvec3{0.0f, 0.0f, 35.0f});
-    star_field.Init();
-    orbit.Init();
+    m_stars.reset(new star_catalog{STAR_COUNT, STAR_RADIUS});
+    m_star_limit = m_stars->faintest();
+}
+
+void ApplicationSolar::initializeScene()
+{
+    // adds body with its orbit circle around parent, returns node of body
+    auto add_body = [&](std::string const& name, std::size_t parent, float distance, float rotation, float scale,
+                        glm::fvec3 color, int flags, bool normal_map) {
+        Body body{name, distance, rotation, scale, color, flags, normal_map, m_scene.add(parent), scene_graph::NO_PARENT};
+        if (distance > 0.0f) {
+            body.orbit_node = m_scene.add(parent, glm::scale(glm::fmat4{}, glm::fvec3{distance}));
+            m_orbit_nodes.push_back(body.orbit_node);
+        }
+        m_bodies.push_back(body);
+        m_body_nodes.push_back(body.node);
+        return body.node;
+    };
+    std::size_t const origin = scene_graph::NO_PARENT;
+
+    add_body("sun", origin, 0.0f, 0.0f, 3.5f, glm::fvec3{1.0, 0.0, 0.0}, NONE, false);  //the Sun - emissive source of light, so no Phong shading
+    add_body("mercury", origin, 5.0f, 1.0f, 1.0f, glm::fvec3{0.0, 1.0, 0.0}, SHADE, true);
+    add_body("venus", origin, 7.0f, 0.95f, 1.5f, glm::fvec3{0.0, 0.0, 1.0}, SHADE, true);
+    std::size_t earth = add_body("earth", origin, 11.0f, 0.9f, 0.75f, glm::fvec3{0.9, 0.7, 1.0}, SHADE, true);
+    add_body("moon", earth, 2.0f, 1.5f, 0.5f, glm::fvec3{0.4, 0.5 , 0.8}, SHADE, false); //a moon
+    add_body("mars", origin, 15.0f, 0.85f, 1.0f, glm::fvec3{0.5, 0.9, 0.1}, SHADE, true);
+    add_body("jupiter", origin, 19.0f, 0.8f, 1.5f, glm::fvec3{0.2, 0.3, 1.0}, SHADE, false);
+    add_body("saturn", origin, 23.0f, 0.7f, 2.0f, glm::fvec3{0.1, 0.6, 0.4}, SHADE, false);
+    add_body("uranus", origin, 27.0f, 0.65f, 1.5f, glm::fvec3{1.0, 0.3, 0.7}, SHADE, false);
+    add_body("neptune", origin, 31.0f, 0.6f, 0.75f, glm::fvec3{0.4, 0.1, 0.9}, SHADE, false);
+    add_body("pluto", origin, 36.0f, 0.4f, 0.6f, glm::fvec3{0.1, 0.5, 0.2}, SHADE, true);
+
+    // skysphere follows the camera
+    m_sky_node = m_scene.add();
+    m_body_nodes.push_back(m_sky_node);
+    m_lod_levels.assign(m_body_nodes.size(), 0);
 }
 
 void ApplicationSolar::initializeFramebuffer()
@@ -187,295 +169,312 @@ void ApplicationSolar::initializeFramebuffer()
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
-// helper function that loads a texture from a file and registers it with OpenGL
-static GLuint loadTexture(const std::string& name, bool font = false)
+// helper function that registers a decoded texture with OpenGL
+static GLuint loadTexture(const pixel_data& data, bool font = false)
 {
-    pixel_data data = texture_loader::file(name);
+    //all mip levels, sampled trilinear
+    if (!font)
+    {
+        return utils::create_texture_object(data).handle;
+    }
+
     GLuint tex;
     glGenTextures(1, &tex);
     glBindTexture(GL_TEXTURE_2D, tex);
     
     //font textures need special treatment
-    if (font)
-    {
-        //load texture with alpha channel
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, data.width, data.height, 0, data.channels, data.channel_type, data.ptr());
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        
-        //ensure the texture doesn't wrap around at the edges - this causes artifacts
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    }
-    else
-    {
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, data.width, data.height, 0, data.channels, data.channel_type, data.ptr());
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    }
+    //load texture with alpha channel
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, data.width, data.height, 0, data.channels, data.channel_type, data.ptr());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    
+    //ensure the texture doesn't wrap around at the edges - this causes artifacts
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     return tex;
 }
 
 void ApplicationSolar::initializeUBO()
 {
-    glGenBuffers(1, &ubo);
-    glBindBuffer(GL_UNIFORM_BUFFER, ubo);
-    glBufferData(GL_UNIFORM_BUFFER, sizeof(ubo_data), &ubo_data, GL_DYNAMIC_DRAW);
-    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    // room for all uniform blocks of a frame, three frames in flight
+    m_ubo_ring.reset(new frame_ring{GL_UNIFORM_BUFFER, UBO_FRAME_SIZE});
 }
 
 void ApplicationSolar::initializeTextures()
 {
-    // diffuse maps
-    m_textures.insert(std::pair<std::string, GLuint>("sun", loadTexture(m_resource_path + "textures/sunmap.png")));
-    m_textures.insert(std::pair<std::string, GLuint>("mercury", loadTexture(m_resource_path + "textures/mercurymap.png")));
-    m_textures.insert(std::pair<std::string, GLuint>("venus", loadTexture(m_resource_path + "textures/venusmap.png")));
-    m_textures.insert(std::pair<std::string, GLuint>("earth", loadTexture(m_resource_path + "textures/earthmap1k.png")));
-    m_textures.insert(std::pair<std::string, GLuint>("mars", loadTexture(m_resource_path + "textures/marsmap1k.png")));
-    m_textures.insert(std::pair<std::string, GLuint>("jupiter", loadTexture(m_resource_path + "textures/jupitermap.png")));
-    m_textures.insert(std::pair<std::string, GLuint>("saturn", loadTexture(m_resource_path + "textures/saturnmap.png")));
-    m_textures.insert(std::pair<std::string, GLuint>("uranus", loadTexture(m_resource_path + "textures/uranusmap.png")));
-    m_textures.insert(std::pair<std::string, GLuint>("neptune", loadTexture(m_resource_path + "textures/neptunemap.png")));
-    m_textures.insert(std::pair<std::string, GLuint>("pluto", loadTexture(m_resource_path + "textures/plutomap1k.png")));
-    m_textures.insert(std::pair<std::string, GLuint>("moon", loadTexture(m_resource_path + "textures/moonmap1k.png")));
-    m_textures.insert(std::pair<std::string, GLuint>("sky", loadTexture(m_resource_path + "textures/sky.png")));
-    
-    //normal maps
-    m_textures.insert(std::pair<std::string, GLuint>("earth_normal", loadTexture(m_resource_path + "textures/earth_normal.png")));
-    m_textures.insert(std::pair<std::string, GLuint>("mars_normal", loadTexture(m_resource_path + "textures/mars_normal.png")));
-    m_textures.insert(std::pair<std::string, GLuint>("mercury_normal", loadTexture(m_resource_path + "textures/mercury_normal.png")));
-    m_textures.insert(std::pair<std::string, GLuint>("pluto_normal", loadTexture(m_resource_path + "textures/pluto_normal.png")));
-    m_textures.insert(std::pair<std::string, GLuint>("venus_normal", loadTexture(m_resource_path + "textures/venus_normal.png")));
-    
-    m_textures.insert(std::pair<std::string, GLuint>("font_texture", loadTexture(m_resource_path + "textures/a-font.png", true)));
+    std::vector<std::pair<std::string, std::string>> const files = {
+        // diffuse maps
+        {"sun", "sunmap.png"},
+        {"mercury", "mercurymap.png"},
+        {"venus", "venusmap.png"},
+        {"earth", "earthmap1k.png"},
+        {"mars", "marsmap1k.png"},
+        {"jupiter", "jupitermap.png"},
+        {"saturn", "saturnmap.png"},
+        {"uranus", "uranusmap.png"},
+        {"neptune", "neptunemap.png"},
+        {"pluto", "plutomap1k.png"},
+        {"moon", "moonmap1k.png"},
+        {"sky", "sky.png"},
+        //normal maps
+        {"earth_normal", "earth_normal.png"},
+        {"mars_normal", "mars_normal.png"},
+        {"mercury_normal", "mercury_normal.png"},
+        {"pluto_normal", "pluto_normal.png"},
+        {"venus_normal", "venus_normal.png"},
+        {"font_texture", "a-font.png"}
+    };
+    // normal maps hold directions, they are filtered and compressed as data
+    auto is_normal_map = [](std::string const& name) {
+        return name.size() > 7 && name.compare(name.size() - 7, 7, "_normal") == 0;
+    };
+    std::vector<std::string> paths{};
+    for (auto const& file : files)
+    {
+        paths.push_back(m_resource_path + "textures/" + file.second);
+    }
+
+    if (texture_cache::supported())
+    {
+        // block compressed mip chains, compressed on first start and mapped from cache files next to the images
+        // glyphs are sampled without mips, compression would blur their edges
+        std::string font_path{};
+        std::vector<std::string> map_names{};
+        std::vector<std::string> map_paths{};
+        std::vector<texture_cache::usage> contents{};
+        for (std::size_t i = 0; i < files.size(); ++i)
+        {
+            std::string const& name = files[i].first;
+            if (name == "font_texture")
+            {
+                font_path = paths[i];
+                continue;
+            }
+            map_names.push_back(name);
+            map_paths.push_back(paths[i]);
+            contents.push_back(is_normal_map(name) ? texture_cache::usage::normal : texture_cache::usage::color);
+        }
+        texture_loader::compress_batch compressed{map_paths, contents};
+        // the font is uploaded while the maps are prepared by the workers
+        m_textures.insert(std::pair<std::string, GLuint>("font_texture", loadTexture(texture_loader::file(font_path), true)));
+        std::map<std::string, texture_cache::cached_texture> textures{};
+        for (std::size_t i = compressed.next_ready(); i < compressed.size(); i = compressed.next_ready())
+        {
+            textures.emplace(map_names[i], compressed.texture(i).get());
+        }
+        assignTextureLayers(texture_array::build(textures));
+        return;
+    }
+
+    // decode all files in parallel, each image is handled as soon as it is ready
+    texture_loader::decode_batch decoded{paths};
+    std::map<std::string, pixel_data> images{};
+    std::set<std::string> normal_maps{};
+    for (std::size_t i = decoded.next_ready(); i < decoded.size(); i = decoded.next_ready())
+    {
+        std::string const& name = files[i].first;
+        if (name == "font_texture")
+        {
+            m_textures.insert(std::pair<std::string, GLuint>(name, loadTexture(decoded.image(i).get(), true)));
+        }
+        else
+        {
+            images[name] = decoded.image(i).get();
+            if (is_normal_map(name))
+            {
+                normal_maps.insert(name);
+            }
+        }
+    }
+
+    // planet maps of similar size share array textures, so planets are drawn without rebinding
+    assignTextureLayers(texture_array::build(images, 1024, normal_maps));
 }
 
-void ApplicationSolar::drawText(float x, float y, float size, const std::string& text, glm::fvec4 color) const
+void ApplicationSolar::assignTextureLayers(std::map<std::string, texture_layer> const& layers)
 {
-    // size of a letter in texture coordinates for 16 * 16 letter texture
-    float tex_letter_size = 1.0/16;
-    
-    // storage for our vetrex arrays
-    std::vector<GLfloat> positions(text.length() * 3 * 6);
-    std::vector<GLfloat> colors(text.length() * 4 * 6, 1.0);
-    std::vector<GLfloat> tex_coords(text.length() * 2 * 6);
-    
-    // drawText operates in (0.0, 0.0) to (800.0, 600.0) space
-    // we need to translate it to device-independent space from (-1.0, -1.0) to (1.0, 1.0)
-    float x_size = size / 800.0;
-    float y_size = size / 600.0;
-    float rx = (x / 400.0) - 1.0;
-    float ry = (y / 300.0) - 1.0;
-    
-    // vertex array for our whole text
-    GLuint vba;
-    
-    glGenVertexArrays(1, &vba);
-    glBindVertexArray(vba);
-    
-    // compute vertex data for each letter
-    // we will be drawing two triangles for each letter
-    for(int i = 0; i < text.length(); i++)
+    // resolved once, so drawing does not look up names
+    for (auto& body : m_bodies)
     {
-        // compute vetrex positions for a letter
-        int p = i * 6 * 3;
-        positions[p] = rx + i * x_size; positions[p + 1] = ry;
-        positions[p + 3] = rx + (i + 1.0) * x_size; positions[p + 4] = ry;
-        positions[p + 6] = rx + i * x_size; positions[p + 7] = ry + y_size;
-        positions[p + 9] = rx + i * x_size; positions[p + 10] = ry + y_size;
-        positions[p + 12] = rx + (i + 1.0) * x_size; positions[p + 13] = ry;
-        positions[p + 15] = rx + (i + 1.0) * x_size; positions[p + 16] = ry + y_size;
-        
-        // copy the input color to all vertices
-        int c = i * 6 * 4;
-        colors[c] = colors[c + 4] = colors[c + 8] = colors[c + 12] = colors[c + 16] = colors[c + 20] = color[0];
-        colors[c + 1] = colors[c + 5] = colors[c + 9] = colors[c + 13] = colors[c + 17] = colors[c + 21] = color[1];
-        colors[c + 2] = colors[c + 6] = colors[c + 10] = colors[c + 14] = colors[c + 18] = colors[c + 22] = color[2];
-        colors[c + 3] = colors[c + 7] = colors[c + 11] = colors[c + 15] = colors[c + 19] = colors[c + 23] = color[3];
-        
-        // compute texture coordinates of the letter
-        // the texture is indexed from top left and has letters in ASCII-order
-        int tx = text[i] % 16;
-        int ty = 15 - text[i] / 16;
-        
-        // compute texture coordinates for each vertex
-        int t = i * 6 * 2;
-        
-        tex_coords[t] = tx * tex_letter_size; tex_coords[t + 1] = ty * tex_letter_size;
-        tex_coords[t + 2] = (tx + 1) * tex_letter_size; tex_coords[t + 3] = ty * tex_letter_size;
-        tex_coords[t + 4] = tx * tex_letter_size; tex_coords[t + 5] = (ty + 1) * tex_letter_size;
-        tex_coords[t + 6] = tx * tex_letter_size; tex_coords[t + 7] = (ty + 1) * tex_letter_size;
-        tex_coords[t + 8] = (tx + 1) * tex_letter_size; tex_coords[t + 9] = ty * tex_letter_size;
-        tex_coords[t + 10] = (tx + 1) * tex_letter_size; tex_coords[t + 11] = (ty + 1) * tex_letter_size;
+        body.diffuse = layers.at(body.name);
+        body.normal = body.normal_map ? layers.at(body.name + "_normal") : body.diffuse;
     }
-    
-    GLuint vbo[3];
-    glGenBuffers(3, vbo);
-    
-    // copy vertex positions to GPU
-    glBindBuffer(GL_ARRAY_BUFFER, vbo[0]);
-    glBufferData(GL_ARRAY_BUFFER, positions.size() * sizeof(float), &positions[0], GL_STATIC_DRAW);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, NULL);
-    glEnableVertexAttribArray(0);
-    
-    // copy vertex colors to GPU
-    glBindBuffer(GL_ARRAY_BUFFER, vbo[1]);
-    glBufferData(GL_ARRAY_BUFFER, colors.size() * sizeof(float), &colors[0], GL_STATIC_DRAW);
-    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, 0, NULL);
-    glEnableVertexAttribArray(1);
-    
-    // copy vertex texture coordinates to GPU
-    glBindBuffer(GL_ARRAY_BUFFER, vbo[2]);
-    glBufferData(GL_ARRAY_BUFFER, tex_coords.size() * sizeof(float), &tex_coords[0], GL_STATIC_DRAW);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 0, NULL);
-    glEnableVertexAttribArray(2);
-    
-    // activate texture and shader
-    glUseProgram(m_shaders.at("font").handle);
-    glActiveTexture(GL_TEXTURE0);
-    glUniform1i(m_shaders.at("font").u_locs.at("tex"), 0);
-    glBindTexture(GL_TEXTURE_2D, m_textures.at("font_texture"));
-    
-    // enable alpha blending
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    
-    // draw the text
-    glDrawArrays(GL_TRIANGLES, 0, text.size() * 6);
-    
-    // clean up created buffers
-    glDisableVertexAttribArray(0);
-    glDisableVertexAttribArray(1);
-    glDisableVertexAttribArray(2);
-    glDeleteBuffers(3, vbo);
-    glDeleteVertexArrays(1, &vba);
+    m_sky_layer = layers.at("sky");
+}
 
+void ApplicationSolar::drawText(float x, float y, float size, const std::string& text, glm::fvec4 color) const
+{
+    // drawn with all other text of the frame
+    m_text_batch.add(x, y, size, text, color);
 }
 
 void ApplicationSolar::render() const {
+  // animate bodies around their parents
+  float time = float(glfwGetTime());
+  for (auto const& body : m_bodies) {
+    glm::fmat4 local = glm::rotate(glm::fmat4{}, time * body.rotation, glm::fvec3{0.0f, 1.0f, 0.0f});
+    local = glm::translate(local, glm::fvec3{0.0f, 0.0f, -body.distance});
+    m_scene.set_local(body.node, glm::scale(local, glm::fvec3{body.scale}));
+  }
+  // we render skysphere as an inside of a planet with shading disabled
+  // the position of the skysphere is always the same as the position of the camera
+  glm::fmat4 camera_pos = glm::translate(glm::fmat4{}, glm::vec3(m_view_transform[3]));
+  m_scene.set_local(m_sky_node, glm::scale(camera_pos, glm::fvec3{SKY_SCALE}));
+  m_scene.update();
+
+  // extra matrices for normal transformation to keep them orthogonal to surface
+  // computed for all bodies at once, the sky comes last
+  m_scene.gather(m_body_nodes, m_body_models);
+  m_body_views.resize(m_body_models.size());
+  m_body_normals.resize(m_body_models.size());
+  glm::fmat4 view_matrix = matrix_batch::affine_inverse(m_view_transform);
+  matrix_batch::multiply(view_matrix, m_body_models.data(), m_body_views.data(), m_body_models.size());
+  matrix_batch::normal_matrices(m_body_views.data(), m_body_normals.data(), m_body_models.size());
+
+  // find visible bodies and orbits before drawing, the sky surrounds the camera and is always drawn
+  culling::frustum volume = culling::extract(m_view_projection * view_matrix);
+  m_body_spheres.resize(m_bodies.size());
+  culling::transform(planet_object.bounds, m_body_models.data(), m_bodies.size(), m_body_spheres.data());
+  m_visible_bodies.clear();
+  culling::cull(volume, m_body_spheres.data(), m_body_spheres.size(), m_visible_bodies);
+
+  m_scene.gather(m_orbit_nodes, m_orbit_matrices);
+  m_orbit_spheres.resize(m_orbit_matrices.size());
+  culling::transform(ORBIT_BOUNDS, m_orbit_matrices.data(), m_orbit_matrices.size(), m_orbit_spheres.data());
+  m_visible_orbits.clear();
+  culling::cull(volume, m_orbit_spheres.data(), m_orbit_spheres.size(), m_visible_orbits);
+
+  // camera matrices of this frame for all programs
+  m_ubo_ring->next_frame();
+  updateUBO();
     
   //render off-screen
-  glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
-  glViewport(0, 0, VIEWPORT_WIDTH, VIEWPORT_HEIGHT);
+  gl_state::bind_framebuffer(GL_FRAMEBUFFER, framebuffer);
+  gl_state::viewport(0, 0, VIEWPORT_WIDTH, VIEWPORT_HEIGHT);
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     
-  star_field.render(m_shaders.at("starfield"));
+  // bright stars of cells in view with one draw, point size grows with brightness
+  gpu_profiler::begin("starfield");
+  gl_state::use_program(m_shaders.at("starfield").handle);
+  m_star_limit_magnitude.set(m_star_limit);
+  gl_state::enable(GL_PROGRAM_POINT_SIZE);
+  m_stars->draw(volume, m_star_limit);
+  gl_state::disable(GL_PROGRAM_POINT_SIZE);
+  gpu_profiler::end();
     
   // bind shader to upload uniforms
-  glUseProgram(m_shaders.at("planet").handle);
-    glUniform3fv(m_shaders.at("planet").u_locs.at("LightPosition"), 1, glm::value_ptr(glm::fvec3{0.0f, 0.0f, 0.0f}));
+  gl_state::use_program(m_shaders.at("planet").handle);
+    m_light_position.set(glm::fvec3{0.0f, 0.0f, 0.0f});
+  m_planet_diffuse.set(0);
+  m_planet_normal.set(1);
+
+  //queue all visible planets
+  for (std::size_t i : m_visible_bodies) {
+    Body const& body = m_bodies[i];
+    int flags = body.flags | m_cel | (body.normal_map ? m_nmap : 0);
+    drawPlanet(m_body_models[i], m_body_normals[i], body.scale, body.color, body.diffuse, body.normal, flags, m_lod_levels[i]);
+  }
+  drawPlanet(m_body_models.back(), m_body_normals.back(), SKY_SCALE, glm::fvec3{1.0, 1.0, 1.0}, m_sky_layer, m_sky_layer, NONE, m_lod_levels.back());
 
-  // bind the planet VAO to draw
-  glBindVertexArray(planet_object.vertex_AO);
-    
-  //draw all planets
-  drawPlanet(0.0f, 0.0f, glm::fmat4{}, 3.5f, glm::fvec3{1.0, 0.0, 0.0}, "sun", NONE | m_cel);  //the Sun - emissive source of light, so no Phong shading
-    
-  drawPlanet(5.0f, 1.0f, glm::fmat4{}, 1.0f, glm::fvec3{0.0, 1.0, 0.0}, "mercury", SHADE | m_cel | m_nmap
-             );
-  drawPlanet(7.0f, 0.95f, glm::fmat4{}, 1.5f, glm::fvec3{0.0, 0.0, 1.0}, "venus", SHADE | m_cel | m_nmap);
-  glm::fmat4 planet_pos = drawPlanet(11.0f, 0.9f, glm::fmat4{}, 0.75f, glm::fvec3{0.9, 0.7, 1.0}, "earth", SHADE | m_cel | m_nmap);
-  drawPlanet(2.0f, 1.5f, planet_pos, 0.5f, glm::fvec3{0.4, 0.5 , 0.8}, "moon", SHADE | m_cel); //a moon
-  drawPlanet(15.0f, 0.85f, glm::fmat4{}, 1.0f, glm::fvec3{0.5, 0.9, 0.1}, "mars", SHADE | m_cel | m_nmap);
-  drawPlanet(19.0f, 0.8f, glm::fmat4{}, 1.5f, glm::fvec3{0.2, 0.3, 1.0}, "jupiter", SHADE | m_cel);
-  drawPlanet(23.0f, 0.7f, glm::fmat4{}, 2.0f, glm::fvec3{0.1, 0.6, 0.4}, "saturn", SHADE | m_cel);
-  drawPlanet(27.0f, 0.65f, glm::fmat4{}, 1.5f, glm::fvec3{1.0, 0.3, 0.7}, "uranus", SHADE | m_cel);
-  drawPlanet(31.0f, 0.6f, glm::fmat4{}, 0.75f, glm::fvec3{0.4, 0.1, 0.9}, "neptune", SHADE | m_cel);
-  drawPlanet(36.0f, 0.4f, glm::fmat4{}, 0.6f, glm::fvec3{0.1, 0.5, 0.2}, "pluto", SHADE | m_cel | m_nmap);
-  
-  // we render skysphere as an inside of a planet with shading disabled
-  // the position of the skysphere is always the same as the position of the camera
-  glm::fmat4 camera_pos = glm::translate(glm::fmat4{}, glm::vec3(m_view_transform[3]));
-  drawPlanet(0.0f, 0.0f, camera_pos, 500.0f, glm::fvec3{1.0, 1.0, 1.0}, "sky", NONE);
+  // one instanced draw per texture and detail level
+  gpu_profiler::begin("planets");
+  m_planet_batch.draw(planet_object);
+  gpu_profiler::end();
     //drawPlanet(0.0f, 0.0f, camera_pos, 500.0f, glm::fvec3{1.0, 1.0, 1.0}, "font_texture", NONE);
     
-  //bind orbit shader and send common uniforms
-  orbit.bind(m_shaders.at("orbit"));
-    
-  //draw all orbits
-  orbit.render(glm::scale(glm::fmat4{}, glm::fvec3{5.0f, 5.0f, 5.0f}), m_shaders.at("orbit"));
-  orbit.render(glm::scale(glm::fmat4{}, glm::fvec3{7.0f, 7.0f, 7.0f}), m_shaders.at("orbit"));
-  orbit.render(glm::scale(glm::fmat4{}, glm::fvec3{11.0f, 11.0f, 11.0f}), m_shaders.at("orbit"));
-  orbit.render(glm::scale(planet_pos, glm::fvec3{2.0f, 2.0f, 2.0f}), m_shaders.at("orbit")); // a moon
-  orbit.render(glm::scale(glm::fmat4{}, glm::fvec3{15.0f, 15.0f, 15.0f}), m_shaders.at("orbit"));
-  orbit.render(glm::scale(glm::fmat4{}, glm::fvec3{19.0f, 19.0f, 19.0f}), m_shaders.at("orbit"));
-  orbit.render(glm::scale(glm::fmat4{}, glm::fvec3{23.0f, 23.0f, 23.0f}), m_shaders.at("orbit"));
-  orbit.render(glm::scale(glm::fmat4{}, glm::fvec3{27.0f, 27.0f, 27.0f}), m_shaders.at("orbit"));
-  orbit.render(glm::scale(glm::fmat4{}, glm::fvec3{31.0f, 31.0f, 31.0f}), m_shaders.at("orbit"));
-  orbit.render(glm::scale(glm::fmat4{}, glm::fvec3{36.0f, 36.0f, 36.0f}), m_shaders.at("orbit"));
+  //queue all visible orbits with segments for their size on screen
+  for (std::size_t i : m_visible_orbits) {
+    glm::fmat4 const& orbit = m_orbit_matrices[i];
+    float radius = glm::length(glm::fvec3{orbit[0]});
+    float camera_distance = glm::distance(glm::fvec3{orbit[3]}, glm::fvec3{m_view_transform[3]});
+    // camera inside the circle sees its near side up close
+    float radius_pixels = std::numeric_limits<float>::infinity();
+    if (camera_distance > radius) {
+      radius_pixels = radius * m_view_projection[1][1] * 0.5f * float(VIEWPORT_HEIGHT) / camera_distance;
+    }
+    m_line_batch.add_circle(orbit, ORBIT_COLOR, line_batch::segments(radius_pixels));
+  }
+
+  // one instanced draw per circle level
+  gpu_profiler::begin("orbits");
+  gl_state::use_program(m_shaders.at("orbit").handle);
+  m_line_batch.draw();
+  gpu_profiler::end();
     
+  gpu_profiler::begin("text");
     drawText(0, 0, 32, "Test", glm::fvec4{1.0, 0.0, 0.0, 1.0});
     drawText(400, 300, 24, "QWERTZUIOP!/()cjvfnjnvjn22334$%&", glm::vec4{0.0, 1.0, 0.0, 1.0});
+  // activate texture and shader once for all queued text
+  gl_state::use_program(m_shaders.at("font").handle);
+  gl_state::active_texture(GL_TEXTURE0);
+  m_font_texture.set(0);
+  gl_state::bind_texture(GL_TEXTURE_2D, m_textures.at("font_texture"));
+  // enable alpha blending
+  gl_state::enable(GL_BLEND);
+  gl_state::blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  m_text_batch.draw();
+  gl_state::disable(GL_BLEND);
+  gpu_profiler::end();
     
   //render to screen
-  glBindFramebuffer(GL_FRAMEBUFFER, 0);
-  glViewport(0, 0, VIEWPORT_WIDTH, VIEWPORT_HEIGHT);
+  gpu_profiler::begin("post-processing");
+  gl_state::bind_framebuffer(GL_FRAMEBUFFER, 0);
+  gl_state::viewport(0, 0, VIEWPORT_WIDTH, VIEWPORT_HEIGHT);
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     
-  glUseProgram(m_shaders.at("rtt").handle);
-  glActiveTexture(GL_TEXTURE0);
-  glBindTexture(GL_TEXTURE_2D, screen_texture);
-  glUniform1i(m_shaders.at("rtt").u_locs.at("tex"), 0);
-  glUniform1i(m_shaders.at("rtt").u_locs.at("effects"), effect);
-  glUniform1f(m_shaders.at("rtt").u_locs.at("one_over_screen_width"), 1.0f/VIEWPORT_WIDTH);
-  glUniform1f(m_shaders.at("rtt").u_locs.at("one_over_screen_height"), 1.0f/VIEWPORT_HEIGHT);
-  glBindVertexArray(quad_vba);
+  gl_state::use_program(m_shaders.at("rtt").handle);
+  gl_state::active_texture(GL_TEXTURE0);
+  gl_state::bind_texture(GL_TEXTURE_2D, screen_texture);
+  m_rtt_texture.set(0);
+  m_rtt_effects.set(effect);
+  m_rtt_width.set(1.0f/VIEWPORT_WIDTH);
+  m_rtt_height.set(1.0f/VIEWPORT_HEIGHT);
+  gl_state::bind_vertex_array(quad_vba);
   glDrawArrays(GL_TRIANGLES, 0, 6);
+  gpu_profiler::end();
 }
 
-glm::fmat4 ApplicationSolar::drawPlanet(float distance, float rotation, glm::fmat4 position, float scale, glm::fvec3 color, const std::string& name, int flags) const
+void ApplicationSolar::drawPlanet(const glm::fmat4& model_matrix, const glm::fmat3& normal_matrix, float scale, glm::fvec3 color,
+                                  texture_layer const& diffuse, texture_layer const& normal, int flags, std::size_t& lod_level) const
 {
-    glUniform1i(m_shaders.at("planet").u_locs.at("flags"), flags);
-    glUniform3fv(m_shaders.at("planet").u_locs.at("Color"), 1, glm::value_ptr(color));
-    glm::fmat4 model_matrix = glm::rotate(position, float(glfwGetTime()) * rotation, glm::fvec3{0.0f, 1.0f, 0.0f});
-    model_matrix = glm::translate(model_matrix, glm::fvec3{0.0f, 0.0f, -distance});
-    model_matrix = glm::scale(model_matrix, glm::fvec3{scale, scale, scale});
-    glUniformMatrix4fv(m_shaders.at("planet").u_locs.at("ModelMatrix"),
-                       1, GL_FALSE, glm::value_ptr(model_matrix));
-    
-    // extra matrix for normal transformation to keep them orthogonal to surface
-    glm::fmat4 normal_matrix = glm::inverseTranspose(glm::inverse(m_view_transform) * model_matrix);
-    glUniformMatrix4fv(m_shaders.at("planet").u_locs.at("NormalMatrix"),
-                       1, GL_FALSE, glm::value_ptr(normal_matrix));
-    
-    // texture channel 0 - diffuse map
-    glActiveTexture(GL_TEXTURE0);
-    glUniform1i(m_shaders.at("planet").u_locs.at("texDiffuse"), 0);
-    glBindTexture(GL_TEXTURE_2D, m_textures.at(name));
-    
-    
-    if ((flags & NORMAL_MAP) > 0)
-    {
-        glActiveTexture(GL_TEXTURE1);
-        glUniform1i(m_shaders.at("planet").u_locs.at("texNormal"), 1);
-        glBindTexture(GL_TEXTURE_2D, m_textures.at(name + "_normal"));
+    body_instance instance{};
+    instance.model_matrix = model_matrix;
+    instance.normal_matrix = normal_matrix;
+    instance.color = color;
+    instance.flags = flags;
+
+    // projected size of one model unit in pixels, camera inside the sphere needs full detail
+    float camera_distance = glm::distance(glm::fvec3{model_matrix[3]}, glm::fvec3{m_view_transform[3]});
+    float pixels_per_unit = std::numeric_limits<float>::infinity();
+    if (camera_distance > scale) {
+      pixels_per_unit = scale * m_view_projection[1][1] * 0.5f * float(VIEWPORT_HEIGHT) / camera_distance;
     }
-    glDrawElements(planet_object.draw_mode, planet_object.num_elements, model::INDEX.type, NULL);
-    
-    //return planet's transform - if passed later as position, allows for creating moons
-    return model_matrix;
+    lod_level = mesh_simplifier::select_level(planet_object.lods, pixels_per_unit, lod_level);
+
+    // texture channel 0 - diffuse map, channel 1 - normal map
+    instance.layer = diffuse.layer;
+    // without normal map the unused channel gets the diffuse array, so both kinds of planets share draws
+    texture_layer const& used_normal = (flags & NORMAL_MAP) > 0 ? normal : diffuse;
+    instance.normal_layer = used_normal.layer;
+    m_planet_batch.add(instance, diffuse.texture, used_normal.texture, lod_level);
 }
 
-void ApplicationSolar::updateUBO()
+void ApplicationSolar::updateUBO() const
 {
-    //upload uniform buffer data to GPU
-    glBindBuffer(GL_UNIFORM_BUFFER, ubo);
-    GLvoid* ptr = glMapBuffer(GL_UNIFORM_BUFFER, GL_WRITE_ONLY);
-    memcpy(ptr, &ubo_data, sizeof(ubo_data));
-    glUnmapBuffer(GL_UNIFORM_BUFFER);
+    //upload uniform buffer data to GPU, into memory no earlier frame still reads
+    ring_range range = m_ubo_ring->upload(ubo_data);
+    m_ubo_ring->bind(UBO_BINDING, range);
 }
 
 void ApplicationSolar::updateView() {
   // vertices are transformed in camera space, so camera transform must be inverted
-  glm::fmat4 view_matrix = glm::inverse(m_view_transform);
+  glm::fmat4 view_matrix = matrix_batch::affine_inverse(m_view_transform);
 
   ubo_data.view_matrix = view_matrix;
-  updateUBO();
 }
 
 void ApplicationSolar::updateProjection() {
   ubo_data.projection_matrix = m_view_projection;
-  updateUBO();
 }
 
 // update uniform locations
@@ -483,28 +482,22 @@ void ApplicationSolar::uploadUniforms() {
   updateUniformLocations();
   
   // bind new shader
-  glUseProgram(m_shaders.at("planet").handle);
+  gl_state::use_program(m_shaders.at("planet").handle);
   
-  glBindBuffer(GL_UNIFORM_BUFFER, ubo);
-  unsigned int block_index = glGetUniformBlockIndex(m_shaders.at("planet").handle, "ubo_data");
-  glUniformBlockBinding(m_shaders.at("planet").handle, block_index, 0);
-  glBindBufferBase(GL_UNIFORM_BUFFER, block_index, ubo);
+  unsigned int block_index = uniform_block_index(m_shaders.at("planet"), "ubo_data");
+  glUniformBlockBinding(m_shaders.at("planet").handle, block_index, UBO_BINDING);
     
     // bind new shader
-    glUseProgram(m_shaders.at("starfield").handle);
+    gl_state::use_program(m_shaders.at("starfield").handle);
     
-    glBindBuffer(GL_UNIFORM_BUFFER, ubo);
-    block_index = glGetUniformBlockIndex(m_shaders.at("starfield").handle, "ubo_data");
-    glUniformBlockBinding(m_shaders.at("starfield").handle, block_index, 0);
-    glBindBufferBase(GL_UNIFORM_BUFFER, block_index, ubo);
+    block_index = uniform_block_index(m_shaders.at("starfield"), "ubo_data");
+    glUniformBlockBinding(m_shaders.at("starfield").handle, block_index, UBO_BINDING);
     
     // bind new shader
-    glUseProgram(m_shaders.at("orbit").handle);
+    gl_state::use_program(m_shaders.at("orbit").handle);
     
-    glBindBuffer(GL_UNIFORM_BUFFER, ubo);
-    block_index = glGetUniformBlockIndex(m_shaders.at("orbit").handle, "ubo_data");
-    glUniformBlockBinding(m_shaders.at("orbit").handle, block_index, 0);
-    glBindBufferBase(GL_UNIFORM_BUFFER, block_index, ubo);
+    block_index = uniform_block_index(m_shaders.at("orbit"), "ubo_data");
+    glUniformBlockBinding(m_shaders.at("orbit").handle, block_index, UBO_BINDING);
     
   updateView();
   updateProjection();
@@ -541,6 +534,12 @@ void ApplicationSolar::keyCallback(int key, int scancode, int action, int mods)
   {
       m_nmap = NORMAL_MAP;
   }
+  // draw fewer or more faint stars
+  else if((key == GLFW_KEY_5 || key == GLFW_KEY_6) && action == GLFW_PRESS)
+  {
+      m_star_limit += key == GLFW_KEY_5 ? -STAR_LIMIT_STEP : STAR_LIMIT_STEP;
+      std::cout << "Star magnitude limit " << m_star_limit << " - " << m_stars->brighter(m_star_limit) << " stars" << std::endl;
+  }
   else if(key == GLFW_KEY_7 && action == GLFW_PRESS)
   {
       effect ^= FX_GREYSCALE;
@@ -573,43 +572,45 @@ void ApplicationSolar::initializeShaderPrograms() {
   // store shader program objects in container
   m_shaders.emplace("planet", shader_program{m_resource_path + "shaders/planet.vert",
                                            m_resource_path + "shaders/planet.frag"});
-  // request uniform locations for shader program
-  m_shaders.at("planet").u_locs["NormalMatrix"] = -1;
-  m_shaders.at("planet").u_locs["ModelMatrix"] = -1;
-  m_shaders.at("planet").u_locs["LightPosition"] = -1;
-  m_shaders.at("planet").u_locs["Color"] = -1;
-  m_shaders.at("planet").u_locs["flags"] = -1;
-  m_shaders.at("planet").u_locs["texDiffuse"] = -1;
-  m_shaders.at("planet").u_locs["texNormal"] = -1;
+  // typed uniform handles, locations are resolved after linking
+  m_light_position = uniform_handle<glm::fvec3>{m_shaders.at("planet"), "LightPosition"};
+  m_planet_diffuse = uniform_handle<GLint>{m_shaders.at("planet"), "texDiffuse"};
+  m_planet_normal = uniform_handle<GLint>{m_shaders.at("planet"), "texNormal"};
     
   // shader for stars
   m_shaders.emplace("starfield", shader_program{m_resource_path + "shaders/starfield.vert",
                                             m_resource_path + "shaders/starfield.frag"});
+  m_star_limit_magnitude = uniform_handle<GLfloat>{m_shaders.at("starfield"), "LimitMagnitude"};
     
   // shader for orbits
   m_shaders.emplace("orbit", shader_program{m_resource_path + "shaders/orbit.vert",
         m_resource_path + "shaders/orbit.frag"});
     
-  // request uniform locations for shader program
-  m_shaders.at("orbit").u_locs["ModelMatrix"] = -1;
-    
   // shaders for rendering to off-screen buffer
   m_shaders.emplace("rtt", shader_program{m_resource_path + "shaders/post-processing.vert",
       m_resource_path + "shaders/post-processing.frag"});
-  m_shaders.at("rtt").u_locs["tex"] = -1;
-  m_shaders.at("rtt").u_locs["effects"] = -1;
-  m_shaders.at("rtt").u_locs["one_over_screen_width"] = -1;
-  m_shaders.at("rtt").u_locs["one_over_screen_height"] = -1;
+  m_rtt_texture = uniform_handle<GLint>{m_shaders.at("rtt"), "tex"};
+  m_rtt_effects = uniform_handle<GLint>{m_shaders.at("rtt"), "effects"};
+  m_rtt_width = uniform_handle<GLfloat>{m_shaders.at("rtt"), "one_over_screen_width"};
+  m_rtt_height = uniform_handle<GLfloat>{m_shaders.at("rtt"), "one_over_screen_height"};
     
   // shader for font
   m_shaders.emplace("font", shader_program{m_resource_path + "shaders/font.vert",
         m_resource_path + "shaders/font.frag"});
-  m_shaders.at("font").u_locs["tex"] = -1;
+  m_font_texture = uniform_handle<GLint>{m_shaders.at("font"), "tex"};
 }
 
 // load models
 void ApplicationSolar::initializeGeometry() {
-    model planet_model = model_loader::obj(m_resource_path + "models/sphere.obj", model::NORMAL | model::TEXCOORD | model::TANGENT);
+  // parsed only on first start, later mapped from binary cache
+  mesh_cache::cached_model planet_model = model_loader::cached_obj(m_resource_path + "models/sphere.obj", model::NORMAL | model::TEXCOORD | model::TANGENT, true);
+
+  // coarser levels for distant planets share the vertices
+  mesh_simplifier::lod_chain planet_lods = mesh_simplifier::build_lods(planet_model.data, planet_model.layout, planet_model.indices, planet_model.index_num);
+
+  // half float and packed attributes, 16 bit indices
+  quantizer::packed_model planet_packed = quantizer::pack(planet_model.data, planet_model.layout, planet_lods.indices.data(), planet_lods.indices.size());
+  std::cout << "Planet vertices - " << planet_packed << std::endl;
 
   // generate vertex array object
   glGenVertexArrays(1, &planet_object.vertex_AO);
@@ -621,37 +622,27 @@ void ApplicationSolar::initializeGeometry() {
   // bind this as an vertex array buffer containing all attributes
   glBindBuffer(GL_ARRAY_BUFFER, planet_object.vertex_BO);
   // configure currently bound array buffer
-  glBufferData(GL_ARRAY_BUFFER, sizeof(float) * planet_model.data.size(), planet_model.data.data(), GL_STATIC_DRAW);
-
-  // activate first attribute on gpu
-  glEnableVertexAttribArray(0);
-  // first attribute is 3 floats with no offset & stride
-  glVertexAttribPointer(0, model::POSITION.components, model::POSITION.type, GL_FALSE, planet_model.vertex_bytes, planet_model.offsets[model::POSITION]);
-  // activate second attribute on gpu
-  glEnableVertexAttribArray(1);
-  // second attribute is 3 floats with no offset & stride
-  glVertexAttribPointer(1, model::NORMAL.components, model::NORMAL.type, GL_FALSE, planet_model.vertex_bytes, planet_model.offsets[model::NORMAL]);
-    
-  glEnableVertexAttribArray(2);
-  // second attribute is 3 floats with no offset & stride
-  glVertexAttribPointer(2, model::TEXCOORD.components, model::TEXCOORD.type, GL_FALSE, planet_model.vertex_bytes, planet_model.offsets[model::TEXCOORD]);
-    
-  glEnableVertexAttribArray(3);
-  // second attribute is 3 floats with no offset & stride
-  glVertexAttribPointer(3, model::TANGENT.components, model::TANGENT.type, GL_FALSE, planet_model.vertex_bytes, planet_model.offsets[model::TANGENT]);
+  glBufferData(GL_ARRAY_BUFFER, planet_packed.data.size(), planet_packed.data.data(), GL_STATIC_DRAW);
 
+  // activate attributes in their packed formats
+  quantizer::set_attribute_pointers(planet_packed);
 
    // generate generic buffer
   glGenBuffers(1, &planet_object.element_BO);
   // bind this as an vertex array buffer containing all attributes
   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, planet_object.element_BO);
   // configure currently bound array buffer
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, model::INDEX.size * planet_model.indices.size(), planet_model.indices.data(), GL_STATIC_DRAW);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, planet_packed.indices.size(), planet_packed.indices.data(), GL_STATIC_DRAW);
 
   // store type of primitive to draw
   planet_object.draw_mode = GL_TRIANGLES;
-  // transfer number of indices to model object 
-  planet_object.num_elements = GLsizei(planet_model.indices.size());
+  // transfer number of indices of finest level to model object
+  planet_object.lods = planet_lods.levels;
+  planet_object.num_elements = planet_lods.levels.front().num_elements;
+  planet_object.index_type = planet_packed.index.type;
+  // sphere for culling, from the unquantized positions
+  planet_object.bounds = culling::bounds(planet_model.data, planet_model.layout.vertex_num,
+                                         std::size_t(planet_model.layout.vertex_bytes) / sizeof(GLfloat));
     
     
   // generate data for full-screen quad
@@ -0,0 +1,103 @@
+// replays a trace captured with "solar_system --trace file" in an invisible window
+// as fast as possible and reports the time of each captured frame
+// usage: gl_replay file [--warmup N] [--report path]
+
+#include <glbinding/gl/gl.h>
+#include <glbinding/Binding.h>
+// use gl definitions from glbinding
+using namespace gl;
+
+//dont load gl bindings from glfw
+#define GLFW_INCLUDE_NONE
+#include <GLFW/glfw3.h>
+
+#include "benchmark.hpp"
+#include "gl_trace.hpp"
+
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+int main(int argc, char* argv[]) {
+  std::string trace_path{};
+  std::string report_path{};
+  unsigned warmup = 0;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg{argv[i]};
+    if (arg == "--warmup" && i + 1 < argc) {
+      warmup = unsigned(std::strtoul(argv[++i], nullptr, 10));
+    }
+    else if (arg == "--report" && i + 1 < argc) {
+      report_path = argv[++i];
+    }
+    else if (trace_path.empty()) {
+      trace_path = arg;
+    }
+  }
+  if (trace_path.empty()) {
+    std::cerr << "Usage: " << argv[0] << " file [--warmup N] [--report path]" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if (!glfwInit()) {
+    std::exit(EXIT_FAILURE);
+  }
+  // same context and default framebuffer as the captured Launcher
+  glfwWindowHint(GLFW_VISIBLE, false);
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+  glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, true);
+  #ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+  #else
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_COMPAT_PROFILE);
+  #endif
+  GLFWwindow* window = glfwCreateWindow(640, 480, "gl replay", NULL, NULL);
+  if (!window) {
+    glfwTerminate();
+    std::exit(EXIT_FAILURE);
+  }
+  glfwMakeContextCurrent(window);
+  glbinding::Binding::initialize();
+
+  int status = EXIT_SUCCESS;
+  try {
+    gl_trace::player player{trace_path};
+    if (player.frames() <= warmup) {
+      throw std::runtime_error("Trace has only " + std::to_string(player.frames()) + " frames");
+    }
+    std::cout << "Replaying " << player.frames() << " frames of " << trace_path << std::endl;
+
+    Benchmark benchmark{player.frames() - warmup, warmup};
+    bool frame_complete = true;
+    while (frame_complete) {
+      benchmark.beginFrame();
+      frame_complete = player.play_frame();
+      // wait for gpu like the buffer swap of the capture
+      glFinish();
+      if (frame_complete) {
+        benchmark.endFrame();
+      }
+    }
+
+    auto const& stats = player.stats();
+    std::cout << stats.calls << " calls, " << stats.payload_bytes / 1024 << " KiB payload" << std::endl;
+    if (stats.name_mismatches > 0) {
+      std::cerr << stats.name_mismatches << " calls generated different object names than in capture" << std::endl;
+    }
+    benchmark.print(std::cout);
+    if (!report_path.empty()) {
+      benchmark.writeReport(report_path);
+      std::cout << "Report written to " << report_path << std::endl;
+    }
+  }
+  catch (std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    status = EXIT_FAILURE;
+  }
+
+  glfwDestroyWindow(window);
+  glfwTerminate();
+  return status;
+}
@@ -0,0 +1,135 @@
+// compares cost of a hot gl call through different dispatch paths:
+// raw function pointer, glbinding without callbacks,
+// glbinding with boxed after callback and glbinding with record callback
+
+#include <glbinding/gl/gl.h>
+#include <glbinding/Binding.h>
+#include <glbinding/callbacks.h>
+// use gl definitions from glbinding
+using namespace gl;
+
+//dont load gl bindings from glfw
+#define GLFW_INCLUDE_NONE
+#include <GLFW/glfw3.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+static const unsigned CALL_COUNT = 1000000;
+
+static const char* VERTEX_SOURCE =
+  "#version 150\n"
+  "uniform mat4 ModelMatrix;\n"
+  "in vec3 in_Position;\n"
+  "void main() { gl_Position = ModelMatrix * vec4(in_Position, 1.0); }\n";
+
+static const char* FRAGMENT_SOURCE =
+  "#version 150\n"
+  "out vec4 out_Color;\n"
+  "void main() { out_Color = vec4(1.0); }\n";
+
+// average time of call in nanoseconds, template to avoid std::function indirection
+template<typename Call>
+double measure(std::string const& name, Call const& call, GLint location) {
+  GLfloat matrix[16] = {1.0f, 0.0f, 0.0f, 0.0f,
+                        0.0f, 1.0f, 0.0f, 0.0f,
+                        0.0f, 0.0f, 1.0f, 0.0f,
+                        0.0f, 0.0f, 0.0f, 1.0f};
+  glFinish();
+  auto start = std::chrono::steady_clock::now();
+  for (unsigned i = 0; i < CALL_COUNT; ++i) {
+    matrix[12] = float(i);
+    call(location, matrix);
+  }
+  glFinish();
+  std::chrono::duration<double, std::nano> duration = std::chrono::steady_clock::now() - start;
+
+  double per_call = duration.count() / double(CALL_COUNT);
+  std::cout << name << " - " << per_call << " ns/call" << std::endl;
+  return per_call;
+}
+
+GLuint create_program() {
+  GLuint vertex_shader = glCreateShader(GL_VERTEX_SHADER);
+  glShaderSource(vertex_shader, 1, &VERTEX_SOURCE, nullptr);
+  glCompileShader(vertex_shader);
+  GLuint fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
+  glShaderSource(fragment_shader, 1, &FRAGMENT_SOURCE, nullptr);
+  glCompileShader(fragment_shader);
+
+  GLuint program = glCreateProgram();
+  glAttachShader(program, vertex_shader);
+  glAttachShader(program, fragment_shader);
+  glLinkProgram(program);
+  glDeleteShader(vertex_shader);
+  glDeleteShader(fragment_shader);
+  return program;
+}
+
+int main(int argc, char* argv[]) {
+  if (!glfwInit()) {
+    std::exit(EXIT_FAILURE);
+  }
+  // invisible window only provides the context
+  glfwWindowHint(GLFW_VISIBLE, false);
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+  GLFWwindow* window = glfwCreateWindow(64, 64, "glbinding calls", NULL, NULL);
+  if (!window) {
+    glfwTerminate();
+    std::exit(EXIT_FAILURE);
+  }
+  glfwMakeContextCurrent(window);
+  glbinding::Binding::initialize();
+
+  GLuint program = create_program();
+  glUseProgram(program);
+  GLint location = glGetUniformLocation(program, "ModelMatrix");
+
+  // c signature of the driver function
+  typedef void (*uniform_matrix_t)(GLint, GLsizei, GLboolean::underlying_type, GLfloat const*);
+  uniform_matrix_t raw_function = reinterpret_cast<uniform_matrix_t>(glbinding::Binding::UniformMatrix4fv.address());
+
+  std::cout << "glUniformMatrix4fv, " << CALL_COUNT << " calls" << std::endl;
+
+  measure("raw function pointer", [raw_function](GLint loc, GLfloat const* matrix) {
+    raw_function(loc, 1, GLboolean::underlying_type(0), matrix);
+  }, location);
+
+  glbinding::setCallbackMask(glbinding::CallbackMask::None);
+  measure("glbinding, no callbacks", [](GLint loc, GLfloat const* matrix) {
+    glUniformMatrix4fv(loc, 1, GL_FALSE, matrix);
+  }, location);
+
+  // boxes parameters into heap values for every call
+  glbinding::setCallbackMask(glbinding::CallbackMask::After | glbinding::CallbackMask::ParametersAndReturnValue);
+  glbinding::setAfterCallback([](glbinding::FunctionCall const&) {});
+  measure("glbinding, after callback", [](GLint loc, GLfloat const* matrix) {
+    glUniformMatrix4fv(loc, 1, GL_FALSE, matrix);
+  }, location);
+
+  // passes stack allocated record
+  glbinding::setCallbackMask(glbinding::CallbackMask::Record);
+  glbinding::setRecordCallback([](glbinding::CallRecord const&) {});
+  measure("glbinding, record callback", [](GLint loc, GLfloat const* matrix) {
+    glUniformMatrix4fv(loc, 1, GL_FALSE, matrix);
+  }, location);
+
+  // error checking as done by gl_errors per-call tier
+  glbinding::setCallbackMaskExcept(glbinding::CallbackMask::Record, {"glGetError"});
+  glbinding::setRecordCallback([](glbinding::CallRecord const&) {
+    glGetError();
+  });
+  measure("glbinding, record callback with glGetError", [](GLint loc, GLfloat const* matrix) {
+    glUniformMatrix4fv(loc, 1, GL_FALSE, matrix);
+  }, location);
+
+  glbinding::setCallbackMask(glbinding::CallbackMask::None);
+  glDeleteProgram(program);
+  glfwDestroyWindow(window);
+  glfwTerminate();
+
+  return EXIT_SUCCESS;
+}
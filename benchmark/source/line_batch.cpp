@@ -0,0 +1,213 @@
+// compares frame time of drawing many orbits with one uniform upload and draw call each
+// and with line_batch, which draws instanced unit circles with one call per level of detail
+
+#include "line_batch.hpp"
+#include "benchmark.hpp"
+
+#include <glbinding/gl/gl.h>
+#include <glbinding/Binding.h>
+// use gl definitions from glbinding
+using namespace gl;
+
+//dont load gl bindings from glfw
+#define GLFW_INCLUDE_NONE
+#include <GLFW/glfw3.h>
+
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// points of the circle drawn per orbit, as in the solar system
+static const GLsizei CIRCLE_POINTS = 100;
+
+static const char* SINGLE_VERTEX_SOURCE =
+  "#version 150\n"
+  "uniform mat4 ViewProjection;\n"
+  "uniform mat4 ModelMatrix;\n"
+  "in vec3 in_Position;\n"
+  "out vec4 pass_Color;\n"
+  "void main() {\n"
+  "  gl_Position = ViewProjection * ModelMatrix * vec4(in_Position, 1.0);\n"
+  "  pass_Color = vec4(1.0, 0.0, 0.0, 1.0);\n"
+  "}\n";
+
+static const char* BATCH_VERTEX_SOURCE =
+  "#version 150\n"
+  "#extension GL_ARB_explicit_attrib_location : require\n"
+  "uniform mat4 ViewProjection;\n"
+  "layout(location = 0) in vec3 in_Position;\n"
+  "layout(location = 1) in vec4 in_Color;\n"
+  "layout(location = 2) in mat4 in_Transform;\n"
+  "out vec4 pass_Color;\n"
+  "void main() {\n"
+  "  gl_Position = ViewProjection * in_Transform * vec4(in_Position, 1.0);\n"
+  "  pass_Color = in_Color;\n"
+  "}\n";
+
+static const char* FRAGMENT_SOURCE =
+  "#version 150\n"
+  "in vec4 pass_Color;\n"
+  "out vec4 out_Color;\n"
+  "void main() { out_Color = pass_Color; }\n";
+
+GLuint create_program(const char* vertex_source) {
+  GLuint vertex_shader = glCreateShader(GL_VERTEX_SHADER);
+  glShaderSource(vertex_shader, 1, &vertex_source, nullptr);
+  glCompileShader(vertex_shader);
+  GLuint fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
+  glShaderSource(fragment_shader, 1, &FRAGMENT_SOURCE, nullptr);
+  glCompileShader(fragment_shader);
+
+  GLuint program = glCreateProgram();
+  glAttachShader(program, vertex_shader);
+  glAttachShader(program, fragment_shader);
+  glBindAttribLocation(program, 0, "in_Position");
+  glLinkProgram(program);
+  glDeleteShader(vertex_shader);
+  glDeleteShader(fragment_shader);
+  return program;
+}
+
+// times frames of function in milliseconds, including gpu work, and prints summary
+template<typename Function>
+double measure(std::string const& name, unsigned frames, Function const& function) {
+  std::vector<double> samples{};
+  for (unsigned i = 0; i < frames; ++i) {
+    glFinish();
+    auto start = std::chrono::steady_clock::now();
+    function();
+    glFinish();
+    std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - start;
+    samples.push_back(duration.count());
+  }
+
+  sample_summary summary = Benchmark::summarize(samples);
+  std::cout << name << " - min " << summary.min << " ms, mean " << summary.mean << " ms" << std::endl;
+  return summary.min;
+}
+
+int main(int argc, char* argv[]) {
+  unsigned orbits = 20000;
+  unsigned frames = 50;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg{argv[i]};
+    if (arg == "--orbits" && i + 1 < argc) {
+      orbits = unsigned(std::max(1, std::atoi(argv[++i])));
+    }
+    else if (arg == "--frames" && i + 1 < argc) {
+      frames = unsigned(std::max(1, std::atoi(argv[++i])));
+    }
+    else {
+      std::cerr << "usage: " << argv[0] << " [--orbits N] [--frames N]" << std::endl;
+      std::exit(EXIT_FAILURE);
+    }
+  }
+
+  if (!glfwInit()) {
+    std::exit(EXIT_FAILURE);
+  }
+  // invisible window only provides the context
+  glfwWindowHint(GLFW_VISIBLE, false);
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+  GLFWwindow* window = glfwCreateWindow(640, 480, "line batch", NULL, NULL);
+  if (!window) {
+    glfwTerminate();
+    std::exit(EXIT_FAILURE);
+  }
+  glfwMakeContextCurrent(window);
+  glbinding::Binding::initialize();
+
+  // satellite constellation, tilted rings of orbits around a planet in view
+  glm::fmat4 projection = glm::perspective(glm::radians(60.0f), 640.0f / 480.0f, 0.1f, 1000.0f);
+  glm::fmat4 view_projection = projection * glm::lookAt(glm::fvec3{0.0f, 20.0f, 60.0f}, glm::fvec3{0.0f}, glm::fvec3{0.0f, 1.0f, 0.0f});
+  std::vector<glm::fmat4> transforms{};
+  for (unsigned i = 0; i < orbits; ++i) {
+    glm::fmat4 transform = glm::rotate(glm::fmat4{}, float(i) * 0.618f, glm::fvec3{0.0f, 1.0f, 0.0f});
+    transform = glm::rotate(transform, float(i % 17) * 0.1f, glm::fvec3{1.0f, 0.0f, 0.0f});
+    transforms.push_back(glm::scale(transform, glm::fvec3{1.0f + float(i % 100) * 0.25f}));
+  }
+  std::cout << orbits << " orbits, " << frames << " frames" << std::endl;
+
+  // one shared circle, like the previous Orbit
+  std::vector<glm::fvec3> points{};
+  float step = 2.0f * glm::pi<float>() / float(CIRCLE_POINTS);
+  for (GLsizei i = 0; i < CIRCLE_POINTS; ++i) {
+    points.push_back(glm::fvec3{std::cos(float(i) * step), 0.0f, std::sin(float(i) * step)});
+  }
+  GLuint circle_buffer = 0;
+  GLuint circle_array = 0;
+  glGenBuffers(1, &circle_buffer);
+  glBindBuffer(GL_ARRAY_BUFFER, circle_buffer);
+  glBufferData(GL_ARRAY_BUFFER, GLsizeiptr(points.size() * sizeof(glm::fvec3)), points.data(), GL_STATIC_DRAW);
+  glGenVertexArrays(1, &circle_array);
+  glBindVertexArray(circle_array);
+  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
+  glEnableVertexAttribArray(0);
+
+  GLuint single_program = create_program(SINGLE_VERTEX_SOURCE);
+  GLint single_model = glGetUniformLocation(single_program, "ModelMatrix");
+  glUseProgram(single_program);
+  glUniformMatrix4fv(glGetUniformLocation(single_program, "ViewProjection"), 1, GL_FALSE, glm::value_ptr(view_projection));
+  GLuint batch_program = create_program(BATCH_VERTEX_SOURCE);
+  glUseProgram(batch_program);
+  glUniformMatrix4fv(glGetUniformLocation(batch_program, "ViewProjection"), 1, GL_FALSE, glm::value_ptr(view_projection));
+
+  double single = measure("draw per orbit", frames, [&]() {
+    glClear(GL_COLOR_BUFFER_BIT);
+    glUseProgram(single_program);
+    glBindVertexArray(circle_array);
+    for (auto const& transform : transforms) {
+      glUniformMatrix4fv(single_model, 1, GL_FALSE, glm::value_ptr(transform));
+      glDrawArrays(GL_LINE_LOOP, 0, CIRCLE_POINTS);
+    }
+  });
+
+  glm::fvec4 const color{1.0f, 0.0f, 0.0f, 1.0f};
+  // released before the context
+  std::unique_ptr<line_batch> batch{new line_batch{}};
+  std::size_t draws = 0;
+  double fixed = measure("line_batch, 128 segments", frames, [&]() {
+    glClear(GL_COLOR_BUFFER_BIT);
+    glUseProgram(batch_program);
+    for (auto const& transform : transforms) {
+      batch->add_circle(transform, color, 128);
+    }
+    draws = batch->draw();
+  });
+  std::cout << "  " << draws << " draw calls" << std::endl;
+
+  // radius in pixels like the solar system estimates it
+  double adaptive = measure("line_batch, adaptive segments", frames, [&]() {
+    glClear(GL_COLOR_BUFFER_BIT);
+    glUseProgram(batch_program);
+    for (auto const& transform : transforms) {
+      float radius = glm::length(glm::fvec3{transform[0]});
+      float distance = glm::length(glm::fvec3{0.0f, 20.0f, 60.0f} - glm::fvec3{transform[3]});
+      batch->add_circle(transform, color, line_batch::segments(radius * projection[1][1] * 240.0f / distance));
+    }
+    draws = batch->draw();
+  });
+  std::cout << "  " << draws << " draw calls" << std::endl;
+
+  std::cout << "speedup " << single / fixed << ", adaptive " << single / adaptive << std::endl;
+
+  glDeleteProgram(single_program);
+  glDeleteProgram(batch_program);
+  glDeleteVertexArrays(1, &circle_array);
+  glDeleteBuffers(1, &circle_buffer);
+  batch.reset();
+  glfwDestroyWindow(window);
+  glfwTerminate();
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,165 @@
+// compares the batched matrix kernels of matrix_batch with glm
+// on the per-object transformations of a renderer
+
+#include "matrix_batch.hpp"
+#include "benchmark.hpp"
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/matrix_inverse.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/random.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// times runs of function in milliseconds and prints summary, returns minimum
+template<typename Function>
+double measure(std::string const& name, unsigned runs, std::size_t count, Function const& function) {
+  std::vector<double> samples{};
+  for (unsigned i = 0; i < runs; ++i) {
+    auto start = std::chrono::steady_clock::now();
+    function();
+    std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - start;
+    samples.push_back(duration.count());
+  }
+
+  sample_summary summary = Benchmark::summarize(samples);
+  std::cout << name << " - min " << summary.min << " ms, mean " << summary.mean << " ms, "
+            << summary.min * 1000000.0 / double(count) << " ns/matrix" << std::endl;
+  return summary.min;
+}
+
+// largest element difference relative to the element size
+template<typename Matrix>
+float max_difference(std::vector<Matrix> const& a, std::vector<Matrix> const& b) {
+  float difference = 0.0f;
+  for (std::size_t i = 0; i < std::min(a.size(), b.size()); ++i) {
+    for (int column = 0; column < a[i].length(); ++column) {
+      for (int row = 0; row < a[i][column].length(); ++row) {
+        float reference = std::abs(a[i][column][row]);
+        difference = std::max(difference, std::abs(a[i][column][row] - b[i][column][row]) / std::max(1.0f, reference));
+      }
+    }
+  }
+  return difference;
+}
+
+void compare(std::string const& name, double reference, double batched, float difference) {
+  std::cout << name << " speedup " << reference / batched << ", max difference " << difference << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+  std::size_t count = 10000;
+  unsigned runs = 200;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg{argv[i]};
+    if (arg == "--matrices" && i + 1 < argc) {
+      count = std::size_t(std::max(1, std::atoi(argv[++i])));
+    }
+    else if (arg == "--runs" && i + 1 < argc) {
+      runs = unsigned(std::max(1, std::atoi(argv[++i])));
+    }
+    else {
+      std::cerr << "usage: " << argv[0] << " [--matrices N] [--runs N]" << std::endl;
+      std::exit(EXIT_FAILURE);
+    }
+  }
+  std::cout << count << " matrices, " << runs << " runs" << std::endl;
+
+  // random object transformations as component arrays
+  std::vector<float> translation[3];
+  std::vector<float> rotation[4];
+  std::vector<float> scale[3];
+  for (std::size_t i = 0; i < count; ++i) {
+    glm::fvec3 position = glm::ballRand(100.0f);
+    glm::fquat orientation = glm::angleAxis(glm::linearRand(0.0f, 6.2831853f), glm::sphericalRand(1.0f));
+    glm::fvec3 size = glm::linearRand(glm::fvec3{0.1f}, glm::fvec3{4.0f});
+    for (int c = 0; c < 3; ++c) {
+      translation[c].push_back(position[c]);
+      scale[c].push_back(size[c]);
+    }
+    for (int c = 0; c < 4; ++c) {
+      rotation[c].push_back(orientation[c]);
+    }
+  }
+  matrix_batch::trs_arrays trs{};
+  for (int c = 0; c < 3; ++c) {
+    trs.translation[c] = translation[c].data();
+    trs.scale[c] = scale[c].data();
+  }
+  for (int c = 0; c < 4; ++c) {
+    trs.rotation[c] = rotation[c].data();
+  }
+  glm::fmat4 camera = glm::translate(glm::rotate(glm::fmat4{}, 0.3f, glm::fvec3{1.0f, 0.0f, 0.0f}), glm::fvec3{0.0f, 5.0f, 35.0f});
+
+  std::vector<glm::fmat4> models(count);
+  std::vector<glm::fmat4> reference_models(count);
+  double reference = measure("glm compose", runs, count, [&]() {
+    for (std::size_t i = 0; i < count; ++i) {
+      glm::fquat orientation{rotation[3][i], rotation[0][i], rotation[1][i], rotation[2][i]};
+      reference_models[i] = glm::translate(glm::fmat4{}, glm::fvec3{translation[0][i], translation[1][i], translation[2][i]})
+                          * glm::mat4_cast(orientation)
+                          * glm::scale(glm::fmat4{}, glm::fvec3{scale[0][i], scale[1][i], scale[2][i]});
+    }
+  });
+  double batched = measure("batched compose", runs, count, [&]() {
+    matrix_batch::compose(trs, models.data(), count);
+  });
+  compare("compose", reference, batched, max_difference(reference_models, models));
+
+  std::vector<glm::fmat4> products(count);
+  std::vector<glm::fmat4> reference_products(count);
+  reference = measure("glm multiply", runs, count, [&]() {
+    for (std::size_t i = 0; i < count; ++i) {
+      reference_products[i] = camera * models[i];
+    }
+  });
+  batched = measure("batched multiply", runs, count, [&]() {
+    matrix_batch::multiply(camera, models.data(), products.data(), count);
+  });
+  compare("multiply", reference, batched, max_difference(reference_products, products));
+
+  std::vector<glm::fmat4> inverses(count);
+  std::vector<glm::fmat4> reference_inverses(count);
+  reference = measure("glm inverse", runs, count, [&]() {
+    for (std::size_t i = 0; i < count; ++i) {
+      reference_inverses[i] = glm::inverse(models[i]);
+    }
+  });
+  batched = measure("batched affine inverse", runs, count, [&]() {
+    matrix_batch::affine_inverse(models.data(), inverses.data(), count);
+  });
+  compare("inverse", reference, batched, max_difference(reference_inverses, inverses));
+
+  std::vector<glm::fmat3> normals(count);
+  std::vector<glm::fmat3> reference_normals(count);
+  reference = measure("glm inverseTranspose", runs, count, [&]() {
+    for (std::size_t i = 0; i < count; ++i) {
+      reference_normals[i] = glm::inverseTranspose(glm::fmat3{models[i]});
+    }
+  });
+  batched = measure("batched normal matrices", runs, count, [&]() {
+    matrix_batch::normal_matrices(models.data(), normals.data(), count);
+  });
+  compare("normal matrices", reference, batched, max_difference(reference_normals, normals));
+
+  // per-object normal matrix as formerly computed by the solar application
+  reference = measure("glm view normal matrices", runs, count, [&]() {
+    for (std::size_t i = 0; i < count; ++i) {
+      reference_normals[i] = glm::fmat3{glm::inverseTranspose(glm::inverse(camera) * models[i])};
+    }
+  });
+  batched = measure("batched view normal matrices", runs, count, [&]() {
+    glm::fmat4 view = matrix_batch::affine_inverse(camera);
+    matrix_batch::multiply(view, models.data(), products.data(), count);
+    matrix_batch::normal_matrices(products.data(), normals.data(), count);
+  });
+  compare("view normal matrices", reference, batched, max_difference(reference_normals, normals));
+
+  return 0;
+}
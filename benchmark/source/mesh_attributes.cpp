@@ -0,0 +1,185 @@
+// compares normal and tangent generation of mesh_attributes
+// with the previous single-threaded glm implementation on a large torus
+
+#include "mesh_attributes.hpp"
+#include "benchmark.hpp"
+#include "parallel.hpp"
+
+#include <glm/gtc/type_precision.hpp>
+#include <glm/geometric.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+struct mesh {
+  std::vector<float> positions;
+  std::vector<float> texcoords;
+  std::vector<unsigned> indices;
+};
+
+// torus with at least given number of triangles
+mesh create_torus(std::size_t triangles) {
+  unsigned segments = unsigned(std::ceil(std::sqrt(double(triangles) / 2.0)));
+  mesh torus{};
+  torus.positions.reserve((segments + 1) * (segments + 1) * 3);
+  torus.texcoords.reserve((segments + 1) * (segments + 1) * 2);
+  for (unsigned i = 0; i <= segments; ++i) {
+    float u = float(i) / float(segments);
+    for (unsigned j = 0; j <= segments; ++j) {
+      float v = float(j) / float(segments);
+      float ring = 1.0f + 0.3f * std::cos(v * 6.2831853f);
+      torus.positions.push_back(ring * std::cos(u * 6.2831853f));
+      torus.positions.push_back(0.3f * std::sin(v * 6.2831853f));
+      torus.positions.push_back(ring * std::sin(u * 6.2831853f));
+      torus.texcoords.push_back(u);
+      torus.texcoords.push_back(v);
+    }
+  }
+  torus.indices.reserve(segments * segments * 6);
+  for (unsigned i = 0; i < segments; ++i) {
+    for (unsigned j = 0; j < segments; ++j) {
+      unsigned a = i * (segments + 1) + j;
+      unsigned b = a + segments + 1;
+      unsigned quad[6] = {a, a + 1, b, b, a + 1, b + 1};
+      torus.indices.insert(torus.indices.end(), quad, quad + 6);
+    }
+  }
+  return torus;
+}
+
+// previous implementation of model_loader
+std::vector<float> reference_normals(mesh const& m) {
+  std::vector<glm::fvec3> positions(m.positions.size() / 3);
+  for (unsigned i = 0; i < m.positions.size(); i += 3) {
+    positions[i / 3] = glm::fvec3{m.positions[i], m.positions[i + 1], m.positions[i + 2]};
+  }
+
+  std::vector<glm::fvec3> normals(m.positions.size() / 3, glm::fvec3{0.0f});
+  for (unsigned i = 0; i < m.indices.size(); i += 3) {
+    glm::fvec3 normal = glm::cross(positions[m.indices[i + 1]] - positions[m.indices[i]], positions[m.indices[i + 2]] - positions[m.indices[i]]);
+    normals[m.indices[i]] += normal;
+    normals[m.indices[i + 1]] += normal;
+    normals[m.indices[i + 2]] += normal;
+  }
+
+  std::vector<float> result(m.positions.size());
+  for (unsigned i = 0; i < normals.size(); ++i) {
+    glm::fvec3 normal = glm::normalize(normals[i]);
+    result[i * 3] = normal[0];
+    result[i * 3 + 1] = normal[1];
+    result[i * 3 + 2] = normal[2];
+  }
+  return result;
+}
+
+std::vector<float> reference_tangents(mesh const& m, std::vector<float> const& vertex_normals) {
+  std::vector<glm::fvec3> positions(m.positions.size() / 3);
+  std::vector<glm::fvec3> normals(m.positions.size() / 3);
+  std::vector<glm::fvec2> texcoords(m.positions.size() / 3);
+  std::vector<glm::fvec3> tangents(m.positions.size() / 3, glm::fvec3{0.0f});
+  for (unsigned i = 0; i < m.positions.size(); i += 3) {
+    positions[i / 3] = glm::fvec3{m.positions[i], m.positions[i + 1], m.positions[i + 2]};
+    normals[i / 3] = glm::fvec3{vertex_normals[i], vertex_normals[i + 1], vertex_normals[i + 2]};
+  }
+  for (unsigned i = 0; i < m.texcoords.size(); i += 2) {
+    texcoords[i / 2] = glm::fvec2{m.texcoords[i], m.texcoords[i + 1]};
+  }
+
+  for (unsigned i = 0; i < m.indices.size() / 3; i++) {
+    unsigned indices[3] = {m.indices[i * 3], m.indices[i * 3 + 1], m.indices[i * 3 + 2]};
+    glm::fvec3 d_p1 = positions[indices[1]] - positions[indices[0]];
+    glm::fvec3 d_p2 = positions[indices[2]] - positions[indices[0]];
+    glm::fvec2 d_t1 = texcoords[indices[1]] - texcoords[indices[0]];
+    glm::fvec2 d_t2 = texcoords[indices[2]] - texcoords[indices[0]];
+    float r = 1.0f / (d_t1.x * d_t2.y - d_t1.y * d_t2.x);
+    glm::vec3 tangent = (d_p1 * d_t2.y - d_p2 * d_t1.y) * r;
+    tangents[indices[0]] += tangent;
+    tangents[indices[1]] += tangent;
+    tangents[indices[2]] += tangent;
+  }
+
+  std::vector<float> result(m.positions.size());
+  for (unsigned i = 0; i < tangents.size(); ++i) {
+    glm::fvec3 tangent = glm::normalize(tangents[i] - normals[i] * glm::dot(normals[i], tangents[i]));
+    result[i * 3] = tangent.x;
+    result[i * 3 + 1] = tangent.y;
+    result[i * 3 + 2] = tangent.z;
+  }
+  return result;
+}
+
+// times runs of function in milliseconds and prints summary, returns last result
+template<typename Function>
+std::vector<float> measure(std::string const& name, unsigned runs, std::size_t triangles, Function const& function) {
+  std::vector<double> samples{};
+  std::vector<float> result{};
+  for (unsigned i = 0; i < runs; ++i) {
+    auto start = std::chrono::steady_clock::now();
+    result = function();
+    std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - start;
+    samples.push_back(duration.count());
+  }
+
+  sample_summary summary = Benchmark::summarize(samples);
+  std::cout << name << " - min " << summary.min << " ms, mean " << summary.mean << " ms, "
+            << double(triangles) / summary.min / 1000.0 << " Mtris/s" << std::endl;
+  return result;
+}
+
+// largest component difference
+float max_difference(std::vector<float> const& a, std::vector<float> const& b) {
+  float difference = 0.0f;
+  for (std::size_t i = 0; i < std::min(a.size(), b.size()); ++i) {
+    difference = std::max(difference, std::abs(a[i] - b[i]));
+  }
+  return difference;
+}
+
+int main(int argc, char* argv[]) {
+  std::size_t triangles = 4000000;
+  unsigned runs = 5;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg{argv[i]};
+    if (arg == "--triangles" && i + 1 < argc) {
+      triangles = std::size_t(std::atol(argv[++i]));
+    }
+    else if (arg == "--runs" && i + 1 < argc) {
+      runs = unsigned(std::max(1, std::atoi(argv[++i])));
+    }
+    else {
+      std::cerr << "usage: " << argv[0] << " [--triangles N] [--runs N]" << std::endl;
+      std::exit(EXIT_FAILURE);
+    }
+  }
+
+  mesh torus = create_torus(triangles);
+  triangles = torus.indices.size() / 3;
+  std::cout << triangles << " triangles, " << torus.positions.size() / 3 << " vertices, "
+            << parallel::thread_count() << " threads, " << runs << " runs" << std::endl;
+
+  std::vector<float> normals = measure("reference normals", runs, triangles, [&]() {
+    return reference_normals(torus);
+  });
+  std::vector<float> area_normals = measure("area weighted normals", runs, triangles, [&]() {
+    return mesh_attributes::normals(torus.positions, torus.indices, mesh_attributes::weighting::area);
+  });
+  std::vector<float> angle_normals = measure("angle weighted normals", runs, triangles, [&]() {
+    return mesh_attributes::normals(torus.positions, torus.indices, mesh_attributes::weighting::angle);
+  });
+  std::vector<float> tangents = measure("reference tangents", runs, triangles, [&]() {
+    return reference_tangents(torus, normals);
+  });
+  std::vector<float> parallel_tangents = measure("tangents", runs, triangles, [&]() {
+    return mesh_attributes::tangents(torus.positions, area_normals, torus.texcoords, torus.indices);
+  });
+
+  std::cout << "max difference to reference - area normals " << max_difference(normals, area_normals)
+            << ", angle normals " << max_difference(normals, angle_normals)
+            << ", tangents " << max_difference(tangents, parallel_tangents) << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,78 @@
+// times every level of mip_chain::build for an image, filtered in linear light and directly
+// sizes of the image are kept, so non-power-of-two chains can be measured as well
+
+#include "mip_chain.hpp"
+#include "texture_loader.hpp"
+#include "benchmark.hpp"
+#include "parallel.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// times runs of function in milliseconds, returns summary
+template<typename Function>
+sample_summary measure(unsigned runs, Function const& function) {
+  std::vector<double> samples{};
+  for (unsigned i = 0; i < runs; ++i) {
+    auto start = std::chrono::steady_clock::now();
+    function();
+    std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - start;
+    samples.push_back(duration.count());
+  }
+  return Benchmark::summarize(samples);
+}
+
+int main(int argc, char* argv[]) {
+  unsigned runs = 10;
+  std::string file{};
+  for (int i = 1; i < argc; ++i) {
+    std::string arg{argv[i]};
+    if (arg == "--runs" && i + 1 < argc) {
+      runs = unsigned(std::max(1, std::atoi(argv[++i])));
+    }
+    else if (arg.compare(0, 2, "--") != 0 && file.empty()) {
+      file = arg;
+    }
+    else {
+      file.clear();
+      break;
+    }
+  }
+  if (file.empty()) {
+    std::cerr << "usage: " << argv[0] << " image [--runs N]" << std::endl;
+    std::exit(EXIT_FAILURE);
+  }
+
+  pixel_data image = texture_loader::file(file);
+  std::cout << file << " - " << image.width << "x" << image.height << ", "
+            << mip_chain::level_num(image.width, image.height) << " levels, "
+            << parallel::thread_count() << " threads, " << runs << " runs" << std::endl;
+
+  for (bool srgb : {true, false}) {
+    std::cout << (srgb ? "linear light" : "direct") << std::endl;
+    // each level is computed from the previous one, as in build
+    std::vector<pixel_data> levels = mip_chain::build(image, srgb);
+    double total = 0.0;
+    for (std::size_t i = 1; i < levels.size(); ++i) {
+      std::size_t volatile sink = 0;
+      sample_summary summary = measure(runs, [&]() {
+        sink = mip_chain::next_level(levels[i - 1], srgb).pixels.size();
+      });
+      total += summary.min;
+      double texels = double(levels[i - 1].width * levels[i - 1].height);
+      std::cout << "  level " << i << " " << levels[i].width << "x" << levels[i].height
+                << " - min " << summary.min << " ms, mean " << summary.mean << " ms, "
+                << texels / (summary.min * 1000.0) << " Mtexel/s read" << std::endl;
+    }
+    sample_summary chain = measure(runs, [&]() {
+      mip_chain::build(image, srgb);
+    });
+    std::cout << "  sum of levels " << total << " ms, build min " << chain.min << " ms, mean " << chain.mean << " ms" << std::endl;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,145 @@
+// compares world matrix propagation of scene_graph with a pointer based tree
+// recomputing every node, on a hierarchy of stars, planets, moons and satellites
+
+#include "scene_graph.hpp"
+#include "benchmark.hpp"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// node of the reference tree, allocated individually
+struct tree_node {
+  glm::fmat4 local;
+  glm::fmat4 world;
+  std::vector<std::unique_ptr<tree_node>> children;
+};
+
+void update_tree(tree_node& node, glm::fmat4 const& parent) {
+  node.world = parent * node.local;
+  for (auto& child : node.children) {
+    update_tree(*child, node.world);
+  }
+}
+
+// orbit of a body at distance with angular speed
+glm::fmat4 animate(float time, float distance, float speed) {
+  glm::fmat4 local = glm::rotate(glm::fmat4{}, time * speed, glm::fvec3{0.0f, 1.0f, 0.0f});
+  return glm::translate(local, glm::fvec3{0.0f, 0.0f, -distance});
+}
+
+struct body {
+  float distance;
+  float speed;
+};
+
+// times runs of function in milliseconds and prints summary
+template<typename Function>
+double measure(std::string const& name, unsigned runs, std::size_t nodes, Function const& function) {
+  std::vector<double> samples{};
+  for (unsigned i = 0; i < runs; ++i) {
+    auto start = std::chrono::steady_clock::now();
+    function(i);
+    std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - start;
+    samples.push_back(duration.count());
+  }
+
+  sample_summary summary = Benchmark::summarize(samples);
+  std::cout << name << " - min " << summary.min << " ms, mean " << summary.mean << " ms, "
+            << double(nodes) / summary.min / 1000.0 << " Mnodes/s" << std::endl;
+  return summary.min;
+}
+
+int main(int argc, char* argv[]) {
+  unsigned depth = 4;
+  unsigned fanout = 10;
+  unsigned runs = 100;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg{argv[i]};
+    if (arg == "--depth" && i + 1 < argc) {
+      depth = unsigned(std::max(1, std::atoi(argv[++i])));
+    }
+    else if (arg == "--fanout" && i + 1 < argc) {
+      fanout = unsigned(std::max(1, std::atoi(argv[++i])));
+    }
+    else if (arg == "--runs" && i + 1 < argc) {
+      runs = unsigned(std::max(1, std::atoi(argv[++i])));
+    }
+    else {
+      std::cerr << "usage: " << argv[0] << " [--depth N] [--fanout N] [--runs N]" << std::endl;
+      std::exit(EXIT_FAILURE);
+    }
+  }
+
+  // build both hierarchies breadth first, like bodies added level by level
+  scene_graph graph{};
+  std::vector<body> bodies{};
+  std::vector<tree_node*> tree_nodes{};
+  std::unique_ptr<tree_node> root{new tree_node{}};
+  bodies.push_back(body{0.0f, 0.1f});
+  tree_nodes.push_back(root.get());
+  graph.add();
+  std::size_t level_begin = 0;
+  for (unsigned level = 0; level < depth; ++level) {
+    std::size_t level_end = bodies.size();
+    for (std::size_t parent = level_begin; parent < level_end; ++parent) {
+      for (unsigned child = 0; child < fanout; ++child) {
+        bodies.push_back(body{float(child + 1) * std::pow(0.2f, float(level)), 1.0f + float(child) * 0.1f});
+        tree_nodes[parent]->children.emplace_back(new tree_node{});
+        tree_nodes.push_back(tree_nodes[parent]->children.back().get());
+        graph.add(parent);
+      }
+    }
+    level_begin = level_end;
+  }
+  std::size_t const count = bodies.size();
+  // moved bodies in partial updates, the leaves of one planet
+  std::size_t const partial = std::min<std::size_t>(count, std::max<std::size_t>(1, count / 100));
+  std::cout << count << " nodes, depth " << depth << ", fanout " << fanout << ", " << runs << " runs" << std::endl;
+
+  double reference = measure("pointer tree, all moving", runs, count, [&](unsigned run) {
+    float time = float(run) * 0.016f;
+    for (std::size_t i = 0; i < count; ++i) {
+      tree_nodes[i]->local = animate(time, bodies[i].distance, bodies[i].speed);
+    }
+    update_tree(*root, glm::fmat4{});
+  });
+  double all = measure("scene_graph, all moving", runs, count, [&](unsigned run) {
+    float time = float(run) * 0.016f;
+    for (std::size_t i = 0; i < count; ++i) {
+      graph.set_local(i, animate(time, bodies[i].distance, bodies[i].speed));
+    }
+    graph.update();
+  });
+
+  // both saw the same animation in the last run
+  float difference = 0.0f;
+  for (std::size_t i = 0; i < count; ++i) {
+    for (int column = 0; column < 4; ++column) {
+      for (int row = 0; row < 4; ++row) {
+        difference = std::max(difference, std::abs(graph.world(i)[column][row] - tree_nodes[i]->world[column][row]));
+      }
+    }
+  }
+
+  std::size_t updated = 0;
+  double some = measure("scene_graph, " + std::to_string(partial) + " moving", runs, count, [&](unsigned run) {
+    float time = float(run) * 0.016f;
+    for (std::size_t i = count - partial; i < count; ++i) {
+      graph.set_local(i, animate(time, bodies[i].distance, bodies[i].speed));
+    }
+    updated = graph.update();
+  });
+
+  std::cout << "speedup all moving " << reference / all << ", partial " << reference / some
+            << " (" << updated << " matrices recomputed), max difference " << difference << std::endl;
+
+  return 0;
+}
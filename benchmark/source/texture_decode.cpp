@@ -0,0 +1,80 @@
+// compares decoding images one after another with decoding them on the worker pool of
+// texture_loader::decode_batch, taking each image as soon as it is ready
+
+#include "texture_loader.hpp"
+#include "benchmark.hpp"
+#include "parallel.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// times runs of function in milliseconds and prints summary
+template<typename Function>
+double measure(std::string const& name, unsigned runs, Function const& function) {
+  std::vector<double> samples{};
+  for (unsigned i = 0; i < runs; ++i) {
+    auto start = std::chrono::steady_clock::now();
+    function();
+    std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - start;
+    samples.push_back(duration.count());
+  }
+
+  sample_summary summary = Benchmark::summarize(samples);
+  std::cout << name << " - min " << summary.min << " ms, mean " << summary.mean << " ms" << std::endl;
+  return summary.min;
+}
+
+int main(int argc, char* argv[]) {
+  unsigned runs = 5;
+  std::vector<std::string> files{};
+  for (int i = 1; i < argc; ++i) {
+    std::string arg{argv[i]};
+    if (arg == "--runs" && i + 1 < argc) {
+      runs = unsigned(std::max(1, std::atoi(argv[++i])));
+    }
+    else if (arg.compare(0, 2, "--") != 0) {
+      files.push_back(arg);
+    }
+    else {
+      std::cerr << "usage: " << argv[0] << " image... [--runs N]" << std::endl;
+      std::exit(EXIT_FAILURE);
+    }
+  }
+  if (files.empty()) {
+    std::cerr << "usage: " << argv[0] << " image... [--runs N]" << std::endl;
+    std::exit(EXIT_FAILURE);
+  }
+  std::cout << files.size() << " images, " << parallel::thread_count() << " threads, " << runs << " runs" << std::endl;
+
+  // slowest single image bounds the parallel time
+  double slowest = 0.0;
+  std::size_t bytes = 0;
+  for (auto const& file : files) {
+    auto start = std::chrono::steady_clock::now();
+    bytes += texture_loader::file(file).pixels.size();
+    std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - start;
+    slowest = std::max(slowest, duration.count());
+  }
+  std::cout << "slowest image - " << slowest << " ms, " << bytes / (1024 * 1024) << " MiB decoded" << std::endl;
+
+  std::size_t volatile sink = 0;
+  double sequential = measure("one after another", runs, [&]() {
+    for (auto const& file : files) {
+      sink = texture_loader::file(file).pixels.size();
+    }
+  });
+  double batched = measure("decode_batch", runs, [&]() {
+    texture_loader::decode_batch decoded{files};
+    for (std::size_t i = decoded.next_ready(); i < decoded.size(); i = decoded.next_ready()) {
+      sink = decoded.image(i).get().pixels.size();
+    }
+  });
+
+  std::cout << "speedup " << sequential / batched << std::endl;
+
+  return EXIT_SUCCESS;
+}
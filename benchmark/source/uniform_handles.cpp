@@ -0,0 +1,161 @@
+// compares cpu cost of setting the per-draw uniforms of a planet
+// through name lookups in shader_program::u_locs and through uniform_handle
+
+#include "structs.hpp"
+#include "shader_loader.hpp"
+#include "uniform_handle.hpp"
+
+#include <glbinding/gl/gl.h>
+#include <glbinding/Binding.h>
+// use gl definitions from glbinding
+using namespace gl;
+
+//dont load gl bindings from glfw
+#define GLFW_INCLUDE_NONE
+#include <GLFW/glfw3.h>
+
+#include <glm/gtc/type_precision.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <string>
+
+static const unsigned DRAW_COUNT = 1000000;
+
+static const char* VERTEX_SOURCE =
+  "#version 150\n"
+  "uniform mat4 ModelMatrix;\n"
+  "uniform mat4 NormalMatrix;\n"
+  "uniform vec3 Color;\n"
+  "uniform int flags;\n"
+  "in vec3 in_Position;\n"
+  "out vec4 pass_Color;\n"
+  "void main() {\n"
+  "  gl_Position = ModelMatrix * vec4(in_Position, 1.0);\n"
+  "  pass_Color = NormalMatrix * vec4(Color, float(flags));\n"
+  "}\n";
+
+static const char* FRAGMENT_SOURCE =
+  "#version 150\n"
+  "in vec4 pass_Color;\n"
+  "out vec4 out_Color;\n"
+  "void main() { out_Color = pass_Color; }\n";
+
+// average time of one simulated draw in nanoseconds
+template<typename Draw>
+double measure(std::string const& name, Draw const& draw) {
+  glFinish();
+  auto start = std::chrono::steady_clock::now();
+  for (unsigned i = 0; i < DRAW_COUNT; ++i) {
+    draw(i);
+  }
+  glFinish();
+  std::chrono::duration<double, std::nano> duration = std::chrono::steady_clock::now() - start;
+
+  double per_draw = duration.count() / double(DRAW_COUNT);
+  std::cout << name << " - " << per_draw << " ns/draw" << std::endl;
+  return per_draw;
+}
+
+GLuint create_program() {
+  GLuint vertex_shader = glCreateShader(GL_VERTEX_SHADER);
+  glShaderSource(vertex_shader, 1, &VERTEX_SOURCE, nullptr);
+  glCompileShader(vertex_shader);
+  GLuint fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
+  glShaderSource(fragment_shader, 1, &FRAGMENT_SOURCE, nullptr);
+  glCompileShader(fragment_shader);
+
+  GLuint program = glCreateProgram();
+  glAttachShader(program, vertex_shader);
+  glAttachShader(program, fragment_shader);
+  glLinkProgram(program);
+  glDeleteShader(vertex_shader);
+  glDeleteShader(fragment_shader);
+  return program;
+}
+
+int main(int argc, char* argv[]) {
+  if (!glfwInit()) {
+    std::exit(EXIT_FAILURE);
+  }
+  // invisible window only provides the context
+  glfwWindowHint(GLFW_VISIBLE, false);
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+  GLFWwindow* window = glfwCreateWindow(64, 64, "uniform handles", NULL, NULL);
+  if (!window) {
+    glfwTerminate();
+    std::exit(EXIT_FAILURE);
+  }
+  glfwMakeContextCurrent(window);
+  glbinding::Binding::initialize();
+
+  // programs stored like in the applications
+  std::map<std::string, shader_program> shaders{};
+  shaders.emplace("planet", shader_program{"planet.vert", "planet.frag"});
+  // neighbours make the map lookup realistic
+  shaders.emplace("orbit", shader_program{"orbit.vert", "orbit.frag"});
+  shaders.emplace("starfield", shader_program{"starfield.vert", "starfield.frag"});
+  shaders.emplace("rtt", shader_program{"post-processing.vert", "post-processing.frag"});
+  shaders.emplace("font", shader_program{"font.vert", "font.frag"});
+
+  shader_program& planet = shaders.at("planet");
+  planet.handle = create_program();
+  shader_loader::reflect(planet);
+  for (char const* name : {"ModelMatrix", "NormalMatrix", "Color", "flags", "LightPosition", "texDiffuse"}) {
+    planet.u_locs[name] = glGetUniformLocation(planet.handle, name);
+  }
+  glUseProgram(planet.handle);
+
+  uniform_handle<glm::fmat4> model_matrix{planet, "ModelMatrix"};
+  uniform_handle<glm::fmat4> normal_matrix{planet, "NormalMatrix"};
+  uniform_handle<glm::fvec3> color{planet, "Color"};
+  uniform_handle<GLint> flags{planet, "flags"};
+
+  glm::fmat4 matrix{};
+  glm::fvec3 value{1.0f, 0.5f, 0.25f};
+  std::cout << "4 uniforms per draw, " << DRAW_COUNT << " draws" << std::endl;
+
+  // location lookups alone
+  GLint volatile sink = 0;
+  double map_lookup = measure("u_locs lookup", [&](unsigned) {
+    sink = shaders.at("planet").u_locs.at("flags");
+    sink = shaders.at("planet").u_locs.at("Color");
+    sink = shaders.at("planet").u_locs.at("ModelMatrix");
+    sink = shaders.at("planet").u_locs.at("NormalMatrix");
+  });
+  double handle_lookup = measure("uniform_handle lookup", [&](unsigned) {
+    sink = flags.location();
+    sink = color.location();
+    sink = model_matrix.location();
+    sink = normal_matrix.location();
+  });
+
+  // lookups with uploads
+  double map_upload = measure("u_locs with upload", [&](unsigned i) {
+    matrix[3][0] = float(i);
+    glUniform1i(shaders.at("planet").u_locs.at("flags"), GLint(i & 7));
+    glUniform3fv(shaders.at("planet").u_locs.at("Color"), 1, glm::value_ptr(value));
+    glUniformMatrix4fv(shaders.at("planet").u_locs.at("ModelMatrix"), 1, GL_FALSE, glm::value_ptr(matrix));
+    glUniformMatrix4fv(shaders.at("planet").u_locs.at("NormalMatrix"), 1, GL_FALSE, glm::value_ptr(matrix));
+  });
+  double handle_upload = measure("uniform_handle with upload", [&](unsigned i) {
+    matrix[3][0] = float(i);
+    flags.set(GLint(i & 7));
+    color.set(value);
+    model_matrix.set(matrix);
+    normal_matrix.set(matrix);
+  });
+
+  std::cout << "lookup speedup " << map_lookup / handle_lookup
+            << ", with upload " << map_upload / handle_upload << std::endl;
+
+  glDeleteProgram(planet.handle);
+  glfwDestroyWindow(window);
+  glfwTerminate();
+
+  return EXIT_SUCCESS;
+}
@@ -9,6 +9,7 @@
 
 #include <glbinding/ProcAddress.h>
 #include <glbinding/FunctionCall.h>
+#include <glbinding/CallRecord.h>
 #include <glbinding/CallbackMask.h>
 
 
@@ -157,6 +158,26 @@ public:
      */
     void after(const FunctionCall & call) const;
 
+    /**
+     * @brief
+     *   Triggers a call of the record callback, passing the unboxed parameters and return value.
+     *
+     * @param[in] record
+     *   The parameters and the return value of the current function call.
+     */
+    void record(const CallRecord & record) const;
+
+    /**
+     * @brief
+     *   Executes a function call with arguments packed as written by CallRecord::writeArguments, omitting all callbacks.
+     *
+     * @param[in] arguments
+     *   The packed raw argument values
+     * @param[out] returnValue
+     *   Destination of the raw return value, may be nullptr
+     */
+    virtual void replay(const unsigned char * arguments, void * returnValue) const = 0;
+
 protected:
     /**
      * @brief
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <glbinding/glbinding_api.h>
+
+#include <glbinding/FunctionCall.h>
+
+
+namespace glbinding
+{
+
+
+class AbstractFunction;
+class AbstractValue;
+
+/**
+ * @brief
+ *   A lightweight description of a function call, created on the stack of the caller.
+ *
+ *   In contrast to FunctionCall, arguments and return value are referenced in place and
+ *   only converted into heap allocated AbstractValues on request.
+ *   Dispatching a CallRecord to the record callback thus does not allocate.
+ *   A CallRecord is only valid during the execution of the record callback.
+ */
+struct GLBINDING_API CallRecord
+{
+public:
+    using ParametersCreator = std::vector<AbstractValue *> (*)(const void * arguments); ///< Boxes the referenced argument tuple.
+    using ReturnValueCreator = AbstractValue * (*)(const void * returnValue); ///< Boxes the referenced return value.
+    using ArgumentsWriter = void (*)(const void * arguments, unsigned char * data); ///< Copies the referenced argument tuple into packed raw bytes.
+
+    /**
+     * @brief
+     *   Type erased operations and layout of a function signature, one static instance per signature.
+     *
+     *   The packed argument layout written by writeArguments is the layout expected by AbstractFunction::replay.
+     */
+    struct Signature
+    {
+        ParametersCreator createParameters; ///< Boxes the arguments
+        ReturnValueCreator createReturnValue; ///< Boxes the return value; nullptr for functions without return value
+        ArgumentsWriter writeArguments; ///< Packs the arguments without padding
+        std::size_t argumentCount; ///< Number of arguments
+        const std::size_t * argumentSizes; ///< Size in bytes of each argument
+        std::size_t argumentsSize; ///< Size in bytes of the packed arguments
+        std::uint32_t pointerArguments; ///< Bit i is set if argument i is a pointer
+        std::size_t returnValueSize; ///< Size in bytes of the return value; 0 for functions without return value
+    };
+
+public:
+    /**
+     * @brief
+     *   Constructor
+     *
+     * @param[in] _function
+     *   The called function
+     * @param[in] _arguments
+     *   Pointer to a std::tuple of the call arguments
+     * @param[in] _returnValue
+     *   Pointer to the return value, nullptr for functions without return value
+     * @param[in] _signature
+     *   The operations on arguments and return value of the function signature
+     */
+    CallRecord(const AbstractFunction * _function
+        , const void * _arguments
+        , const void * _returnValue
+        , const Signature & _signature);
+
+    /**
+     * @brief
+     *   Box the arguments of this call
+     *
+     * @return
+     *   The list of argument values; ownership is transferred to the caller
+     */
+    std::vector<AbstractValue *> createParameters() const;
+
+    /**
+     * @brief
+     *   Box the return value of this call
+     *
+     * @return
+     *   The return value or nullptr if the function has no return value; ownership is transferred to the caller
+     */
+    AbstractValue * createReturnValue() const;
+
+    /**
+     * @brief
+     *   Convert into a fully materialized FunctionCall, e.g. for logging
+     *
+     * @return
+     *   The function call with parameters and return value
+     */
+    FunctionCall toFunctionCall() const;
+
+    /**
+     * @brief
+     *   Build a string representation of name, arguments and return value, without timestamp
+     *
+     * @return
+     *   The string representation
+     */
+    std::string toString() const;
+
+    /**
+     * @brief
+     *   Copy the raw argument values, packed without padding
+     *
+     * @param[out] data
+     *   Destination of at least signature.argumentsSize bytes
+     */
+    void writeArguments(unsigned char * data) const;
+
+    /**
+     * @brief
+     *   Copy the raw return value
+     *
+     * @param[out] data
+     *   Destination of at least signature.returnValueSize bytes
+     */
+    void writeReturnValue(unsigned char * data) const;
+
+public:
+    const AbstractFunction * function; ///< The function of this call
+    const void * arguments; ///< Pointer to a std::tuple of the argument values
+    const void * returnValue; ///< Pointer to the return value; nullptr for functions without return value
+    const Signature & signature; ///< Operations and layout of the function signature
+};
+
+
+} // namespace glbinding
@@ -21,6 +21,7 @@ enum class CallbackMask : unsigned char
     Parameters  = 1 << 3, ///< Enables the provision of parameter values in the before and after callbacks.
     ReturnValue = 1 << 4, ///< Enables the provision of a return value in the after callback.
     Logging     = 1 << 5, ///< Enables logging to file.
+    Record      = 1 << 6, ///< Enables the allocation-free record callback, see CallRecord.
     ParametersAndReturnValue = Parameters | ReturnValue,
     BeforeAndAfter = Before | After
 };
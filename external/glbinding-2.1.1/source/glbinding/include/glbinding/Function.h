@@ -119,6 +119,19 @@ public:
      */
     ReturnType directCall(Arguments... arguments) const;
 
+    /**
+     * @brief
+     *   Executes a function call with arguments packed as written by CallRecord::writeArguments.
+     *
+     * @param[in] arguments
+     *   The packed raw argument values
+     * @param[out] returnValue
+     *   Destination of the raw return value, may be nullptr
+     *
+     * This method omits all currently activated callbacks and logging.
+     */
+    virtual void replay(const unsigned char * arguments, void * returnValue) const override;
+
     /**
      * @brief
      *   Register a callback that is triggered before a function call to the OpenGL driver.
@@ -1,9 +1,15 @@
 
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <utility>
 #include <functional>
 #include <memory>
+#include <tuple>
+#include <type_traits>
+#include <vector>
 
 #include <glbinding/logging.h>
 #include <glbinding/Value.h>
@@ -35,6 +41,219 @@ struct BasicCallHelper<gl::GLboolean, Arguments...>
 };
 
 
+// Compile time index list to unpack argument tuples (std::index_sequence requires C++14)
+
+template <std::size_t... Indices>
+struct IndexSequence
+{
+};
+
+template <std::size_t Count, std::size_t... Indices>
+struct MakeIndexSequence : MakeIndexSequence<Count - 1, Count - 1, Indices...>
+{
+};
+
+template <std::size_t... Indices>
+struct MakeIndexSequence<0, Indices...>
+{
+    using type = IndexSequence<Indices...>;
+};
+
+
+// Boxes the arguments and return value referenced by a CallRecord on request
+
+template <typename... Arguments>
+struct RecordValueCreator
+{
+    static std::vector<glbinding::AbstractValue*> parameters(const void * arguments)
+    {
+        return unpack(*static_cast<const std::tuple<Arguments...> *>(arguments), typename MakeIndexSequence<sizeof...(Arguments)>::type());
+    }
+
+    template <std::size_t... Indices>
+    static std::vector<glbinding::AbstractValue*> unpack(const std::tuple<Arguments...> & arguments, IndexSequence<Indices...>)
+    {
+        return glbinding::createValues(static_cast<Arguments>(std::get<Indices>(arguments))...);
+    }
+
+    template <typename ReturnType>
+    static glbinding::AbstractValue * returnValue(const void * value)
+    {
+        return glbinding::createValue(*static_cast<const ReturnType *>(value));
+    }
+};
+
+
+// Packs the arguments of a CallRecord into raw bytes and unpacks them for replay
+
+template <typename... Arguments>
+struct ArgumentPacker;
+
+template <>
+struct ArgumentPacker<>
+{
+    static const std::size_t size = 0;
+    static const std::uint32_t pointers = 0;
+};
+
+template <typename Argument, typename... Rest>
+struct ArgumentPacker<Argument, Rest...>
+{
+    static const std::size_t size = sizeof(Argument) + ArgumentPacker<Rest...>::size;
+    static const std::uint32_t pointers = (std::is_pointer<Argument>::value ? 1u : 0u) | (ArgumentPacker<Rest...>::pointers << 1);
+};
+
+template <std::size_t Index, typename... Arguments>
+struct ArgumentOffset;
+
+template <typename Argument, typename... Rest>
+struct ArgumentOffset<0, Argument, Rest...>
+{
+    static const std::size_t value = 0;
+};
+
+template <std::size_t Index, typename Argument, typename... Rest>
+struct ArgumentOffset<Index, Argument, Rest...>
+{
+    static const std::size_t value = sizeof(Argument) + ArgumentOffset<Index - 1, Rest...>::value;
+};
+
+template <typename Type>
+Type readArgument(const unsigned char * data)
+{
+    // packed data is unaligned and some types are not default constructible
+    typename std::aligned_storage<sizeof(Type), alignof(Type)>::type storage;
+    std::memcpy(&storage, static_cast<const void *>(data), sizeof(Type));
+    return *reinterpret_cast<const Type *>(&storage);
+}
+
+template <typename... Arguments>
+struct ArgumentLayout
+{
+    static const std::size_t sizes[sizeof...(Arguments) + 1];
+
+    static void write(const void * arguments, unsigned char * data)
+    {
+        pack(*static_cast<const std::tuple<Arguments...> *>(arguments), data, typename MakeIndexSequence<sizeof...(Arguments)>::type());
+    }
+
+    template <std::size_t... Indices>
+    static void pack(const std::tuple<Arguments...> & arguments, unsigned char * data, IndexSequence<Indices...>)
+    {
+        const int expand[] = { 0, (std::memcpy(data + ArgumentOffset<Indices, Arguments...>::value, &std::get<Indices>(arguments), sizeof(Arguments)), 0)... };
+        (void)expand;
+        (void)arguments;
+        (void)data;
+    }
+};
+
+template <typename... Arguments>
+const std::size_t ArgumentLayout<Arguments...>::sizes[sizeof...(Arguments) + 1] = { sizeof(Arguments)..., 0 };
+
+
+// Static type erased description of a signature, referenced by each CallRecord
+
+template <typename ReturnType, typename... Arguments>
+struct RecordSignature
+{
+    static const glbinding::CallRecord::Signature value;
+};
+
+template <typename ReturnType, typename... Arguments>
+const glbinding::CallRecord::Signature RecordSignature<ReturnType, Arguments...>::value = {
+    &RecordValueCreator<Arguments...>::parameters,
+    &RecordValueCreator<Arguments...>::template returnValue<ReturnType>,
+    &ArgumentLayout<Arguments...>::write,
+    sizeof...(Arguments),
+    ArgumentLayout<Arguments...>::sizes,
+    ArgumentPacker<Arguments...>::size,
+    ArgumentPacker<Arguments...>::pointers,
+    sizeof(ReturnType)
+};
+
+template <typename... Arguments>
+struct RecordSignature<void, Arguments...>
+{
+    static const glbinding::CallRecord::Signature value;
+};
+
+template <typename... Arguments>
+const glbinding::CallRecord::Signature RecordSignature<void, Arguments...>::value = {
+    &RecordValueCreator<Arguments...>::parameters,
+    nullptr,
+    &ArgumentLayout<Arguments...>::write,
+    sizeof...(Arguments),
+    ArgumentLayout<Arguments...>::sizes,
+    ArgumentPacker<Arguments...>::size,
+    ArgumentPacker<Arguments...>::pointers,
+    0
+};
+
+
+// Calls the function with arguments unpacked from raw bytes
+
+template <typename ReturnType, typename... Arguments>
+struct ReplayHelper
+{
+    template <std::size_t... Indices>
+    static void call(const glbinding::Function<ReturnType, Arguments...> * function, const unsigned char * arguments, void * returnValue, IndexSequence<Indices...>)
+    {
+        (void)arguments;
+        const ReturnType value = function->directCall(readArgument<Arguments>(arguments + ArgumentOffset<Indices, Arguments...>::value)...);
+
+        if (returnValue != nullptr)
+        {
+            std::memcpy(returnValue, &value, sizeof(ReturnType));
+        }
+    }
+};
+
+template <typename... Arguments>
+struct ReplayHelper<void, Arguments...>
+{
+    template <std::size_t... Indices>
+    static void call(const glbinding::Function<void, Arguments...> * function, const unsigned char * arguments, void *, IndexSequence<Indices...>)
+    {
+        (void)arguments;
+        function->directCall(readArgument<Arguments>(arguments + ArgumentOffset<Indices, Arguments...>::value)...);
+    }
+};
+
+
+// Calls the function and passes a stack allocated CallRecord to the record callback
+
+template <typename ReturnType, typename... Arguments>
+struct RecordHelper
+{
+    ReturnType call(const glbinding::Function<ReturnType, Arguments...> * function, Arguments&&... arguments) const
+    {
+        const std::tuple<Arguments...> argumentValues{arguments...};
+
+        auto value = BasicCallHelper<ReturnType, Arguments ...>::call(function, std::forward<Arguments>(arguments)...);
+
+        function->record(glbinding::CallRecord{function
+            , &argumentValues, &value, RecordSignature<ReturnType, Arguments...>::value});
+
+        return value;
+    }
+};
+
+
+template <typename... Arguments>
+struct RecordHelper<void, Arguments...>
+{
+    void call(const glbinding::Function<void, Arguments...> * function, Arguments&&... arguments) const
+    {
+        const std::tuple<Arguments...> argumentValues{arguments...};
+
+        BasicCallHelper<void, Arguments ...>::call(function, std::forward<Arguments>(arguments)...);
+
+        function->record(glbinding::CallRecord{function
+            , &argumentValues, nullptr, RecordSignature<void, Arguments...>::value});
+    }
+};
+
+
 template <typename ReturnType, typename... Arguments>
 struct FunctionHelper
 {
@@ -74,6 +293,14 @@ struct FunctionHelper
             }
         }
 
+        if (function->isEnabled(glbinding::CallbackMask::Record))
+        {
+            const std::tuple<Arguments...> argumentValues{arguments...};
+
+            function->record(glbinding::CallRecord{function
+                , &argumentValues, &value, RecordSignature<ReturnType, Arguments...>::value});
+        }
+
         if(function->isEnabled(glbinding::CallbackMask::Logging))
         {
             glbinding::logging::log(functionCall.release());
@@ -118,6 +345,14 @@ struct FunctionHelper<void, Arguments...>
             }
         }
 
+        if (function->isEnabled(glbinding::CallbackMask::Record))
+        {
+            const std::tuple<Arguments...> argumentValues{arguments...};
+
+            function->record(glbinding::CallRecord{function
+                , &argumentValues, nullptr, RecordSignature<void, Arguments...>::value});
+        }
+
         if(function->isEnabled(glbinding::CallbackMask::Logging))
         {
             glbinding::logging::log(functionCall.release());
@@ -167,6 +402,10 @@ ReturnType Function<ReturnType, Arguments...>::call(Arguments&... arguments) con
     {
         return FunctionHelper<ReturnType, Arguments...>().call(this, std::forward<Arguments>(arguments)...);
     }
+    else if (isEnabled(CallbackMask::Record))
+    {
+        return RecordHelper<ReturnType, Arguments...>().call(this, std::forward<Arguments>(arguments)...);
+    }
     else
     {
         return BasicCallHelper<ReturnType, Arguments...>::call(this, std::forward<Arguments>(arguments)...);
@@ -179,6 +418,12 @@ ReturnType Function<ReturnType, Arguments...>::directCall(Arguments... arguments
     return BasicCallHelper<ReturnType, Arguments...>::call(this, std::forward<Arguments>(arguments)...);
 }
 
+template <typename ReturnType, typename... Arguments>
+void Function<ReturnType, Arguments...>::replay(const unsigned char * arguments, void * returnValue) const
+{
+    ReplayHelper<ReturnType, Arguments...>::call(this, arguments, returnValue, typename MakeIndexSequence<sizeof...(Arguments)>::type());
+}
+
 template <typename ReturnType, typename... Arguments>
 void Function<ReturnType, Arguments...>::setBeforeCallback(BeforeCallback callback)
 {
@@ -8,6 +8,7 @@
 
 #include <glbinding/CallbackMask.h>
 #include <glbinding/FunctionCall.h>
+#include <glbinding/CallRecord.h>
 
 
 namespace glbinding 
@@ -86,6 +87,14 @@ using SimpleFunctionCallback = std::function<void(const AbstractFunction &)>;
  */
 using FunctionCallback = std::function<void(const FunctionCall &)>;
 
+/**
+ * @brief
+ *   The signature of the record callback.
+ *
+ *   A plain function pointer, so dispatching a call record neither allocates nor goes through std::function.
+ */
+using RecordCallback = void (*)(const CallRecord &);
+
 /**
  * @brief
  *   Unresolved callback accessor.
@@ -155,5 +164,29 @@ GLBINDING_API FunctionCallback afterCallback();
  */
 GLBINDING_API void setAfterCallback(FunctionCallback callback);
 
+/**
+ * @brief
+ *   Record callback accessor.
+ *
+ * @return
+ *   The callback to use after an OpenGL function call, receiving the unboxed parameters and return value.
+ *
+ * Keep in mind that in addition to a registered callback, the callback mask of the current Function has to include the Record flag to enable the callback.
+ */
+GLBINDING_API RecordCallback recordCallback();
+
+/**
+ * @brief
+ *   Updates the record callback that is called after an OpenGL function call.
+ *
+ * @param[in] callback
+ *   The new record callback, nullptr to disable.
+ *
+ * In contrast to the after callback, no FunctionCall is allocated and the parameters are only boxed into AbstractValues
+ * when the callback requests them from the CallRecord.
+ * Keep in mind that in addition to a registered callback, the callback mask of the current Function has to include the Record flag to enable the callback.
+ */
+GLBINDING_API void setRecordCallback(RecordCallback callback);
+
 
 } // namespace glbinding
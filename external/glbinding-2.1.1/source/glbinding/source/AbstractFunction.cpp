@@ -217,5 +217,10 @@ void AbstractFunction::after(const FunctionCall & call) const
     glbinding::after(call);
 }
 
+void AbstractFunction::record(const CallRecord & record) const
+{
+    glbinding::record(record);
+}
+
 
 } // namespace glbinding
@@ -0,0 +1,91 @@
+
+#include <glbinding/CallRecord.h>
+
+#include <cstring>
+#include <sstream>
+
+#include <glbinding/AbstractFunction.h>
+#include <glbinding/AbstractValue.h>
+
+
+namespace glbinding
+{
+
+
+CallRecord::CallRecord(const AbstractFunction * _function
+    , const void * _arguments
+    , const void * _returnValue
+    , const Signature & _signature)
+: function(_function)
+, arguments(_arguments)
+, returnValue(_returnValue)
+, signature(_signature)
+{
+}
+
+std::vector<AbstractValue *> CallRecord::createParameters() const
+{
+    return signature.createParameters(arguments);
+}
+
+AbstractValue * CallRecord::createReturnValue() const
+{
+    if (returnValue == nullptr || signature.createReturnValue == nullptr)
+    {
+        return nullptr;
+    }
+
+    return signature.createReturnValue(returnValue);
+}
+
+FunctionCall CallRecord::toFunctionCall() const
+{
+    FunctionCall call(function);
+
+    call.parameters = createParameters();
+    call.returnValue = createReturnValue();
+
+    return call;
+}
+
+std::string CallRecord::toString() const
+{
+    const auto call = toFunctionCall();
+
+    std::ostringstream os;
+    os << function->name() << "(";
+
+    for (size_t i = 0; i < call.parameters.size(); ++i)
+    {
+        os << call.parameters[i]->asString();
+        if (i < call.parameters.size() - 1)
+            os << ", ";
+    }
+
+    os << ")";
+
+    if (call.returnValue)
+    {
+        os << " -> " << call.returnValue->asString();
+    }
+
+    return os.str();
+}
+
+void CallRecord::writeArguments(unsigned char * data) const
+{
+    signature.writeArguments(arguments, data);
+}
+
+void CallRecord::writeReturnValue(unsigned char * data) const
+{
+    if (returnValue == nullptr)
+    {
+        return;
+    }
+
+    std::memcpy(data, returnValue, signature.returnValueSize);
+}
+
+
+} // namespace glbinding
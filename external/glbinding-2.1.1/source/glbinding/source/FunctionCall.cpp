@@ -23,9 +23,13 @@ FunctionCall::FunctionCall(const AbstractFunction * _function)
 
 FunctionCall::FunctionCall(FunctionCall && other)
 : function(std::move(other.function))
+, timestamp(std::move(other.timestamp))
 , parameters(std::move(other.parameters))
-, returnValue(std::move(other.returnValue))
+, returnValue(other.returnValue)
 {
+    // the moved-from call must not delete the values on destruction
+    other.parameters.clear();
+    other.returnValue = nullptr;
 }
 
 FunctionCall::~FunctionCall()
@@ -83,10 +87,26 @@ std::string FunctionCall::toString() const
 
 FunctionCall & FunctionCall::operator=(FunctionCall && other)
 {
+    if (this == &other)
+    {
+        return *this;
+    }
+
+    delete returnValue;
+
+    for (auto value : parameters)
+    {
+        delete value;
+    }
+
     function = std::move(other.function);
     timestamp = std::move(other.timestamp);
     parameters = std::move(other.parameters);
-    returnValue = std::move(other.returnValue);
+    returnValue = other.returnValue;
+
+    // the moved-from call must not delete the values on destruction
+    other.parameters.clear();
+    other.returnValue = nullptr;
 
     return *this;
 }
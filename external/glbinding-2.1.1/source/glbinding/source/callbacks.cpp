@@ -10,6 +10,7 @@ namespace
 glbinding::SimpleFunctionCallback g_unresolvedCallback;
 glbinding::FunctionCallback g_beforeCallback;
 glbinding::FunctionCallback g_afterCallback;
+glbinding::RecordCallback g_recordCallback = nullptr;
 
 } // namespace
 
@@ -105,6 +106,16 @@ void setAfterCallback(FunctionCallback callback)
     g_afterCallback = std::move(callback);
 }
 
+RecordCallback recordCallback()
+{
+    return g_recordCallback;
+}
+
+void setRecordCallback(RecordCallback callback)
+{
+    g_recordCallback = callback;
+}
+
 void unresolved(const AbstractFunction * function)
 {
     if (g_unresolvedCallback)
@@ -129,5 +140,13 @@ void after(const FunctionCall & call)
     }
 }
 
+void record(const CallRecord & record)
+{
+    if (g_recordCallback)
+    {
+        g_recordCallback(record);
+    }
+}
+
 
 } // namespace glbinding
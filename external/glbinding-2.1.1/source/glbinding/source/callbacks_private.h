@@ -8,10 +8,12 @@ namespace glbinding
 
 class AbstractFunction;
 struct FunctionCall;
+struct CallRecord;
 
 void unresolved(const AbstractFunction * function);
 void before(const FunctionCall & call);
 void after(const FunctionCall & call);
+void record(const CallRecord & record);
 
 
 } // namespace glbinding
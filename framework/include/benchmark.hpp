@@ -0,0 +1,60 @@
+#ifndef BENCHMARK_HPP
+#define BENCHMARK_HPP
+
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// statistics of a series of samples
+struct sample_summary {
+  std::size_t count = 0;
+  double min = 0.0;
+  double max = 0.0;
+  double mean = 0.0;
+  double p50 = 0.0;
+  double p95 = 0.0;
+  double p99 = 0.0;
+  double total = 0.0;
+};
+
+// records frame times of a fixed-length run and writes a report
+class Benchmark {
+ public:
+  // measure given number of frames after skipping the warmup frames
+  Benchmark(unsigned frames, unsigned warmup);
+
+  // mark beginning and end of a frame
+  void beginFrame();
+  void endFrame();
+  // true when all warmup and measured frames were recorded
+  bool finished() const;
+
+  // compute min, mean and percentiles of samples
+  static sample_summary summarize(std::vector<double> samples);
+
+  // print summary of measured frames
+  void print(std::ostream& os) const;
+  // write per-frame times and summary as csv
+  void writeReport(std::string const& file_path) const;
+
+ private:
+  typedef std::chrono::steady_clock clock;
+
+  // number of frames to measure
+  const unsigned m_frames;
+  // number of frames to skip before measuring
+  const unsigned m_warmup;
+  // number of frames already rendered, including warmup
+  unsigned m_frame_count;
+
+  clock::time_point m_frame_start;
+  // begin of first and end of last measured frame
+  clock::time_point m_run_start;
+  clock::time_point m_run_end;
+
+  // cpu time of measured frames in milliseconds
+  std::vector<double> m_frame_times;
+};
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef BLOCK_COMPRESSION_HPP
+#define BLOCK_COMPRESSION_HPP
+
+#include "pixel_data.hpp"
+
+#include <cstdint>
+#include <vector>
+
+// encoding of 8 bit images into 4x4 block compressed texture formats
+// GL_COMPRESSED_RGB_S3TC_DXT1_EXT (BC1) stores rgb in 4 bits per texel,
+// GL_COMPRESSED_RG_RGTC2 (BC5) stores red and green in 8 bits per texel, e.g. x and y of normals
+namespace block_compression {
+  // bytes of one block, throws std::invalid_argument for other formats
+  std::size_t block_size(GLenum format);
+  // bytes of compressed image, partial blocks at the border are stored completely
+  std::size_t image_size(GLenum format, std::size_t width, std::size_t height);
+
+  // compress rows from bottom to top, grey is replicated to rgb, alpha is dropped
+  // border blocks repeat the last row and column
+  std::vector<std::uint8_t> compress(pixel_data const& image, GLenum format);
+}
+
+#endif
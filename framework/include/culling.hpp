@@ -0,0 +1,45 @@
+#ifndef CULLING_HPP
+#define CULLING_HPP
+
+#include "structs.hpp"
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
+
+#include <ostream>
+#include <vector>
+
+// view frustum culling of bounding spheres, four spheres per test with SSE
+// visible and tested spheres are counted per frame for the statistics output
+namespace culling {
+  // planes with normals pointing inside, points p with dot(plane, (p, 1)) >= 0 are inside
+  struct frustum {
+    glm::fvec4 planes[6];
+  };
+  // number of spheres in a frame
+  struct counters {
+    unsigned long tested;
+    unsigned long visible;
+  };
+
+  // sphere around interleaved vertices starting with their position, stride in floats
+  bounding_sphere bounds(GLfloat const* data, std::size_t vertex_num, std::size_t stride);
+  // planes of the clip volume, view_projection transforms world to clip space
+  frustum extract(glm::fmat4 const& view_projection);
+
+  // spheres around local transformed by model matrices, radius grows with the largest axis scale
+  void transform(bounding_sphere const& local, glm::fmat4 const* models, std::size_t count, bounding_sphere* out);
+  // append indices of spheres at least partially inside the frustum to visible
+  // spheres are added to the frame counters unless counted is false, e.g. for cells of objects with own statistics
+  void cull(frustum const& volume, bounding_sphere const* spheres, std::size_t count, std::vector<std::size_t>& visible,
+            bool counted = true);
+
+  // finish counting of frame, call after buffer swap
+  void frame();
+  // counters of last finished frame
+  counters last_frame();
+  // print counters of last frame
+  void print(std::ostream& os);
+}
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef FRAME_RING_HPP
+#define FRAME_RING_HPP
+
+#include <glbinding/gl/types.h>
+// use gl definitions from glbinding
+using namespace gl;
+
+#include <vector>
+
+// range of a frame_ring buffer holding uploaded data
+struct ring_range {
+  GLuint buffer = 0;
+  GLintptr offset = 0;
+  GLsizeiptr size = 0;
+};
+
+// streaming buffer split into one partition per frame in flight
+// each frame sub-allocates aligned ranges from its partition, which is only
+// reused once a fence shows the gpu finished the frame that last used it,
+// so uploads never wait on the driver for buffer contents still being read
+class frame_ring {
+ public:
+  // uniform buffers are aligned to GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, other targets to alignment
+  frame_ring(GLenum target, GLsizeiptr frame_size, unsigned frames = 3, GLsizeiptr alignment = 16);
+  frame_ring(frame_ring const&) = delete;
+  frame_ring& operator=(frame_ring const&) = delete;
+  // requires the context to still exist
+  ~frame_ring();
+
+  // finish allocations of the current frame and switch to the next partition,
+  // waits if the gpu still reads it, call once per frame before the first upload
+  void next_frame();
+
+  // copy data into a new range of the current partition
+  // throws std::length_error if the partition is full
+  ring_range upload(void const* data, GLsizeiptr size);
+  template<typename T>
+  ring_range upload(T const& value) {
+    return upload(&value, GLsizeiptr(sizeof(T)));
+  }
+  // bind range to indexed binding point of target
+  void bind(GLuint index, ring_range const& range) const;
+
+  GLuint buffer() const;
+  // bytes available to the uploads of each frame
+  GLsizeiptr frame_size() const;
+  GLsizeiptr alignment() const;
+  // number of frames in which next_frame had to wait for the gpu
+  unsigned long stalls() const;
+
+ private:
+  GLenum m_target;
+  GLsizeiptr m_frame_size;
+  GLsizeiptr m_alignment;
+  GLuint m_buffer;
+  // fence after last use of each partition, null if unused
+  std::vector<GLsync> m_fences;
+  unsigned m_frame;
+  // start of free space in current partition
+  GLsizeiptr m_head;
+  unsigned long m_stalls;
+};
+
+#endif
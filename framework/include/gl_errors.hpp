@@ -0,0 +1,34 @@
+#ifndef GL_ERRORS_HPP
+#define GL_ERRORS_HPP
+
+#include <string>
+
+// runtime detection of OpenGL errors with selectable overhead
+namespace gl_errors {
+  // checking modes, ordered from cheapest to most expensive
+  enum class tier {
+    // no checking and no glbinding callbacks
+    off,
+    // asynchronous messages from driver via KHR_debug/ARB_debug_output
+    debug_output,
+    // single glGetError sweep after each frame
+    per_frame,
+    // glGetError after every function call, throws on error
+    per_call
+  };
+
+  // tier selected by cmake option GL_ERROR_CHECK
+  tier default_tier();
+  // parse "off", "debug", "frame" or "call", throws on unknown name
+  tier parse(std::string const& name);
+  // name of tier as accepted by parse
+  std::string name(tier level);
+
+  // install checking in current context, returns activated tier
+  // falls back to per_frame if debug output is not supported
+  tier activate(tier level);
+  // report errors since last call, only active in per_frame tier
+  void check_frame();
+}
+
+#endif
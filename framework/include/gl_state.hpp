@@ -0,0 +1,65 @@
+#ifndef GL_STATE_HPP
+#define GL_STATE_HPP
+
+#include <glbinding/gl/types.h>
+// use gl definitions from glbinding
+using namespace gl;
+
+#include <ostream>
+
+// shadow copy of bound objects and fixed function state, filtering redundant calls
+// until initialize is called every function forwards to GL unfiltered
+// state changed by direct GL calls must be announced with invalidate
+namespace gl_state {
+  // number of state calls in a frame
+  struct counters {
+    // reached the driver
+    unsigned long issued;
+    // filtered as redundant
+    unsigned long filtered;
+  };
+
+  // start filtering with all state unknown, requires a current context
+  void initialize();
+  // stop filtering
+  void release();
+  // true if initialized
+  bool active();
+  // forget all shadowed state, e.g. after GL was used directly
+  void invalidate();
+
+  // finish counting of frame, call after buffer swap
+  void frame();
+  // counters of last finished frame
+  counters last_frame();
+  // print counters of last frame
+  void print(std::ostream& os);
+
+  void use_program(GLuint program);
+  void bind_vertex_array(GLuint vertex_array);
+  // element array binding is part of the vertex array and forgotten when it changes
+  void bind_buffer(GLenum target, GLuint buffer);
+  // binds indexed target, also changes generic binding of target
+  void bind_buffer_base(GLenum target, GLuint index, GLuint buffer);
+  void bind_buffer_range(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+  void bind_framebuffer(GLenum target, GLuint framebuffer);
+  // unit as GL_TEXTUREi
+  void active_texture(GLenum unit);
+  // binds to active unit
+  void bind_texture(GLenum target, GLuint texture);
+
+  void enable(GLenum capability);
+  void disable(GLenum capability);
+  void blend_func(GLenum source, GLenum destination);
+  void depth_func(GLenum function);
+  void depth_mask(GLboolean mask);
+  void viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+
+  // deletion resets bindings of the objects, so recycled names are not filtered
+  void delete_program(GLuint program);
+  void delete_vertex_arrays(GLsizei count, GLuint const* vertex_arrays);
+  void delete_buffers(GLsizei count, GLuint const* buffers);
+  void delete_textures(GLsizei count, GLuint const* textures);
+}
+
+#endif
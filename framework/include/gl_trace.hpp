@@ -0,0 +1,70 @@
+#ifndef GL_TRACE_HPP
+#define GL_TRACE_HPP
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+// binary capture of all OpenGL calls and offline replay without the application
+// traces store host byte order and pointer size, they are not portable between platforms
+namespace gl_trace {
+  // written at start of file, frame count is filled in when the trace is stopped
+  struct header {
+    char magic[4];
+    std::uint32_t version;
+    // size of glbinding function list, index of each call refers to it
+    std::uint32_t function_count;
+    std::uint32_t pointer_size;
+    std::uint32_t frame_count;
+  };
+
+  // start recording calls of the current context, uses the glbinding record callback
+  void start(std::string const& path);
+  // write remaining calls and close file
+  void stop();
+  // true between start and stop
+  bool active();
+  // mark end of frame, call after buffer swap
+  void frame();
+
+  // statistics of a replay
+  struct replay_stats {
+    std::uint64_t calls;
+    std::uint64_t payload_bytes;
+    // generated object names differing from the capture
+    std::uint64_t name_mismatches;
+  };
+
+  // executes a trace in the current context, frame by frame
+  class player {
+   public:
+    // load complete trace into memory, throws if file is not a valid trace
+    player(std::string const& path);
+
+    // number of frame markers in trace
+    unsigned frames() const;
+    // execute calls until next frame marker, returns false at end of trace
+    bool play_frame();
+    replay_stats const& stats() const;
+
+   private:
+    // execute one call record, advances read position
+    void play_call();
+    // copy captured content of mapped buffer, advances read position
+    void play_buffer_data();
+
+    std::vector<unsigned char> m_data;
+    std::size_t m_position;
+    unsigned m_frames;
+    replay_stats m_stats;
+    // reused storage for patched arguments and call outputs
+    std::vector<unsigned char> m_arguments;
+    std::vector<unsigned char> m_scratch;
+    std::vector<char const*> m_strings;
+    // sync objects of capture to sync objects of replay
+    std::map<std::uint64_t, void*> m_syncs;
+  };
+}
+
+#endif
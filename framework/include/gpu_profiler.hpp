@@ -0,0 +1,55 @@
+#ifndef GPU_PROFILER_HPP
+#define GPU_PROFILER_HPP
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+// measures gpu time of named render passes with timestamp queries
+// results are read back frames later, so the pipeline is never stalled
+namespace gpu_profiler {
+  // number of frames a scope has queries in flight
+  static const unsigned FRAMES_IN_FLIGHT = 3;
+  // number of frames the rolling statistics cover
+  static const unsigned HISTORY_LENGTH = 64;
+
+  // timing of a named scope over the last frames
+  struct result {
+    std::string name;
+    double average_ms;
+    double max_ms;
+    // number of frames in rolling window
+    unsigned samples;
+  };
+
+  // activate profiling, requires a current context
+  void initialize();
+  // free query objects, before context is destroyed
+  void release();
+  // true if initialized
+  bool active();
+
+  // start timing of named scope, scopes may be nested
+  void begin(std::string const& name);
+  // stop timing of last begun scope
+  void end();
+  // collect finished queries and advance to next frame, call after buffer swap
+  void frame();
+
+  // statistics of all scopes in order of first use
+  std::vector<result> results();
+  // print statistics of all scopes
+  void print(std::ostream& os);
+
+  // times gpu commands issued during its lifetime
+  struct scope {
+    scope(std::string const& name) {
+      begin(name);
+    }
+    ~scope() {
+      end();
+    }
+  };
+}
+
+#endif
@@ -0,0 +1,69 @@
+#ifndef INSTANCE_BATCH_HPP
+#define INSTANCE_BATCH_HPP
+
+#include "structs.hpp"
+
+#include <glm/mat3x3.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+
+#include <vector>
+
+// per-instance attributes of one drawn body
+struct body_instance {
+  glm::fmat4 model_matrix;
+  // view space normal transformation
+  glm::fmat3 normal_matrix;
+  glm::fvec3 color;
+  // shader control flags
+  GLint flags;
+  // texture array layers of diffuse and normal map
+  GLint layer;
+  GLint normal_layer;
+};
+
+// collects bodies sharing one model during a frame and draws them instanced
+// instances are grouped by textures and level of detail, each group is one draw call
+class instance_batch {
+ public:
+  // attribute locations follow model::VERTEX_ATTRIBS
+  // model matrix 5-8, normal matrix 9-11, color 12, flags 13, layer 14, normal layer 15
+  static GLuint const FIRST_LOCATION = 5;
+
+  instance_batch();
+  instance_batch(instance_batch const&) = delete;
+  instance_batch& operator=(instance_batch const&) = delete;
+  // requires the context to still exist
+  ~instance_batch();
+
+  // queue instance, textures are bound to unit 0 and 1, normal map is skipped if it has no handle
+  // lod indexes model_object::lods, clamped to the coarsest level
+  void add(body_instance const& instance, texture_object const& diffuse, texture_object const& normal = texture_object{},
+           std::size_t lod = 0);
+  void clear();
+  std::size_t size() const;
+
+  // upload queued instances and draw them with the bound program into the vertex array of object
+  // returns number of draw calls, queue is cleared
+  std::size_t draw(model_object const& object);
+
+ private:
+  struct entry {
+    texture_object diffuse;
+    texture_object normal;
+    std::size_t lod;
+    std::size_t instance;
+  };
+
+  // point instance attributes of bound vertex array to instance first
+  void set_attribute_pointers(std::size_t first) const;
+
+  GLuint m_buffer;
+  std::size_t m_capacity;
+  std::vector<body_instance> m_instances;
+  std::vector<entry> m_entries;
+  // instances in draw order for upload
+  std::vector<body_instance> m_sorted;
+};
+
+#endif
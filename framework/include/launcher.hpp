@@ -2,13 +2,38 @@
 #define LAUNCHER_HPP
 
 #include "application.hpp"
+#include "benchmark.hpp"
+#include "gl_errors.hpp"
 
+#include <memory>
 #include <string>
 
 // forward declarations
 class Application;
 class GLFWwindow;
 
+// settings given on the command line
+struct launch_options {
+  // path to the resource folders
+  std::string resource_path{};
+  // render to invisible window
+  bool headless = false;
+  // number of frames to measure, 0 runs until window is closed
+  unsigned frames = 0;
+  // number of frames rendered before measuring
+  unsigned warmup = 0;
+  // file to write frame times to, empty for no report
+  std::string report_path{};
+  // measure gpu time of render passes
+  bool profile = false;
+  // overhead of OpenGL error checking
+  gl_errors::tier error_check = gl_errors::default_tier();
+  // file to capture OpenGL calls to, empty for no trace
+  std::string trace_path{};
+  // filter redundant state changes through gl_state
+  bool state_cache = false;
+};
+
 class Launcher {
  public:
   template<typename T>
@@ -45,6 +70,8 @@ class Launcher {
 
   // calculate fps and show in window title
   void show_fps();
+  // print and write results of benchmark run
+  void report_benchmark();
   // free resources
   void quit(int status);
 
@@ -61,8 +88,12 @@ class Launcher {
   double m_last_second_time;
   unsigned m_frames_per_second;
 
+  // settings from command line
+  launch_options m_options;
   // path to the resource folders
   std::string m_resource_path;
+  // frame time recording, only exists in benchmark runs
+  std::unique_ptr<Benchmark> m_benchmark;
 
   Application* m_application;
 };
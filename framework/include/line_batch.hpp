@@ -0,0 +1,92 @@
+#ifndef LINE_BATCH_HPP
+#define LINE_BATCH_HPP
+
+#include <glbinding/gl/types.h>
+// use gl definitions from glbinding
+using namespace gl;
+
+#include "frame_ring.hpp"
+
+#include <glm/gtc/type_precision.hpp>
+
+#include <memory>
+#include <vector>
+
+// interleaved vertex of a streamed line or point
+struct line_vertex {
+  // world space
+  glm::fvec3 position;
+  // normalized to [0, 1] in shader
+  glm::u8vec4 color;
+};
+
+// per-instance attributes of a circle
+struct circle_instance {
+  // places the unit circle in the xz-plane
+  glm::fmat4 transform;
+  glm::u8vec4 color;
+};
+
+// collects lines, points and circles drawn during a frame
+// lines and points are streamed in world space and drawn with one call each,
+// circles are instances of shared unit circles with one call per level of detail
+// streamed vertices and circle instances are uploaded to a vertex ring
+class line_batch {
+ public:
+  // attribute locations of position and color, transform occupies 2-5
+  // lines and points get the identity as transform
+  static GLuint const POSITION_LOCATION = 0;
+  static GLuint const COLOR_LOCATION = 1;
+  static GLuint const TRANSFORM_LOCATION = 2;
+  // segment counts of circle levels are powers of two in this range
+  static unsigned const MIN_SEGMENTS = 8;
+  static unsigned const MAX_SEGMENTS = 256;
+
+  line_batch();
+  line_batch(line_batch const&) = delete;
+  line_batch& operator=(line_batch const&) = delete;
+  // requires the context to still exist
+  ~line_batch();
+
+  // segments needed by a circle of radius in pixels to stay within tolerance pixels of the true circle
+  static unsigned segments(float radius_pixels, float tolerance = 0.5f);
+
+  void add_line(glm::fvec3 const& a, glm::fvec3 const& b, glm::fvec4 const& color);
+  // connected points, e.g. a trajectory, closed connects last and first point
+  void add_strip(glm::fvec3 const* points, std::size_t num, glm::fvec4 const& color, bool closed = false);
+  // red, green and blue lines along the x, y and z axis of transform
+  void add_axes(glm::fmat4 const& transform, float length = 1.0f);
+  void add_point(glm::fvec3 const& position, glm::fvec4 const& color);
+  // unit circle around the origin in the xz-plane, segments are rounded up to the next level
+  void add_circle(glm::fmat4 const& transform, glm::fvec4 const& color, unsigned segments = MAX_SEGMENTS);
+  void clear();
+  // number of queued lines, points and circles
+  std::size_t size() const;
+
+  // upload queued primitives and draw them with the bound program
+  // returns number of draw calls, queue is cleared
+  std::size_t draw();
+
+ private:
+  // create vertex arrays and the static circle buffer
+  void initialize();
+  // point instance attributes of circle vertex array to the instance at byte offset of the bound buffer
+  void set_attribute_pointers(GLintptr offset) const;
+  // point vertex attributes of stream vertex array to the vertex at byte offset of the bound buffer
+  void set_stream_pointers(GLintptr offset) const;
+
+  GLuint m_stream_array;
+  GLuint m_circle_array;
+  GLuint m_circle_buffer;
+  // instances, lines and points of the frames in flight, grows when they no longer fit
+  std::unique_ptr<frame_ring> m_ring;
+  // pairs of line ends
+  std::vector<line_vertex> m_lines;
+  std::vector<line_vertex> m_points;
+  // circles bucketed by level, level i has MIN_SEGMENTS << i segments
+  std::vector<std::vector<circle_instance>> m_circles;
+  // circles in draw order for upload
+  std::vector<circle_instance> m_sorted;
+};
+
+#endif
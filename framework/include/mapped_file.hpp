@@ -0,0 +1,32 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <string>
+
+// read-only memory mapping of a complete file
+class mapped_file {
+ public:
+  mapped_file();
+  // maps file, check success with valid()
+  explicit mapped_file(std::string const& path);
+  mapped_file(mapped_file&& other);
+  mapped_file& operator=(mapped_file&& other);
+  mapped_file(mapped_file const&) = delete;
+  mapped_file& operator=(mapped_file const&) = delete;
+  ~mapped_file();
+
+  // true if file could be mapped, empty files are valid
+  bool valid() const;
+  unsigned char const* data() const;
+  std::size_t size() const;
+
+ private:
+  void unmap();
+
+  unsigned char const* m_data;
+  std::size_t m_size;
+  bool m_valid;
+};
+
+#endif
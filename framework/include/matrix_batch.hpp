@@ -0,0 +1,37 @@
+#ifndef MATRIX_BATCH_HPP
+#define MATRIX_BATCH_HPP
+
+#include <glm/mat3x3.hpp>
+#include <glm/mat4x4.hpp>
+
+#include <cstddef>
+
+// transformations of arrays of matrices, with SSE where available
+// affine matrices have a last row of (0, 0, 0, 1)
+// outputs may not overlap inputs unless stated otherwise
+namespace matrix_batch {
+  // translation, rotation and scale of objects as separate component arrays
+  struct trs_arrays {
+    float const* translation[3];
+    // unit quaternions, x y z w
+    float const* rotation[4];
+    float const* scale[3];
+  };
+
+  // out[i] = a * b[i], out may be b
+  void multiply(glm::fmat4 const& a, glm::fmat4 const* b, glm::fmat4* out, std::size_t count);
+  // out[i] = a[i] * b[i], out may be a or b
+  void multiply(glm::fmat4 const* a, glm::fmat4 const* b, glm::fmat4* out, std::size_t count);
+
+  // inverse of affine matrices
+  void affine_inverse(glm::fmat4 const* in, glm::fmat4* out, std::size_t count);
+  glm::fmat4 affine_inverse(glm::fmat4 const& matrix);
+
+  // inverse transpose of the upper 3x3 block, transforms normals
+  void normal_matrices(glm::fmat4 const* in, glm::fmat3* out, std::size_t count);
+
+  // out[i] = translate * rotate * scale
+  void compose(trs_arrays const& trs, glm::fmat4* out, std::size_t count);
+}
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef MESH_ATTRIBUTES_HPP
+#define MESH_ATTRIBUTES_HPP
+
+#include <vector>
+
+// generation of vertex attributes for indexed triangle meshes
+// triangles are processed on all cores with SSE, accumulation per vertex is race-free
+namespace mesh_attributes {
+  // contribution of adjacent triangles to a vertex normal
+  enum class weighting {
+    // face normal scaled by triangle area
+    area,
+    // normalized face normal scaled by the triangle angle at the vertex
+    angle
+  };
+
+  // normalized vertex normals, interleaved xyz like the positions
+  std::vector<float> normals(std::vector<float> const& positions,
+                             std::vector<unsigned> const& indices,
+                             weighting weights = weighting::area);
+
+  // normalized tangents in direction of increasing u, orthogonal to the normals
+  // triangles with degenerate texture coordinates are ignored
+  std::vector<float> tangents(std::vector<float> const& positions,
+                              std::vector<float> const& normals,
+                              std::vector<float> const& texcoords,
+                              std::vector<unsigned> const& indices);
+}
+
+#endif
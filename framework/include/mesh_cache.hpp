@@ -0,0 +1,69 @@
+#ifndef MESH_CACHE_HPP
+#define MESH_CACHE_HPP
+
+#include "model.hpp"
+#include "mapped_file.hpp"
+
+#include <cstdint>
+#include <string>
+
+// binary files holding the final interleaved buffers of an imported model
+// mapped into memory on load, so buffers can be uploaded without parsing
+namespace mesh_cache {
+  // increase when layout of file or content of buffers changes
+  static const std::uint32_t VERSION = 2;
+
+  // start of cache file, vertex data follows, index data starts at next 16 byte boundary
+  struct header {
+    char magic[4];
+    std::uint32_t version;
+    // hash of source file content
+    std::uint64_t source_hash;
+    // requested and actually contained attributes
+    std::int32_t import_attribs;
+    std::int32_t attributes;
+    std::uint64_t vertex_num;
+    std::uint64_t data_size;
+    std::uint64_t index_num;
+  };
+
+  // buffers of a model, either mapped from cache file or owned
+  class cached_model {
+   public:
+    // takes ownership of imported model
+    cached_model(model&& imported);
+    // maps file, check validity with valid()
+    cached_model(std::string const& cache_path);
+    cached_model(cached_model&& other);
+    cached_model(cached_model const&) = delete;
+    cached_model& operator=(cached_model const&) = delete;
+
+    // true if buffers are available
+    bool valid() const;
+    header const& file_header() const;
+
+    // interleaved vertex attributes
+    GLfloat const* data;
+    // number of floats in data
+    std::size_t data_size;
+    GLuint const* indices;
+    std::size_t index_num;
+    // contained attributes, byte offsets and vertex size
+    model layout;
+
+   private:
+    // owns buffers if not mapped
+    model m_imported;
+    header m_header;
+    mapped_file m_file;
+  };
+
+  // FNV-1a hash of file content
+  std::uint64_t hash_file(std::string const& path);
+  // file next to source, one per attribute combination and triangle order
+  std::string cache_path(std::string const& source_path, model::attrib_flag_t import_attribs, bool optimized = false);
+  // write buffers of imported model, returns false if file could not be written
+  bool store(std::string const& cache_path, std::uint64_t source_hash, model::attrib_flag_t import_attribs, model const& imported);
+}
+
+#endif
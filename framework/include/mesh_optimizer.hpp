@@ -0,0 +1,48 @@
+#ifndef MESH_OPTIMIZER_HPP
+#define MESH_OPTIMIZER_HPP
+
+#include "model.hpp"
+
+#include <ostream>
+#include <vector>
+
+// reordering of triangles and vertices for the gpu vertex pipeline
+// triangles are ordered with Tipsify for post-transform cache hits,
+// the resulting clusters by occlusion potential against overdraw,
+// and vertices by first use for linear fetches
+namespace mesh_optimizer {
+  // entries of the simulated FIFO post-transform cache
+  static const unsigned CACHE_SIZE = 16;
+
+  // vertex shader invocations of a simulated FIFO cache
+  struct cache_stats {
+    // average cache miss ratio, transformed vertices per triangle
+    double acmr;
+    // average transformed vertex ratio, transformed vertices per referenced vertex
+    double atvr;
+  };
+
+  struct report {
+    cache_stats before;
+    cache_stats after;
+    // number of triangle clusters ordered for overdraw
+    std::size_t clusters;
+  };
+
+  cache_stats analyze(std::vector<GLuint> const& indices, std::size_t vertex_num, unsigned cache_size = CACHE_SIZE);
+
+  // Tipsify triangle order, returns index of first triangle of each cluster
+  std::vector<std::size_t> reorder_triangles(std::vector<GLuint>& indices, std::size_t vertex_num, unsigned cache_size = CACHE_SIZE);
+  // sort clusters so outward facing ones are drawn first, positions are the first attribute of vertices
+  void reorder_clusters(std::vector<GLuint>& indices, std::vector<std::size_t> const& clusters,
+                        GLfloat const* positions, std::size_t vertex_stride);
+  // order vertex data by first use in indices, unused vertices are moved to the end
+  void reorder_vertices(model& mesh);
+
+  // run all passes on model
+  report optimize(model& mesh, unsigned cache_size = CACHE_SIZE);
+
+  std::ostream& operator<<(std::ostream& os, report const& result);
+}
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef MESH_SIMPLIFIER_HPP
+#define MESH_SIMPLIFIER_HPP
+
+#include "model.hpp"
+#include "structs.hpp"
+
+#include <vector>
+
+// quadric error metric simplification into levels of detail
+// levels reference the vertices of the source, so they share one vertex buffer
+namespace mesh_simplifier {
+  // levels concatenated in one index buffer, finest first
+  struct lod_chain {
+    std::vector<GLuint> indices;
+    std::vector<lod_range> levels;
+  };
+
+  // collapse edges until at most target_triangles remain
+  // seam and border vertices are kept so textures and outlines stay intact
+  // returns indices of remaining triangles, error receives the largest deviation
+  std::vector<GLuint> simplify(GLfloat const* data, model const& layout, GLuint const* indices, std::size_t index_num,
+                               std::size_t target_triangles, float* error = nullptr);
+
+  // level for each descending ratio of source triangles, stops early when the mesh can not be reduced further
+  // simplified levels are ordered for vertex cache and overdraw
+  lod_chain build_lods(GLfloat const* data, model const& layout, GLuint const* indices, std::size_t index_num,
+                       std::vector<float> const& ratios = std::vector<float>{1.0f, 0.5f, 0.25f, 0.1f});
+
+  // coarsest level whose error projected with pixels_per_unit stays below threshold pixels
+  // coarser levels are only chosen when their error is below threshold * (1 - hysteresis)
+  std::size_t select_level(std::vector<lod_range> const& levels, float pixels_per_unit, std::size_t current,
+                           float threshold = 1.0f, float hysteresis = 0.25f);
+}
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef MIP_CHAIN_HPP
+#define MIP_CHAIN_HPP
+
+#include "pixel_data.hpp"
+
+#include <vector>
+
+// mip levels of 8 bit images computed on the cpu
+// every level is half the size of the previous one rounded down, so any size reaches 1x1
+// odd sizes use a three tap box filter, every source texel keeps the same weight
+namespace mip_chain {
+  // number of levels from width x height down to 1x1
+  std::size_t level_num(std::size_t width, std::size_t height);
+
+  // next smaller level, rows are filtered in parallel
+  // with srgb set color channels are averaged in linear light, alpha is always averaged directly
+  // images holding data such as normals should be filtered without srgb
+  pixel_data next_level(pixel_data const& image, bool srgb = true);
+  // image followed by all smaller levels
+  std::vector<pixel_data> build(pixel_data const& image, bool srgb = true);
+}
+
+#endif
@@ -16,11 +16,13 @@ struct model {
   // type holding info about a vertex/model attribute
   struct attribute {
 
-    attribute(attrib_flag_t f, GLsizei s, GLsizei c, GLenum t)
+    attribute(attrib_flag_t f, GLsizei s, GLsizei c, GLenum t, bool n = false)
      :flag{f}
      ,size{s}
      ,components{c}
      ,type{t}
+     ,normalized{n}
+     ,offset{nullptr}
     {}
 
     // conversion to flag type for use as enum
@@ -30,12 +32,14 @@ struct model {
 
     // ugly enum to use as flag, must be unique power of two
     attrib_flag_t flag;
-    // size in bytes
+    // size in bytes, packed types store all components in one word
     GLsizei size;
     // number of scalar components
     GLint components;
     // Gl type
     GLenum type;
+    // integer values are mapped to [-1, 1] or [0, 1]
+    bool normalized;
     // offset from element beginning
     GLvoid* offset;
   };
@@ -50,12 +54,23 @@ struct model {
   static attribute const& BITANGENT;
   // is not a vertex attribute, so not stored in VERTEX_ATTRIBS
   static attribute const  INDEX;
+
+  // compact formats for quantized buffers, with flags of the float attributes
+  // position has a fourth component so vertices stay 4 byte aligned
+  static attribute const  POSITION_HALF;
+  static attribute const  TEXCOORD_HALF;
+  static attribute const  NORMAL_PACKED;
+  static attribute const  TANGENT_PACKED;
+  static attribute const  BITANGENT_PACKED;
+  static attribute const  INDEX_SHORT;
   
   model();
   model(std::vector<GLfloat> const& databuff, attrib_flag_t attribs, std::vector<GLuint> const& trianglebuff = std::vector<GLuint>{});
 
   std::vector<GLfloat> data;
   std::vector<GLuint> indices;
+  // contained attributes
+  attrib_flag_t attributes;
   // byte offsets of individual element attributes
   std::map<attrib_flag_t, GLvoid*> offsets;
   // size of one vertex element in bytes
@@ -2,12 +2,17 @@
 #define MODEL_LOADER_HPP
 
 #include "model.hpp"
+#include "mesh_cache.hpp"
 
 #include "tiny_obj_loader.h"
 
 namespace model_loader {
 
-model obj(std::string const& path, model::attrib_flag_t import_attribs = model::POSITION);
+// optimize reorders triangles and vertices for the vertex cache and overdraw, see mesh_optimizer
+model obj(std::string const& path, model::attrib_flag_t import_attribs = model::POSITION, bool optimize = false);
+
+// load obj from binary cache next to the file, imports and writes cache if missing or outdated
+mesh_cache::cached_model cached_obj(std::string const& path, model::attrib_flag_t import_attribs = model::POSITION, bool optimize = false);
 
 }
 
@@ -0,0 +1,20 @@
+#ifndef OBJ_PARSER_HPP
+#define OBJ_PARSER_HPP
+
+#include "tiny_obj_loader.h"
+
+#include <string>
+#include <vector>
+
+// multithreaded obj parser producing the same shapes as tinyobj::LoadObj
+// file is memory-mapped and parsed in chunks of lines on all cores
+namespace obj_parser {
+  // parse file into shapes, materials are read with tinyobj
+  // returns error string like tinyobj::LoadObj, empty on success
+  std::string load(std::vector<tinyobj::shape_t>& shapes,
+                   std::vector<tinyobj::material_t>& materials,
+                   std::string const& path,
+                   std::string const& mtl_basepath = "");
+}
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+
+// distribution of independent work items over all cores
+// all work runs on one pool of threads started on first use, so nested calls do not multiply threads
+namespace parallel {
+  // number of threads used, at least one
+  unsigned thread_count();
+
+  // calls function(index) for every index in [0, count), blocks until all returned
+  // the calling thread takes items as well, calls from pool threads run all items on the calling thread
+  // first exception thrown by a call is rethrown
+  void for_each(std::size_t count, std::function<void(std::size_t)> const& function);
+
+  // calls function(index) for every index in [0, count) on the pool without blocking
+  // function must not throw, errors should be passed on with its results
+  class batch {
+   public:
+    batch(std::size_t count, std::function<void(std::size_t)> const& function);
+    batch(batch const&) = delete;
+    batch& operator=(batch const&) = delete;
+    // waits for running calls, calls not started yet are skipped
+    ~batch();
+
+    std::size_t size() const;
+    // index of a call finished since the last call, blocks until one is
+    // returns size() once every index was returned
+    std::size_t next_finished();
+
+   private:
+    struct state;
+    std::shared_ptr<state> m_state;
+    std::size_t m_returned;
+  };
+}
+
+#endif
@@ -3,6 +3,7 @@
 
 #include <vector>
 #include <cstdint>
+#include <stdexcept>
 
 // #include <glbinding/gl/types.h>
 #include <glbinding/gl/enum.h>
@@ -44,4 +45,13 @@ struct pixel_data {
   GLenum channel_type; 
 };
 
+// number of channels of a channel format, throws std::invalid_argument for other formats
+inline std::size_t channel_count(GLenum channels) {
+  if (channels == GL_RED) return 1;
+  if (channels == GL_RG) return 2;
+  if (channels == GL_RGB) return 3;
+  if (channels == GL_RGBA) return 4;
+  throw std::invalid_argument("Unsupported channel format");
+}
+
 #endif
\ No newline at end of file
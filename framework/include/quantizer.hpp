@@ -0,0 +1,54 @@
+#ifndef QUANTIZER_HPP
+#define QUANTIZER_HPP
+
+#include "model.hpp"
+#include "mesh_cache.hpp"
+
+#include <map>
+#include <ostream>
+#include <vector>
+
+// conversion of float vertex buffers to compact formats for upload
+// half float positions and texcoords, 10 bit normalized directions and 16 bit indices
+namespace quantizer {
+  // largest accepted error of a quantized attribute, otherwise it stays float
+  struct error_bounds {
+    // relative to largest extent of the bounding box
+    float position = 1.0f / 1024.0f;
+    // absolute, in texture space
+    float texcoord = 1.0f / 1024.0f;
+    // absolute, per component of normals, tangents and bitangents
+    float direction = 1.0f / 256.0f;
+  };
+
+  // buffers ready for upload
+  struct packed_model {
+    std::vector<unsigned char> data;
+    std::vector<unsigned char> indices;
+    // contained attributes in chosen formats with byte offsets, in order of model::VERTEX_ATTRIBS
+    std::vector<model::attribute> attributes;
+    // INDEX or INDEX_SHORT
+    model::attribute index = model::INDEX;
+    GLsizei vertex_bytes = 0;
+    std::size_t vertex_num = 0;
+    std::size_t index_num = 0;
+    // size of float vertex for comparison
+    GLsizei float_vertex_bytes = 0;
+    // largest error of each attribute
+    std::map<model::attrib_flag_t, float> errors;
+  };
+
+  // convert interleaved float vertices with layout of given model
+  packed_model pack(GLfloat const* data, model const& layout, GLuint const* indices, std::size_t index_num,
+                    error_bounds const& bounds = error_bounds{});
+  packed_model pack(model const& source, error_bounds const& bounds = error_bounds{});
+  packed_model pack(mesh_cache::cached_model const& source, error_bounds const& bounds = error_bounds{});
+
+  // enable and set pointers of the bound vertex array object for the bound array buffer
+  // attribute location is the position in model::VERTEX_ATTRIBS
+  void set_attribute_pointers(packed_model const& packed);
+
+  std::ostream& operator<<(std::ostream& os, packed_model const& packed);
+}
+
+#endif
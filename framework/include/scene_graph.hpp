@@ -0,0 +1,54 @@
+#ifndef SCENE_GRAPH_HPP
+#define SCENE_GRAPH_HPP
+
+#include <glm/mat4x4.hpp>
+
+#include <cstdint>
+#include <vector>
+
+// transform hierarchy stored as arrays indexed by node
+// nodes can only be attached to existing nodes, so parents always precede their
+// children and world matrices are propagated front to back in one pass
+// only nodes changed since the last update and their descendants are recomputed
+class scene_graph {
+ public:
+  // parent of top level nodes
+  static std::size_t const NO_PARENT = std::size_t(-1);
+
+  scene_graph();
+
+  // append node, returns its index
+  std::size_t add(std::size_t parent = NO_PARENT, glm::fmat4 const& local = glm::fmat4{});
+  // remove all nodes
+  void clear();
+  // reserve storage for number of nodes
+  void reserve(std::size_t nodes);
+  std::size_t size() const;
+
+  std::size_t parent(std::size_t node) const;
+  glm::fmat4 const& local(std::size_t node) const;
+  // change transform relative to parent, marks node and descendants for update
+  void set_local(std::size_t node, glm::fmat4 const& local);
+
+  // recompute world matrices of changed nodes and descendants
+  // returns number of recomputed matrices
+  std::size_t update();
+
+  // world matrix as of the last update
+  glm::fmat4 const& world(std::size_t node) const;
+  // world matrices of all nodes in node order
+  glm::fmat4 const* world_matrices() const;
+  // copy world matrices of nodes to out, resized to the number of nodes
+  void gather(std::vector<std::size_t> const& nodes, std::vector<glm::fmat4>& out) const;
+
+ private:
+  std::vector<std::size_t> m_parents;
+  std::vector<glm::fmat4> m_locals;
+  std::vector<glm::fmat4> m_worlds;
+  // set if local changed, or during update if world changed
+  std::vector<std::uint8_t> m_dirty;
+  // no node before is dirty
+  std::size_t m_first_dirty;
+};
+
+#endif
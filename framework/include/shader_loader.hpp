@@ -6,6 +6,8 @@ using namespace gl;
 
 #include <string>
 
+struct shader_program;
+
 namespace shader_loader {
   // compile shader
   unsigned shader(std::string const& file_path, GLenum shader_type);
@@ -13,6 +15,8 @@ namespace shader_loader {
   unsigned program(std::string const& vertex_name, std::string const& fragment_name);
   // create program from vertex, geometry and fragment shader
   unsigned program(std::string const& vertex_path, std::string const& geometry_path, std::string const& fragment_path);
+  // query active uniforms and uniform blocks of linked program and advance its generation
+  void reflect(shader_program& program);
 };
 
 #endif
@@ -0,0 +1,79 @@
+#ifndef STAR_CATALOG_HPP
+#define STAR_CATALOG_HPP
+
+#include "culling.hpp"
+#include "structs.hpp"
+
+#include <glbinding/gl/types.h>
+// use gl definitions from glbinding
+using namespace gl;
+
+#include <glm/gtc/type_precision.hpp>
+
+#include <cstdint>
+#include <vector>
+
+// interleaved vertex of a star
+struct star_vertex {
+  glm::fvec3 position;
+  // apparent magnitude, smaller is brighter
+  float magnitude;
+  // normalized to [0, 1] in shader
+  glm::u8vec4 color;
+};
+
+// procedural stars on a sphere around the origin, generated in parallel
+// stars are grouped into cells of a cube projected onto the sphere and sorted by brightness within a cell,
+// so cells outside the view are skipped and only stars brighter than a limit are submitted
+class star_catalog {
+ public:
+  // attribute locations of position, magnitude and color
+  static GLuint const POSITION_LOCATION = 0;
+  static GLuint const MAGNITUDE_LOCATION = 1;
+  static GLuint const COLOR_LOCATION = 2;
+
+  // magnitudes follow the star counts of the sky, the brightest star is expected at magnitude 0
+  // each cube face is divided into resolution * resolution cells
+  star_catalog(std::size_t count, float radius, std::uint64_t seed = 1, unsigned resolution = 16);
+  star_catalog(star_catalog const&) = delete;
+  star_catalog& operator=(star_catalog const&) = delete;
+  // requires the context to still exist
+  ~star_catalog();
+
+  std::size_t size() const;
+  // magnitude of faintest stars, a limit above it draws all stars
+  float faintest() const;
+  // number of stars with magnitude up to limit
+  std::size_t brighter(float limit) const;
+
+  // draw stars of cells in volume up to magnitude limit with the bound program
+  // returns number of draw calls, all visible cells are drawn with one call
+  std::size_t draw(culling::frustum const& volume, float limit);
+  // number of stars submitted by last draw
+  std::size_t last_drawn() const;
+
+ private:
+  struct cell {
+    GLint first;
+    GLsizei count;
+  };
+
+  // upload stars and create vertex array
+  void upload(std::vector<star_vertex> const& stars);
+
+  GLuint m_vertex_array;
+  GLuint m_buffer;
+  float m_faintest;
+  // non-empty cells, with the bounds of their stars
+  std::vector<cell> m_cells;
+  std::vector<bounding_sphere> m_bounds;
+  // magnitudes in vertex order, ascending within each cell
+  std::vector<float> m_magnitudes;
+  std::size_t m_last_drawn;
+  // ranges of the current draw
+  std::vector<std::size_t> m_visible;
+  std::vector<GLint> m_firsts;
+  std::vector<GLsizei> m_counts;
+};
+
+#endif
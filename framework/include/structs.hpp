@@ -2,10 +2,29 @@
 #define STRUCTS_HPP
 
 #include <map>
+#include <string>
+#include <vector>
 #include <glbinding/gl/gl.h>
 // use gl definitions from glbinding 
 using namespace gl;
 
+#include <glm/gtc/type_precision.hpp>
+
+// indices of one detail level in a shared element buffer
+struct lod_range {
+  // first index of level
+  GLsizei first;
+  GLsizei num_elements;
+  // largest geometric deviation from full detail, in model units
+  float error;
+};
+
+// sphere enclosing a drawable
+struct bounding_sphere {
+  glm::fvec3 center;
+  float radius;
+};
+
 // gpu representation of model
 struct model_object {
   // vertex array object
@@ -18,6 +37,12 @@ struct model_object {
   GLenum draw_mode = GL_NONE;
   // indices number, if EBO exists
   GLsizei num_elements = 0;
+  // type of indices
+  GLenum index_type = GL_UNSIGNED_INT;
+  // detail levels in element buffer, finest first
+  std::vector<lod_range> lods{};
+  // bounds of vertices in model space
+  bounding_sphere bounds{};
 };
 
 // gpu representation of texture
@@ -28,6 +53,25 @@ struct texture_object {
   GLenum target = GL_NONE;
 };
 
+// active uniform of a linked program
+struct uniform_info {
+  // array uniforms without [0] suffix
+  std::string name;
+  GLint location;
+  // GL type, e.g. GL_FLOAT_MAT4 or GL_SAMPLER_2D
+  GLenum type;
+  // number of array elements, 1 for non-arrays
+  GLint size;
+};
+
+// active uniform block of a linked program
+struct uniform_block_info {
+  std::string name;
+  GLuint index;
+  // minimum buffer size in bytes
+  GLint data_size;
+};
+
 // shader handle and uniform storage
 struct shader_program {
   shader_program(std::string const& vertex, std::string const& fragment)
@@ -43,5 +87,10 @@ struct shader_program {
   GLuint handle;
   // uniform locations mapped to name
   std::map<std::string, GLint> u_locs{};
+  // all active uniforms and blocks, filled by shader_loader::reflect
+  std::vector<uniform_info> uniforms{};
+  std::vector<uniform_block_info> uniform_blocks{};
+  // incremented with every reflected link, outdates cached locations
+  unsigned generation = 0;
 };
 #endif
\ No newline at end of file
@@ -0,0 +1,80 @@
+#ifndef TEXT_BATCH_HPP
+#define TEXT_BATCH_HPP
+
+#include <glbinding/gl/types.h>
+// use gl definitions from glbinding
+using namespace gl;
+
+#include "frame_ring.hpp"
+
+#include <glm/gtc/type_precision.hpp>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// interleaved vertex of a glyph quad
+struct glyph_vertex {
+  // normalized device coordinates
+  glm::fvec2 position;
+  // normalized to [0, 1] in shader
+  glm::u8vec4 color;
+  glm::fvec2 tex_coord;
+};
+
+// collects text drawn during a frame and draws all of it with one call
+// glyphs come from a 16 * 16 letter texture in ASCII order, positions and sizes are
+// given in (0, 0) to (800, 600) screen space
+// quads of strings drawn unchanged in consecutive frames are reused instead of regenerated
+class text_batch {
+ public:
+  // attribute locations of position, color and texture coordinates
+  static GLuint const POSITION_LOCATION = 0;
+  static GLuint const COLOR_LOCATION = 1;
+  static GLuint const TEX_COORD_LOCATION = 2;
+
+  text_batch();
+  text_batch(text_batch const&) = delete;
+  text_batch& operator=(text_batch const&) = delete;
+  // requires the context to still exist
+  ~text_batch();
+
+  // queue text with lower left corner at x, y and letters of size * size
+  void add(float x, float y, float size, std::string const& text, glm::fvec4 const& color);
+  void clear();
+  // number of queued glyphs
+  std::size_t size() const;
+
+  // upload queued glyphs to the vertex ring and draw them with the bound program, font texture and blending
+  // returns number of draw calls, queue is cleared and unused strings are dropped from the cache
+  std::size_t draw();
+
+ private:
+  struct cache_key {
+    std::string text;
+    float x;
+    float y;
+    float size;
+    glm::u8vec4 color;
+
+    bool operator<(cache_key const& other) const;
+  };
+  struct cached_text {
+    std::vector<glyph_vertex> vertices;
+    // number of last frame the text was drawn in
+    unsigned long frame;
+  };
+
+  // create quads of text
+  static std::vector<glyph_vertex> build(cache_key const& key);
+
+  GLuint m_vertex_array;
+  // glyphs of the frames in flight, grows when text no longer fits
+  std::unique_ptr<frame_ring> m_ring;
+  unsigned long m_frame;
+  std::vector<glyph_vertex> m_vertices;
+  std::map<cache_key, cached_text> m_cache;
+};
+
+#endif
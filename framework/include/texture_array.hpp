@@ -0,0 +1,39 @@
+#ifndef TEXTURE_ARRAY_HPP
+#define TEXTURE_ARRAY_HPP
+
+#include "pixel_data.hpp"
+#include "structs.hpp"
+#include "texture_cache.hpp"
+
+#include <map>
+#include <set>
+#include <string>
+
+// location of an image in an array texture
+struct texture_layer {
+  // GL_TEXTURE_2D_ARRAY object
+  texture_object texture;
+  GLint layer = 0;
+};
+
+// packing of images into GL_TEXTURE_2D_ARRAY layers, so draws can select images without rebinding
+namespace texture_array {
+  // side lengths images are resized to, nearest power of two, halved until both fit into max_extent
+  std::pair<std::size_t, std::size_t> bucket_size(std::size_t width, std::size_t height, std::size_t max_extent);
+  // 8 bit image resized to width and height with the filter used for buckets
+  pixel_data resample(pixel_data const& image, std::size_t width, std::size_t height);
+
+  // images are grouped by channel type and bucket size, each group becomes one array texture
+  // 8 bit images with fewer channels are expanded to the most channels in their group, grey to rgb
+  // groups exceeding GL_MAX_ARRAY_TEXTURE_LAYERS are split
+  // all mip levels are uploaded, color is filtered in linear light except for data images such as normal maps
+  // returns array and layer of each image name
+  std::map<std::string, texture_layer> build(std::map<std::string, pixel_data> const& images,
+                                             std::size_t max_extent = 1024,
+                                             std::set<std::string> const& data_images = std::set<std::string>{});
+  // compressed textures are grouped by format, size and level number, all levels are uploaded
+  // sizes are kept, textures should already be resized to bucket sizes to share arrays
+  std::map<std::string, texture_layer> build(std::map<std::string, texture_cache::cached_texture> const& textures);
+}
+
+#endif
@@ -0,0 +1,90 @@
+#ifndef TEXTURE_CACHE_HPP
+#define TEXTURE_CACHE_HPP
+
+#include "pixel_data.hpp"
+#include "mapped_file.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// binary files holding the block compressed mip chain of a texture
+// mapped into memory on load, so levels are uploaded with glCompressedTexImage* without decoding
+namespace texture_cache {
+  // increase when layout of file or encoding of levels changes
+  static const std::uint32_t VERSION = 2;
+
+  // color maps are stored as BC1, normal maps keep x and y in BC5 and z is reconstructed in the shader
+  enum class usage {
+    color,
+    normal
+  };
+  GLenum format(usage content);
+
+  // start of cache file, level table follows, data of each level starts at a 16 byte boundary
+  struct header {
+    char magic[4];
+    std::uint32_t version;
+    // hash of source file content
+    std::uint64_t source_hash;
+    std::uint32_t format;
+    std::uint32_t width;
+    std::uint32_t height;
+    std::uint32_t level_num;
+  };
+
+  struct level {
+    // byte offset from start of file
+    std::uint64_t offset;
+    std::uint64_t size;
+    std::uint32_t width;
+    std::uint32_t height;
+  };
+
+  // compressed levels, either mapped from cache file or owned
+  class cached_texture {
+   public:
+    // invalid texture
+    cached_texture();
+    // maps file, check validity with valid()
+    explicit cached_texture(std::string const& cache_path);
+    // takes ownership of encoded file content
+    explicit cached_texture(std::vector<std::uint8_t>&& content);
+    cached_texture(cached_texture&& other);
+    cached_texture& operator=(cached_texture&& other);
+    cached_texture(cached_texture const&) = delete;
+    cached_texture& operator=(cached_texture const&) = delete;
+
+    // true if levels are available
+    bool valid() const;
+    header const& file_header() const;
+    GLenum format() const;
+    // levels from full size down to 1x1
+    std::size_t level_num() const;
+    level const& level_info(std::size_t index) const;
+    std::uint8_t const* level_data(std::size_t index) const;
+
+   private:
+    // checks header and level table, resets texture if content is no complete cache file
+    void read(std::uint8_t const* content, std::size_t size);
+
+    // owns content if not mapped
+    std::vector<std::uint8_t> m_content;
+    mapped_file m_file;
+    std::uint8_t const* m_data;
+    header m_header;
+    std::vector<level> m_levels;
+  };
+
+  // compresses image and its mip chain to the content of a cache file
+  std::vector<std::uint8_t> encode(std::uint64_t source_hash, usage content, pixel_data const& image);
+  // file next to source, one per usage and size limit
+  std::string cache_path(std::string const& source_path, usage content, std::size_t max_extent);
+  // write content of cache file, returns false if file could not be written
+  bool store(std::string const& cache_path, std::vector<std::uint8_t> const& content);
+
+  // true if the current context can sample all formats, RGTC is core but S3TC an extension
+  bool supported();
+}
+
+#endif
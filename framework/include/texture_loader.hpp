@@ -1,12 +1,67 @@
 #ifndef TEXTURE_LOADER_HPP
 #define TEXTURE_LOADER_HPP
 
+#include "parallel.hpp"
 #include "pixel_data.hpp"
+#include "texture_cache.hpp"
 
+#include <future>
 #include <string>
+#include <vector>
 
 namespace texture_loader {
+  // decoded with rows from bottom to top as OpenGL expects, safe to call from several threads
   pixel_data file(std::string const& file_name);
+  // block compressed mip chain of file, resized to its texture_array bucket
+  // read from the cache file next to it, which is written if missing or outdated
+  texture_cache::cached_texture compressed(std::string const& file_name, texture_cache::usage content,
+                                           std::size_t max_extent = 1024);
+
+  // decodes files on the worker pool, each image can be taken as soon as it is decoded
+  // so uploading overlaps with decoding of the remaining files
+  class decode_batch {
+   public:
+    explicit decode_batch(std::vector<std::string> const& file_names);
+
+    std::size_t size() const;
+    // index of an image decoded since the last call, blocks until one is
+    // returns size() once every index was returned
+    std::size_t next_ready();
+    // pending image of index, get() rethrows decoding errors
+    std::future<pixel_data>& image(std::size_t index);
+
+   private:
+    std::vector<std::string> m_file_names;
+    std::vector<std::promise<pixel_data>> m_promises;
+    std::vector<std::future<pixel_data>> m_images;
+    // destroyed first, waits for running decodes before the promises go
+    parallel::batch m_decodes;
+  };
+
+  // compressed mip chains of files on the worker pool, like compressed() for each file
+  // each texture can be taken as soon as it is ready, see decode_batch
+  class compress_batch {
+   public:
+    // content of each file at the same index
+    compress_batch(std::vector<std::string> const& file_names, std::vector<texture_cache::usage> const& contents,
+                   std::size_t max_extent = 1024);
+
+    std::size_t size() const;
+    // index of a texture finished since the last call, blocks until one is
+    // returns size() once every index was returned
+    std::size_t next_ready();
+    // pending texture of index, get() rethrows errors
+    std::future<texture_cache::cached_texture>& texture(std::size_t index);
+
+   private:
+    std::vector<std::string> m_file_names;
+    std::vector<texture_cache::usage> m_contents;
+    std::size_t m_max_extent;
+    std::vector<std::promise<texture_cache::cached_texture>> m_promises;
+    std::vector<std::future<texture_cache::cached_texture>> m_textures;
+    // destroyed first, waits for running compressions before the promises go
+    parallel::batch m_compressions;
+  };
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,45 @@
+#ifndef UNIFORM_HANDLE_HPP
+#define UNIFORM_HANDLE_HPP
+
+#include "structs.hpp"
+
+#include <string>
+
+// typed access to a uniform of a shader program without name lookups per use
+// the location is cached and resolved again once the program was relinked
+// supported types are GLint (also samplers and bools), GLuint, GLfloat,
+// glm::fvec2/3/4, glm::ivec2/3/4, glm::fmat3 and glm::fmat4
+template<typename T>
+class uniform_handle {
+ public:
+  uniform_handle();
+  // program must outlive the handle, it may be unlinked until first use
+  uniform_handle(shader_program const& program, std::string const& name);
+
+  // upload to bound program, inactive or mismatching uniforms are skipped
+  void set(T const& value) const;
+  // upload count array elements
+  void set(T const* values, GLsizei count) const;
+
+  // current location, -1 if uniform is inactive or has another type
+  GLint location() const {
+    if (m_program && m_generation != m_program->generation) {
+      resolve();
+    }
+    return m_location;
+  }
+
+ private:
+  // find location in reflected uniforms of program
+  void resolve() const;
+
+  shader_program const* m_program;
+  std::string m_name;
+  mutable unsigned m_generation;
+  mutable GLint m_location;
+};
+
+// index of named uniform block in reflected program, GL_INVALID_INDEX if inactive
+GLuint uniform_block_index(shader_program const& program, std::string const& name);
+
+#endif
@@ -9,8 +9,13 @@ struct pixel_data;
 struct texture_object;
 
 namespace utils {
-  // generate texture object from texture struct
-  texture_object create_texture_object(pixel_data const& tex);
+  // generate 2d texture object with all mip levels of texture struct, sampled trilinear and anisotropic if available
+  // srgb color is filtered in linear light, disable for data such as normals
+  texture_object create_texture_object(pixel_data const& tex, bool srgb = true);
+  // trilinear filtering over level_num levels of texture bound to target, anisotropic if available
+  void set_mip_filtering(GLenum target, std::size_t level_num);
+  // true if the current context supports the named extension
+  bool has_extension(std::string const& name);
   // print bound textures for all texture units
   void print_bound_textures();
 
@@ -0,0 +1,114 @@
+#include "benchmark.hpp"
+#include "gpu_profiler.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <stdexcept>
+
+Benchmark::Benchmark(unsigned frames, unsigned warmup)
+ :m_frames{frames}
+ ,m_warmup{warmup}
+ ,m_frame_count{0}
+ ,m_frame_start{}
+ ,m_run_start{}
+ ,m_run_end{}
+ ,m_frame_times{}
+{
+  m_frame_times.reserve(frames);
+}
+
+void Benchmark::beginFrame() {
+  m_frame_start = clock::now();
+  // first measured frame starts the wall time
+  if (m_frame_count == m_warmup) {
+    m_run_start = m_frame_start;
+  }
+}
+
+void Benchmark::endFrame() {
+  clock::time_point frame_end = clock::now();
+  // only record frames after warmup
+  if (m_frame_count >= m_warmup) {
+    std::chrono::duration<double, std::milli> frame_time = frame_end - m_frame_start;
+    m_frame_times.push_back(frame_time.count());
+    m_run_end = frame_end;
+  }
+  ++m_frame_count;
+}
+
+bool Benchmark::finished() const {
+  return m_frame_count >= m_warmup + m_frames;
+}
+
+sample_summary Benchmark::summarize(std::vector<double> samples) {
+  sample_summary summary{};
+  if (samples.empty()) {
+    return summary;
+  }
+
+  std::sort(samples.begin(), samples.end());
+  // nearest-rank percentile of sorted samples
+  auto percentile = [&samples](double p) {
+    std::size_t rank = std::size_t(p * double(samples.size() - 1) + 0.5);
+    return samples[rank];
+  };
+
+  summary.count = samples.size();
+  summary.min = samples.front();
+  summary.max = samples.back();
+  summary.total = std::accumulate(samples.begin(), samples.end(), 0.0);
+  summary.mean = summary.total / double(samples.size());
+  summary.p50 = percentile(0.50);
+  summary.p95 = percentile(0.95);
+  summary.p99 = percentile(0.99);
+
+  return summary;
+}
+
+void Benchmark::print(std::ostream& os) const {
+  sample_summary frames = summarize(m_frame_times);
+  std::chrono::duration<double> wall_time = m_run_end - m_run_start;
+
+  os << "Benchmark - " << frames.count << " frames after " << m_warmup << " warmup frames" << std::endl;
+  os << "frame time [ms] - min " << frames.min << ", mean " << frames.mean
+     << ", p50 " << frames.p50 << ", p95 " << frames.p95
+     << ", p99 " << frames.p99 << ", max " << frames.max << std::endl;
+  os << "wall time [s] - " << wall_time.count() << std::endl;
+  // pass timings if profiling was active
+  gpu_profiler::print(os);
+}
+
+void Benchmark::writeReport(std::string const& file_path) const {
+  std::ofstream file{file_path};
+  if (!file) {
+    throw std::invalid_argument("Could not write benchmark report to " + file_path);
+  }
+
+  // per-frame times
+  file << "frame,cpu_ms" << std::endl;
+  for (std::size_t i = 0; i < m_frame_times.size(); ++i) {
+    file << i << "," << m_frame_times[i] << std::endl;
+  }
+
+  // summary
+  sample_summary frames = summarize(m_frame_times);
+  std::chrono::duration<double> wall_time = m_run_end - m_run_start;
+
+  file << std::endl << "statistic,value" << std::endl;
+  file << "frames," << frames.count << std::endl;
+  file << "warmup," << m_warmup << std::endl;
+  file << "min_ms," << frames.min << std::endl;
+  file << "mean_ms," << frames.mean << std::endl;
+  file << "p50_ms," << frames.p50 << std::endl;
+  file << "p95_ms," << frames.p95 << std::endl;
+  file << "p99_ms," << frames.p99 << std::endl;
+  file << "max_ms," << frames.max << std::endl;
+  file << "wall_s," << wall_time.count() << std::endl;
+  // pass timings if profiling was active
+  for (auto const& pass : gpu_profiler::results()) {
+    file << "gpu_" << pass.name << "_avg_ms," << pass.average_ms << std::endl;
+    file << "gpu_" << pass.name << "_max_ms," << pass.max_ms << std::endl;
+  }
+}
@@ -0,0 +1,196 @@
+#include "block_compression.hpp"
+
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/gtc/type_precision.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace block_compression {
+
+namespace {
+  // rgba values of the 16 texels of a block, row by row
+  typedef std::uint8_t block_texels[16][4];
+
+  void gather(pixel_data const& image, std::size_t channels, std::size_t block_x, std::size_t block_y, block_texels& texels) {
+    for (std::size_t y = 0; y < 4; ++y) {
+      std::size_t source_y = std::min(block_y * 4 + y, image.height - 1);
+      for (std::size_t x = 0; x < 4; ++x) {
+        std::size_t source_x = std::min(block_x * 4 + x, image.width - 1);
+        std::uint8_t const* source = &image.pixels[(source_y * image.width + source_x) * channels];
+        std::uint8_t* target = texels[y * 4 + x];
+        bool grey = channels <= 2;
+        target[0] = source[0];
+        target[1] = grey ? source[0] : source[1];
+        target[2] = grey ? source[0] : source[2];
+        target[3] = 255;
+      }
+    }
+  }
+
+  void write_le(std::uint8_t* out, std::uint64_t value, std::size_t bytes) {
+    for (std::size_t i = 0; i < bytes; ++i) {
+      out[i] = std::uint8_t(value >> (8 * i));
+    }
+  }
+
+  std::uint16_t pack_565(glm::fvec3 const& color) {
+    glm::fvec3 clamped = glm::clamp(color, 0.0f, 255.0f);
+    std::uint16_t r = std::uint16_t(clamped.r * 31.0f / 255.0f + 0.5f);
+    std::uint16_t g = std::uint16_t(clamped.g * 63.0f / 255.0f + 0.5f);
+    std::uint16_t b = std::uint16_t(clamped.b * 31.0f / 255.0f + 0.5f);
+    return std::uint16_t((r << 11) | (g << 5) | b);
+  }
+
+  // expansion done by the hardware, replicating high bits
+  glm::fvec3 unpack_565(std::uint16_t color) {
+    unsigned r = (color >> 11) & 31;
+    unsigned g = (color >> 5) & 63;
+    unsigned b = color & 31;
+    return glm::fvec3{float((r << 3) | (r >> 2)), float((g << 2) | (g >> 4)), float((b << 3) | (b >> 2))};
+  }
+
+  // endpoints on the principal axis of the block colors, indices to nearest of four palette colors
+  void encode_bc1(block_texels const& texels, std::uint8_t* out) {
+    glm::fvec3 colors[16];
+    glm::fvec3 mean{0.0f};
+    glm::fvec3 minimum{255.0f};
+    glm::fvec3 maximum{0.0f};
+    for (std::size_t i = 0; i < 16; ++i) {
+      colors[i] = glm::fvec3{float(texels[i][0]), float(texels[i][1]), float(texels[i][2])};
+      mean += colors[i];
+      minimum = glm::min(minimum, colors[i]);
+      maximum = glm::max(maximum, colors[i]);
+    }
+    mean /= 16.0f;
+
+    // covariance, symmetric
+    float xx = 0.0f, xy = 0.0f, xz = 0.0f, yy = 0.0f, yz = 0.0f, zz = 0.0f;
+    for (auto const& color : colors) {
+      glm::fvec3 d = color - mean;
+      xx += d.x * d.x; xy += d.x * d.y; xz += d.x * d.z;
+      yy += d.y * d.y; yz += d.y * d.z; zz += d.z * d.z;
+    }
+    // power iteration from the diagonal of the bounding box
+    glm::fvec3 axis = maximum - minimum;
+    for (int iteration = 0; iteration < 4; ++iteration) {
+      glm::fvec3 next{xx * axis.x + xy * axis.y + xz * axis.z,
+                      xy * axis.x + yy * axis.y + yz * axis.z,
+                      xz * axis.x + yz * axis.y + zz * axis.z};
+      float length = glm::length(next);
+      if (length < 1e-6f) break;
+      axis = next / length;
+    }
+    if (glm::length(axis) < 1e-6f) {
+      axis = glm::fvec3{0.57735f};
+    }
+    axis = glm::normalize(axis);
+
+    float low = std::numeric_limits<float>::max();
+    float high = -std::numeric_limits<float>::max();
+    for (auto const& color : colors) {
+      float t = glm::dot(color - mean, axis);
+      low = std::min(low, t);
+      high = std::max(high, t);
+    }
+    // extremes are rarely hit exactly, inset reduces the error of the interpolated colors
+    float inset = (high - low) / 16.0f;
+    std::uint16_t color0 = pack_565(mean + axis * (high - inset));
+    std::uint16_t color1 = pack_565(mean + axis * (low + inset));
+    // four color mode requires the larger value first
+    if (color0 < color1) {
+      std::swap(color0, color1);
+    }
+
+    std::uint32_t indices = 0;
+    if (color0 != color1) {
+      glm::fvec3 end0 = unpack_565(color0);
+      glm::fvec3 end1 = unpack_565(color1);
+      glm::fvec3 const palette[4] = {end0, end1, (end0 * 2.0f + end1) / 3.0f, (end0 + end1 * 2.0f) / 3.0f};
+      for (std::size_t i = 0; i < 16; ++i) {
+        std::uint32_t best = 0;
+        float best_distance = std::numeric_limits<float>::max();
+        for (std::uint32_t p = 0; p < 4; ++p) {
+          glm::fvec3 d = colors[i] - palette[p];
+          float distance = glm::dot(d, d);
+          if (distance < best_distance) {
+            best_distance = distance;
+            best = p;
+          }
+        }
+        indices |= best << (2 * i);
+      }
+    }
+    write_le(out, color0, 2);
+    write_le(out + 2, color1, 2);
+    write_le(out + 4, indices, 4);
+  }
+
+  // single channel block, eight values from maximum to minimum
+  void encode_bc4(block_texels const& texels, std::size_t channel, std::uint8_t* out) {
+    std::uint8_t low = 255;
+    std::uint8_t high = 0;
+    for (std::size_t i = 0; i < 16; ++i) {
+      low = std::min(low, texels[i][channel]);
+      high = std::max(high, texels[i][channel]);
+    }
+    std::uint64_t indices = 0;
+    if (high > low) {
+      float scale = 7.0f / float(high - low);
+      for (std::size_t i = 0; i < 16; ++i) {
+        // steps from high to low, index 0 and 1 are the endpoints, 2 to 7 the values in between
+        std::uint64_t step = std::uint64_t(float(high - texels[i][channel]) * scale + 0.5f);
+        std::uint64_t index = step == 0 ? 0 : step == 7 ? 1 : step + 1;
+        indices |= index << (3 * i);
+      }
+    }
+    out[0] = high;
+    out[1] = low;
+    write_le(out + 2, indices, 6);
+  }
+}
+
+std::size_t block_size(GLenum format) {
+  if (format == GL_COMPRESSED_RGB_S3TC_DXT1_EXT) return 8;
+  if (format == GL_COMPRESSED_RG_RGTC2) return 16;
+  throw std::invalid_argument("Block compression: unsupported format");
+}
+
+std::size_t image_size(GLenum format, std::size_t width, std::size_t height) {
+  return ((width + 3) / 4) * ((height + 3) / 4) * block_size(format);
+}
+
+std::vector<std::uint8_t> compress(pixel_data const& image, GLenum format) {
+  if (image.channel_type != GL_UNSIGNED_BYTE) {
+    throw std::invalid_argument("Block compression: no 8 bit image");
+  }
+  std::size_t channels = channel_count(image.channels);
+  std::size_t size = block_size(format);
+  std::size_t blocks_x = (image.width + 3) / 4;
+  std::size_t blocks_y = (image.height + 3) / 4;
+  std::vector<std::uint8_t> result(blocks_x * blocks_y * size);
+  if (image.width == 0 || image.height == 0) {
+    return result;
+  }
+
+  block_texels texels;
+  for (std::size_t y = 0; y < blocks_y; ++y) {
+    for (std::size_t x = 0; x < blocks_x; ++x) {
+      gather(image, channels, x, y, texels);
+      std::uint8_t* out = &result[(y * blocks_x + x) * size];
+      if (format == GL_COMPRESSED_RGB_S3TC_DXT1_EXT) {
+        encode_bc1(texels, out);
+      }
+      else {
+        encode_bc4(texels, 0, out);
+        encode_bc4(texels, 1, out + 8);
+      }
+    }
+  }
+  return result;
+}
+
+};
@@ -0,0 +1,144 @@
+#include "culling.hpp"
+
+#include <glm/geometric.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// SSE2 is available on every x86-64 target
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CULLING_SSE
+#include <emmintrin.h>
+#endif
+
+namespace culling {
+
+namespace {
+  counters frame_counters{0, 0};
+  counters last_counters{0, 0};
+
+  bool inside(frustum const& volume, bounding_sphere const& sphere) {
+    for (auto const& plane : volume.planes) {
+      if (glm::dot(glm::fvec3{plane}, sphere.center) + plane.w < -sphere.radius) {
+        return false;
+      }
+    }
+    return true;
+  }
+}
+
+bounding_sphere bounds(GLfloat const* data, std::size_t vertex_num, std::size_t stride) {
+  if (vertex_num == 0) {
+    return bounding_sphere{glm::fvec3{0.0f}, 0.0f};
+  }
+  // center of bounding box, radius to farthest vertex
+  glm::fvec3 minimum{std::numeric_limits<float>::max()};
+  glm::fvec3 maximum{-std::numeric_limits<float>::max()};
+  for (std::size_t v = 0; v < vertex_num; ++v) {
+    glm::fvec3 position{data[v * stride], data[v * stride + 1], data[v * stride + 2]};
+    minimum = glm::min(minimum, position);
+    maximum = glm::max(maximum, position);
+  }
+  glm::fvec3 center = (minimum + maximum) * 0.5f;
+  float radius2 = 0.0f;
+  for (std::size_t v = 0; v < vertex_num; ++v) {
+    glm::fvec3 offset = glm::fvec3{data[v * stride], data[v * stride + 1], data[v * stride + 2]} - center;
+    radius2 = std::max(radius2, glm::dot(offset, offset));
+  }
+  return bounding_sphere{center, std::sqrt(radius2)};
+}
+
+frustum extract(glm::fmat4 const& view_projection) {
+  // rows of the column major matrix
+  glm::fvec4 rows[4];
+  for (int row = 0; row < 4; ++row) {
+    rows[row] = glm::fvec4{view_projection[0][row], view_projection[1][row], view_projection[2][row], view_projection[3][row]};
+  }
+  // -w <= x, y, z <= w in clip space
+  frustum volume{};
+  volume.planes[0] = rows[3] + rows[0];
+  volume.planes[1] = rows[3] - rows[0];
+  volume.planes[2] = rows[3] + rows[1];
+  volume.planes[3] = rows[3] - rows[1];
+  volume.planes[4] = rows[3] + rows[2];
+  volume.planes[5] = rows[3] - rows[2];
+  // unit normals make plane distances comparable to radii
+  for (auto& plane : volume.planes) {
+    plane /= glm::length(glm::fvec3{plane});
+  }
+  return volume;
+}
+
+void transform(bounding_sphere const& local, glm::fmat4 const* models, std::size_t count, bounding_sphere* out) {
+  for (std::size_t i = 0; i < count; ++i) {
+    glm::fmat4 const& model = models[i];
+    float scale2 = std::max(std::max(glm::dot(glm::fvec3{model[0]}, glm::fvec3{model[0]}),
+                                     glm::dot(glm::fvec3{model[1]}, glm::fvec3{model[1]})),
+                            glm::dot(glm::fvec3{model[2]}, glm::fvec3{model[2]}));
+    out[i].center = glm::fvec3{model * glm::fvec4{local.center, 1.0f}};
+    out[i].radius = local.radius * std::sqrt(scale2);
+  }
+}
+
+void cull(frustum const& volume, bounding_sphere const* spheres, std::size_t count, std::vector<std::size_t>& visible,
+          bool counted) {
+  std::size_t const previous = visible.size();
+  std::size_t i = 0;
+#ifdef CULLING_SSE
+  __m128 plane_x[6], plane_y[6], plane_z[6], plane_w[6];
+  for (int p = 0; p < 6; ++p) {
+    plane_x[p] = _mm_set1_ps(volume.planes[p].x);
+    plane_y[p] = _mm_set1_ps(volume.planes[p].y);
+    plane_z[p] = _mm_set1_ps(volume.planes[p].z);
+    plane_w[p] = _mm_set1_ps(volume.planes[p].w);
+  }
+  __m128 const zero = _mm_setzero_ps();
+  for (; i + 4 <= count; i += 4) {
+    // spheres are four floats, transpose to one sphere per lane
+    __m128 x = _mm_loadu_ps(&spheres[i].center.x);
+    __m128 y = _mm_loadu_ps(&spheres[i + 1].center.x);
+    __m128 z = _mm_loadu_ps(&spheres[i + 2].center.x);
+    __m128 r = _mm_loadu_ps(&spheres[i + 3].center.x);
+    _MM_TRANSPOSE4_PS(x, y, z, r);
+    __m128 negative_radius = _mm_sub_ps(zero, r);
+
+    __m128 in = _mm_castsi128_ps(_mm_set1_epi32(-1));
+    for (int p = 0; p < 6; ++p) {
+      __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, plane_x[p]), _mm_mul_ps(y, plane_y[p])),
+                                   _mm_add_ps(_mm_mul_ps(z, plane_z[p]), plane_w[p]));
+      in = _mm_and_ps(in, _mm_cmpge_ps(distance, negative_radius));
+    }
+    int mask = _mm_movemask_ps(in);
+    for (std::size_t lane = 0; lane < 4; ++lane) {
+      if (mask & (1 << lane)) {
+        visible.push_back(i + lane);
+      }
+    }
+  }
+#endif
+  for (; i < count; ++i) {
+    if (inside(volume, spheres[i])) {
+      visible.push_back(i);
+    }
+  }
+  if (!counted) return;
+  frame_counters.tested += count;
+  frame_counters.visible += visible.size() - previous;
+}
+
+void frame() {
+  last_counters = frame_counters;
+  frame_counters = counters{0, 0};
+}
+
+counters last_frame() {
+  return last_counters;
+}
+
+void print(std::ostream& os) {
+  os << "Culling - " << last_counters.visible << " of " << last_counters.tested << " visible, "
+     << last_counters.tested - last_counters.visible << " culled" << std::endl;
+}
+
+};
@@ -0,0 +1,118 @@
+#include "frame_ring.hpp"
+
+#include "gl_state.hpp"
+
+#include <glbinding/gl/gl.h>
+// use gl definitions from glbinding
+using namespace gl;
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace {
+  // wait in steps of a millisecond to stay responsive to lost contexts
+  const GLuint64 WAIT_TIMEOUT = 1000000;
+
+  GLsizeiptr align_up(GLsizeiptr value, GLsizeiptr alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+  }
+}
+
+frame_ring::frame_ring(GLenum target, GLsizeiptr frame_size, unsigned frames, GLsizeiptr alignment)
+ :m_target{target}
+ ,m_frame_size{0}
+ ,m_alignment{alignment}
+ ,m_buffer{0}
+ ,m_fences(frames > 0 ? frames : 1, nullptr)
+ ,m_frame{0}
+ ,m_head{0}
+ ,m_stalls{0}
+{
+  if (target == GL_UNIFORM_BUFFER) {
+    GLint uniform_alignment = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniform_alignment);
+    m_alignment = uniform_alignment > 0 ? GLsizeiptr(uniform_alignment) : 256;
+  }
+  // partitions start aligned as well
+  m_frame_size = align_up(frame_size, m_alignment);
+
+  glGenBuffers(1, &m_buffer);
+  gl_state::bind_buffer(m_target, m_buffer);
+  glBufferData(m_target, m_frame_size * GLsizeiptr(m_fences.size()), nullptr, GL_STREAM_DRAW);
+}
+
+frame_ring::~frame_ring() {
+  for (GLsync fence : m_fences) {
+    if (fence) {
+      glDeleteSync(fence);
+    }
+  }
+  gl_state::delete_buffers(1, &m_buffer);
+}
+
+void frame_ring::next_frame() {
+  // everything issued so far may read the current partition
+  if (m_fences[m_frame]) {
+    glDeleteSync(m_fences[m_frame]);
+  }
+  m_fences[m_frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, GL_UNUSED_BIT);
+
+  m_frame = (m_frame + 1) % unsigned(m_fences.size());
+  m_head = 0;
+
+  GLsync& fence = m_fences[m_frame];
+  if (!fence) return;
+  // flush so the fence is reached even if nothing else is submitted
+  GLenum status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+  if (status == GL_TIMEOUT_EXPIRED) {
+    ++m_stalls;
+    do {
+      status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, WAIT_TIMEOUT);
+    } while (status == GL_TIMEOUT_EXPIRED);
+  }
+  glDeleteSync(fence);
+  fence = nullptr;
+}
+
+ring_range frame_ring::upload(void const* data, GLsizeiptr size) {
+  if (m_head + size > m_frame_size) {
+    throw std::length_error{"frame_ring - " + std::to_string(size) + " bytes exceed remaining "
+                            + std::to_string(m_frame_size - m_head) + " of frame"};
+  }
+  ring_range range{};
+  range.buffer = m_buffer;
+  range.offset = GLintptr(m_frame) * m_frame_size + m_head;
+  range.size = size;
+  m_head = align_up(m_head + size, m_alignment);
+
+  // fence guarantees the range is not read anymore, no implicit synchronization needed
+  gl_state::bind_buffer(m_target, m_buffer);
+  void* mapped = glMapBufferRange(m_target, range.offset, range.size,
+                                  GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+  if (mapped) {
+    std::memcpy(mapped, data, std::size_t(size));
+  }
+  glUnmapBuffer(m_target);
+  return range;
+}
+
+void frame_ring::bind(GLuint index, ring_range const& range) const {
+  gl_state::bind_buffer_range(m_target, index, range.buffer, range.offset, range.size);
+}
+
+GLuint frame_ring::buffer() const {
+  return m_buffer;
+}
+
+GLsizeiptr frame_ring::frame_size() const {
+  return m_frame_size;
+}
+
+GLsizeiptr frame_ring::alignment() const {
+  return m_alignment;
+}
+
+unsigned long frame_ring::stalls() const {
+  return m_stalls;
+}
@@ -0,0 +1,124 @@
+#include "gl_errors.hpp"
+
+#include <glbinding/gl/gl.h>
+#include <glbinding/gl/extension.h>
+// load glbinding extensions
+#include <glbinding/Binding.h>
+#include <glbinding/ContextInfo.h>
+#include <glbinding/Version.h>
+// load meta info extension
+#include <glbinding/Meta.h>
+// use gl definitions from glbinding
+using namespace gl;
+
+#include <iostream>
+#include <stdexcept>
+
+namespace gl_errors {
+
+namespace {
+  // currently installed tier
+  tier active_tier = tier::off;
+
+  // receives messages from driver in debug_output tier
+  void GL_APIENTRY debug_message(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar* message, const void* user_param) {
+    // ignore performance and status notifications
+    if (severity == GL_DEBUG_SEVERITY_NOTIFICATION) return;
+
+    std::cerr << "OpenGL " << (type == GL_DEBUG_TYPE_ERROR ? "Error" : "Message")
+              << " (" << glbinding::Meta::getString(severity) << "): "
+              << std::string(message, std::size_t(length)) << std::endl;
+  }
+
+  // glGetError after each call, prints call and throws
+  void check_call(glbinding::CallRecord const& record) {
+    GLenum error = glGetError();
+    if (error != GL_NO_ERROR) {
+      // parameters are only boxed into strings when printing
+      std::cerr <<  "OpenGL Error: " << record.toString()
+                << " - " << glbinding::Meta::getString(error) << std::endl;
+      // throw exception to allow for backtrace
+      throw std::runtime_error("Execution of " + std::string(record.function->name()));
+    }
+  }
+
+  void watch_calls() {
+    // record callback after each function call, does not allocate
+    glbinding::setCallbackMaskExcept(glbinding::CallbackMask::Record, {"glGetError", "glBegin", "glVertex3f", "glColor3f"});
+    glbinding::setRecordCallback(check_call);
+  }
+
+  // register driver callback, returns false if unsupported
+  bool watch_debug_output() {
+    if (glbinding::ContextInfo::supported(glbinding::Version{4, 3})
+     || glbinding::ContextInfo::supported({GLextension::GL_KHR_debug})) {
+      glDebugMessageCallback(debug_message, nullptr);
+    }
+    else if (glbinding::ContextInfo::supported({GLextension::GL_ARB_debug_output})) {
+      glDebugMessageCallbackARB(debug_message, nullptr);
+    }
+    else {
+      return false;
+    }
+    glEnable(GL_DEBUG_OUTPUT);
+    return true;
+  }
+}
+
+tier default_tier() {
+#if defined(GL_ERROR_CHECK_OFF)
+  return tier::off;
+#elif defined(GL_ERROR_CHECK_DEBUG)
+  return tier::debug_output;
+#elif defined(GL_ERROR_CHECK_CALL)
+  return tier::per_call;
+#else
+  return tier::per_frame;
+#endif
+}
+
+tier parse(std::string const& name) {
+  if (name == "off") return tier::off;
+  else if (name == "debug") return tier::debug_output;
+  else if (name == "frame") return tier::per_frame;
+  else if (name == "call") return tier::per_call;
+
+  throw std::invalid_argument("Unknown error checking tier " + name);
+}
+
+std::string name(tier level) {
+  switch (level) {
+    case tier::off: return "off";
+    case tier::debug_output: return "debug";
+    case tier::per_frame: return "frame";
+    case tier::per_call: return "call";
+  }
+  return "";
+}
+
+tier activate(tier level) {
+  // remove callbacks of previous tier
+  glbinding::setCallbackMask(glbinding::CallbackMask::None);
+
+  if (level == tier::debug_output && !watch_debug_output()) {
+    std::cerr << "Debug output not supported, checking errors per frame" << std::endl;
+    level = tier::per_frame;
+  }
+  else if (level == tier::per_call) {
+    watch_calls();
+  }
+
+  active_tier = level;
+  return active_tier;
+}
+
+void check_frame() {
+  if (active_tier != tier::per_frame) return;
+
+  // multiple error flags may be set
+  for (GLenum error = glGetError(); error != GL_NO_ERROR; error = glGetError()) {
+    std::cerr << "OpenGL Error during frame - " << glbinding::Meta::getString(error) << std::endl;
+  }
+}
+
+};
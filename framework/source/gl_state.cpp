@@ -0,0 +1,312 @@
+#include "gl_state.hpp"
+
+#include <glbinding/gl/gl.h>
+// use gl definitions from glbinding
+using namespace gl;
+
+#include <algorithm>
+#include <array>
+#include <utility>
+
+namespace gl_state {
+
+namespace {
+  // value of a piece of state, unknown until first set through the cache
+  template<typename T>
+  struct shadow {
+    T value;
+    bool known;
+  };
+
+  GLenum const BUFFER_TARGETS[] = {
+    GL_ARRAY_BUFFER, GL_ELEMENT_ARRAY_BUFFER, GL_UNIFORM_BUFFER, GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+    GL_PIXEL_PACK_BUFFER, GL_PIXEL_UNPACK_BUFFER, GL_TEXTURE_BUFFER, GL_TRANSFORM_FEEDBACK_BUFFER
+  };
+  GLenum const TEXTURE_TARGETS[] = {
+    GL_TEXTURE_1D, GL_TEXTURE_2D, GL_TEXTURE_3D, GL_TEXTURE_CUBE_MAP, GL_TEXTURE_1D_ARRAY, GL_TEXTURE_2D_ARRAY,
+    GL_TEXTURE_RECTANGLE, GL_TEXTURE_BUFFER, GL_TEXTURE_2D_MULTISAMPLE, GL_TEXTURE_2D_MULTISAMPLE_ARRAY
+  };
+  GLenum const CAPABILITIES[] = {
+    GL_BLEND, GL_DEPTH_TEST, GL_CULL_FACE, GL_SCISSOR_TEST, GL_STENCIL_TEST, GL_PROGRAM_POINT_SIZE,
+    GL_POLYGON_OFFSET_FILL, GL_MULTISAMPLE, GL_FRAMEBUFFER_SRGB
+  };
+  const std::size_t BUFFER_TARGET_NUM = sizeof(BUFFER_TARGETS) / sizeof(GLenum);
+  const std::size_t TEXTURE_TARGET_NUM = sizeof(TEXTURE_TARGETS) / sizeof(GLenum);
+  const std::size_t CAPABILITY_NUM = sizeof(CAPABILITIES) / sizeof(GLenum);
+  // units beyond are forwarded unfiltered
+  const std::size_t TEXTURE_UNITS = 32;
+
+  struct state {
+    shadow<GLuint> program;
+    shadow<GLuint> vertex_array;
+    shadow<GLuint> buffers[BUFFER_TARGET_NUM];
+    shadow<GLuint> draw_framebuffer;
+    shadow<GLuint> read_framebuffer;
+    shadow<GLenum> active_unit;
+    shadow<GLuint> textures[TEXTURE_UNITS][TEXTURE_TARGET_NUM];
+    shadow<bool> capabilities[CAPABILITY_NUM];
+    shadow<std::pair<GLenum, GLenum>> blend_func;
+    shadow<GLenum> depth_func;
+    shadow<GLboolean> depth_mask;
+    shadow<std::array<GLint, 4>> viewport;
+  };
+
+  bool is_active = false;
+  // value initialization leaves everything unknown
+  state current{};
+  counters frame_counters{0, 0};
+  counters last_counters{0, 0};
+
+  // true if the call has to reach GL, remembers the new value
+  template<typename T>
+  bool needs_call(shadow<T>& slot, T const& value) {
+    if (!is_active) return true;
+    if (slot.known && slot.value == value) {
+      ++frame_counters.filtered;
+      return false;
+    }
+    slot.value = value;
+    slot.known = true;
+    ++frame_counters.issued;
+    return true;
+  }
+
+  // calls changing state which is not shadowed still count
+  void count_unfiltered() {
+    if (is_active) ++frame_counters.issued;
+  }
+
+  // position of value in list, list size if missing
+  template<std::size_t N>
+  std::size_t index_of(GLenum const (&list)[N], GLenum value) {
+    return std::size_t(std::find(list, list + N, value) - list);
+  }
+
+  // shadowed textures of active unit for target, nullptr if not tracked
+  shadow<GLuint>* texture_slot(GLenum target) {
+    if (!current.active_unit.known) return nullptr;
+    std::size_t unit = std::size_t(current.active_unit.value) - std::size_t(GL_TEXTURE0);
+    std::size_t target_index = index_of(TEXTURE_TARGETS, target);
+    if (unit >= TEXTURE_UNITS || target_index == TEXTURE_TARGET_NUM) return nullptr;
+    return &current.textures[unit][target_index];
+  }
+
+  // deleted objects are unbound, bindings to them fall back to 0
+  void reset_binding(shadow<GLuint>& slot, GLuint deleted) {
+    if (slot.known && slot.value == deleted) {
+      slot.value = 0;
+    }
+  }
+
+  void set_capability(GLenum capability, bool enabled) {
+    std::size_t index = index_of(CAPABILITIES, capability);
+    if (index == CAPABILITY_NUM) {
+      count_unfiltered();
+    }
+    else if (!needs_call(current.capabilities[index], enabled)) {
+      return;
+    }
+    if (enabled) {
+      glEnable(capability);
+    }
+    else {
+      glDisable(capability);
+    }
+  }
+}
+
+void initialize() {
+  is_active = true;
+  invalidate();
+  frame_counters = counters{0, 0};
+  last_counters = counters{0, 0};
+}
+
+void release() {
+  is_active = false;
+  invalidate();
+}
+
+bool active() {
+  return is_active;
+}
+
+void invalidate() {
+  current = state{};
+}
+
+void frame() {
+  last_counters = frame_counters;
+  frame_counters = counters{0, 0};
+}
+
+counters last_frame() {
+  return last_counters;
+}
+
+void print(std::ostream& os) {
+  unsigned long total = last_counters.issued + last_counters.filtered;
+  os << "GL state - " << last_counters.issued << " calls issued, " << last_counters.filtered << " filtered";
+  if (total > 0) {
+    os << " (" << 100 * last_counters.filtered / total << "%)";
+  }
+  os << std::endl;
+}
+
+void use_program(GLuint program) {
+  if (needs_call(current.program, program)) {
+    glUseProgram(program);
+  }
+}
+
+void bind_vertex_array(GLuint vertex_array) {
+  if (needs_call(current.vertex_array, vertex_array)) {
+    glBindVertexArray(vertex_array);
+    current.buffers[index_of(BUFFER_TARGETS, GL_ELEMENT_ARRAY_BUFFER)].known = false;
+  }
+}
+
+void bind_buffer(GLenum target, GLuint buffer) {
+  std::size_t index = index_of(BUFFER_TARGETS, target);
+  if (index == BUFFER_TARGET_NUM) {
+    count_unfiltered();
+  }
+  else if (!needs_call(current.buffers[index], buffer)) {
+    return;
+  }
+  glBindBuffer(target, buffer);
+}
+
+void bind_buffer_base(GLenum target, GLuint index, GLuint buffer) {
+  // indexed bindings are not shadowed
+  count_unfiltered();
+  glBindBufferBase(target, index, buffer);
+  std::size_t target_index = index_of(BUFFER_TARGETS, target);
+  if (is_active && target_index != BUFFER_TARGET_NUM) {
+    current.buffers[target_index] = shadow<GLuint>{buffer, true};
+  }
+}
+
+void bind_buffer_range(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size) {
+  count_unfiltered();
+  glBindBufferRange(target, index, buffer, offset, size);
+  std::size_t target_index = index_of(BUFFER_TARGETS, target);
+  if (is_active && target_index != BUFFER_TARGET_NUM) {
+    current.buffers[target_index] = shadow<GLuint>{buffer, true};
+  }
+}
+
+void bind_framebuffer(GLenum target, GLuint framebuffer) {
+  if (target == GL_DRAW_FRAMEBUFFER) {
+    if (!needs_call(current.draw_framebuffer, framebuffer)) return;
+  }
+  else if (target == GL_READ_FRAMEBUFFER) {
+    if (!needs_call(current.read_framebuffer, framebuffer)) return;
+  }
+  else {
+    // both bindings, filtered only if both match
+    bool draw = needs_call(current.draw_framebuffer, framebuffer);
+    bool read = is_active ? current.read_framebuffer.known && current.read_framebuffer.value == framebuffer : false;
+    if (!draw && read) return;
+    if (is_active) {
+      // one call, counted once by the draw binding
+      if (!draw) {
+        --frame_counters.filtered;
+        ++frame_counters.issued;
+      }
+      current.read_framebuffer = shadow<GLuint>{framebuffer, true};
+    }
+  }
+  glBindFramebuffer(target, framebuffer);
+}
+
+void active_texture(GLenum unit) {
+  if (needs_call(current.active_unit, unit)) {
+    glActiveTexture(unit);
+  }
+}
+
+void bind_texture(GLenum target, GLuint texture) {
+  shadow<GLuint>* slot = texture_slot(target);
+  if (!slot) {
+    count_unfiltered();
+  }
+  else if (!needs_call(*slot, texture)) {
+    return;
+  }
+  glBindTexture(target, texture);
+}
+
+void enable(GLenum capability) {
+  set_capability(capability, true);
+}
+
+void disable(GLenum capability) {
+  set_capability(capability, false);
+}
+
+void blend_func(GLenum source, GLenum destination) {
+  if (needs_call(current.blend_func, std::make_pair(source, destination))) {
+    glBlendFunc(source, destination);
+  }
+}
+
+void depth_func(GLenum function) {
+  if (needs_call(current.depth_func, function)) {
+    glDepthFunc(function);
+  }
+}
+
+void depth_mask(GLboolean mask) {
+  if (needs_call(current.depth_mask, mask)) {
+    glDepthMask(mask);
+  }
+}
+
+void viewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+  std::array<GLint, 4> value = {{x, y, GLint(width), GLint(height)}};
+  if (needs_call(current.viewport, value)) {
+    glViewport(x, y, width, height);
+  }
+}
+
+void delete_program(GLuint program) {
+  glDeleteProgram(program);
+  // stays in use until another program is bound, its name may not be reused before
+  if (current.program.known && current.program.value == program) {
+    current.program.known = false;
+  }
+}
+
+void delete_vertex_arrays(GLsizei count, GLuint const* vertex_arrays) {
+  glDeleteVertexArrays(count, vertex_arrays);
+  for (GLsizei i = 0; i < count; ++i) {
+    if (current.vertex_array.known && current.vertex_array.value == vertex_arrays[i]) {
+      current.vertex_array.value = 0;
+      // default vertex array has its own element array binding
+      current.buffers[index_of(BUFFER_TARGETS, GL_ELEMENT_ARRAY_BUFFER)].known = false;
+    }
+  }
+}
+
+void delete_buffers(GLsizei count, GLuint const* buffers) {
+  glDeleteBuffers(count, buffers);
+  for (GLsizei i = 0; i < count; ++i) {
+    for (auto& slot : current.buffers) {
+      reset_binding(slot, buffers[i]);
+    }
+  }
+}
+
+void delete_textures(GLsizei count, GLuint const* textures) {
+  glDeleteTextures(count, textures);
+  for (GLsizei i = 0; i < count; ++i) {
+    for (auto& unit : current.textures) {
+      for (auto& slot : unit) {
+        reset_binding(slot, textures[i]);
+      }
+    }
+  }
+}
+
+};
@@ -0,0 +1,702 @@
+#include "gl_trace.hpp"
+
+#include <glbinding/gl/gl.h>
+// load glbinding extensions
+#include <glbinding/Binding.h>
+#include <glbinding/callbacks.h>
+// use gl definitions from glbinding
+using namespace gl;
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace gl_trace {
+
+namespace {
+  const char MAGIC[4] = {'G', 'L', 'T', 'R'};
+  const std::uint32_t VERSION = 1;
+  // buffered bytes before writing to file
+  const std::size_t FLUSH_SIZE = 8 << 20;
+  // minimal scratch memory for outputs of unknown size, e.g. glGetIntegerv
+  const std::size_t SCRATCH_SIZE = 64 << 10;
+
+  // records in trace, each starts with its kind
+  enum class record_kind : std::uint8_t {
+    // function index, packed arguments, return value and payloads
+    call = 1,
+    // end of frame
+    frame = 2,
+    // content of mapped buffer before it is unmapped
+    buffer_data = 3
+  };
+
+  // replacement for a pointer argument at replay
+  enum class payload_type : std::uint8_t {
+    // pointer to captured bytes
+    data = 1,
+    // array of pointers to captured null-terminated strings
+    strings = 2,
+    // pointer to scratch memory, captured bytes are names generated by call
+    names = 3,
+    // pointer to scratch memory for outputs
+    scratch = 4,
+    // null pointer
+    null = 5,
+    // sync object created at replay for captured sync object
+    sync = 6,
+    // pointer value kept, e.g. offset into bound buffer, never written
+    keep = 7
+  };
+
+  // replacement of one argument, data is only valid during record callback
+  struct payload {
+    std::size_t argument;
+    payload_type type;
+    void const* data;
+    std::size_t size;
+  };
+
+  // typed access to recorded arguments
+  struct call_arguments {
+    glbinding::CallRecord const& record;
+    unsigned char const* packed;
+
+    std::size_t offset(std::size_t index) const {
+      std::size_t result = 0;
+      for (std::size_t i = 0; i < index; ++i) {
+        result += record.signature.argumentSizes[i];
+      }
+      return result;
+    }
+
+    template<typename T>
+    T get(std::size_t index) const {
+      T value;
+      std::memcpy(&value, packed + offset(index), sizeof(T));
+      return value;
+    }
+
+    // captured bytes behind pointer argument, null pointers are kept
+    payload data(std::size_t index, std::size_t size) const {
+      void const* pointer = get<void const*>(index);
+      if (!pointer) return payload{index, payload_type::keep, nullptr, 0};
+      return payload{index, payload_type::data, pointer, size};
+    }
+    // null-terminated string argument
+    payload string(std::size_t index) const {
+      char const* pointer = get<char const*>(index);
+      if (!pointer) return payload{index, payload_type::keep, nullptr, 0};
+      return payload{index, payload_type::data, pointer, std::strlen(pointer) + 1};
+    }
+  };
+
+  // determines payloads of the pointer arguments of a function
+  typedef void (*payload_rule)(call_arguments const&, std::vector<payload>&);
+
+  // content of currently mapped buffer range per target
+  struct mapping {
+    void const* pointer;
+    std::size_t size;
+  };
+
+  bool is_active = false;
+  // true while callback executes, prevents recording its own queries
+  bool in_callback = false;
+  std::ofstream file{};
+  std::vector<unsigned char> buffer{};
+  unsigned frame_count = 0;
+  std::unordered_map<glbinding::AbstractFunction const*, std::uint16_t> function_indices{};
+  std::unordered_map<glbinding::AbstractFunction const*, payload_rule> payload_rules{};
+  // functions whose arguments are only valid in this process
+  std::unordered_set<glbinding::AbstractFunction const*> skipped_functions{};
+  std::map<GLenum, mapping> mappings{};
+  // reused per call
+  std::vector<payload> payloads{};
+  std::vector<unsigned char> packed_arguments{};
+  std::string shader_sources{};
+
+  template<typename T>
+  void write(T const& value) {
+    unsigned char const* bytes = reinterpret_cast<unsigned char const*>(&value);
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+  }
+
+  void write_bytes(void const* data, std::size_t size) {
+    unsigned char const* bytes = static_cast<unsigned char const*>(data);
+    buffer.insert(buffer.end(), bytes, bytes + size);
+  }
+
+  void flush() {
+    file.write(reinterpret_cast<char const*>(buffer.data()), std::streamsize(buffer.size()));
+    buffer.clear();
+  }
+
+  // size of pixel rectangle in client memory, respects row alignment
+  std::size_t image_size(GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type, GLenum alignment_name) {
+    std::size_t components = 4;
+    switch (format) {
+      case GL_RED: case GL_RED_INTEGER: case GL_GREEN: case GL_BLUE: case GL_ALPHA:
+      case GL_DEPTH_COMPONENT: case GL_STENCIL_INDEX: case GL_LUMINANCE:
+        components = 1; break;
+      case GL_RG: case GL_RG_INTEGER: case GL_DEPTH_STENCIL: case GL_LUMINANCE_ALPHA:
+        components = 2; break;
+      case GL_RGB: case GL_BGR: case GL_RGB_INTEGER: case GL_BGR_INTEGER:
+        components = 3; break;
+      default: break;
+    }
+    std::size_t pixel_size = components;
+    switch (type) {
+      case GL_UNSIGNED_BYTE: case GL_BYTE:
+        break;
+      case GL_UNSIGNED_SHORT: case GL_SHORT: case GL_HALF_FLOAT:
+        pixel_size = components * 2; break;
+      case GL_UNSIGNED_INT: case GL_INT: case GL_FLOAT:
+        pixel_size = components * 4; break;
+      case GL_UNSIGNED_BYTE_3_3_2: case GL_UNSIGNED_BYTE_2_3_3_REV:
+        pixel_size = 1; break;
+      case GL_UNSIGNED_SHORT_5_6_5: case GL_UNSIGNED_SHORT_5_6_5_REV:
+      case GL_UNSIGNED_SHORT_4_4_4_4: case GL_UNSIGNED_SHORT_4_4_4_4_REV:
+      case GL_UNSIGNED_SHORT_5_5_5_1: case GL_UNSIGNED_SHORT_1_5_5_5_REV:
+        pixel_size = 2; break;
+      case GL_FLOAT_32_UNSIGNED_INT_24_8_REV:
+        pixel_size = 8; break;
+      // remaining packed formats
+      default:
+        pixel_size = 4; break;
+    }
+    GLint alignment = 4;
+    glGetIntegerv(alignment_name, &alignment);
+    std::size_t row_size = std::size_t(width) * pixel_size;
+    row_size = (row_size + std::size_t(alignment) - 1) / std::size_t(alignment) * std::size_t(alignment);
+    return row_size * std::size_t(height) * std::size_t(depth);
+  }
+
+  // pixels read from client memory, offset if unpack buffer is bound
+  payload unpack_image(call_arguments const& args, std::size_t index, GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type) {
+    GLint unpack_buffer = 0;
+    glGetIntegerv(GL_PIXEL_UNPACK_BUFFER_BINDING, &unpack_buffer);
+    if (unpack_buffer != 0) {
+      return payload{index, payload_type::keep, nullptr, 0};
+    }
+    return args.data(index, image_size(width, height, depth, format, type, GL_UNPACK_ALIGNMENT));
+  }
+
+  // pixels written to client memory, offset if pack buffer is bound
+  payload pack_image(std::size_t index, GLsizei width, GLsizei height, GLenum format, GLenum type) {
+    GLint pack_buffer = 0;
+    glGetIntegerv(GL_PIXEL_PACK_BUFFER_BINDING, &pack_buffer);
+    if (pack_buffer != 0) {
+      return payload{index, payload_type::keep, nullptr, 0};
+    }
+    return payload{index, payload_type::scratch, nullptr, image_size(width, height, 1, format, type, GL_PACK_ALIGNMENT)};
+  }
+
+  template<std::size_t INDEX>
+  void keep_pointer(call_arguments const&, std::vector<payload>& result) {
+    result.push_back(payload{INDEX, payload_type::keep, nullptr, 0});
+  }
+
+  template<std::size_t INDEX>
+  void sync_object(call_arguments const&, std::vector<payload>& result) {
+    result.push_back(payload{INDEX, payload_type::sync, nullptr, 0});
+  }
+
+  template<std::size_t INDEX>
+  void string_argument(call_arguments const& args, std::vector<payload>& result) {
+    result.push_back(args.string(INDEX));
+  }
+
+  // glUniform*v with COMPONENTS values per element
+  template<std::size_t COMPONENTS>
+  void uniform_vector(call_arguments const& args, std::vector<payload>& result) {
+    result.push_back(args.data(2, std::size_t(args.get<GLsizei>(1)) * COMPONENTS * 4));
+  }
+
+  // glUniformMatrix*fv with COMPONENTS floats per matrix
+  template<std::size_t COMPONENTS>
+  void uniform_matrix(call_arguments const& args, std::vector<payload>& result) {
+    result.push_back(args.data(3, std::size_t(args.get<GLsizei>(1)) * COMPONENTS * 4));
+  }
+
+  // glDelete*(n, names) and glDrawBuffers(n, buffers)
+  void input_names(call_arguments const& args, std::vector<payload>& result) {
+    result.push_back(args.data(1, std::size_t(args.get<GLsizei>(0)) * 4));
+  }
+
+  // glGen*(n, names), names are compared at replay
+  void output_names(call_arguments const& args, std::vector<payload>& result) {
+    result.push_back(payload{1, payload_type::names, args.get<GLuint const*>(1), std::size_t(args.get<GLsizei>(0)) * 4});
+  }
+
+  void register_rules() {
+    using glbinding::Binding;
+    auto& rules = payload_rules;
+
+    rules[&Binding::BufferData] = [](call_arguments const& args, std::vector<payload>& result) {
+      result.push_back(args.data(2, std::size_t(args.get<GLsizeiptr>(1))));
+    };
+    rules[&Binding::BufferSubData] = [](call_arguments const& args, std::vector<payload>& result) {
+      result.push_back(args.data(3, std::size_t(args.get<GLsizeiptr>(2))));
+    };
+    rules[&Binding::TexImage2D] = [](call_arguments const& args, std::vector<payload>& result) {
+      result.push_back(unpack_image(args, 8, args.get<GLsizei>(3), args.get<GLsizei>(4), 1, args.get<GLenum>(6), args.get<GLenum>(7)));
+    };
+    rules[&Binding::TexSubImage2D] = [](call_arguments const& args, std::vector<payload>& result) {
+      result.push_back(unpack_image(args, 8, args.get<GLsizei>(4), args.get<GLsizei>(5), 1, args.get<GLenum>(6), args.get<GLenum>(7)));
+    };
+    rules[&Binding::TexImage3D] = [](call_arguments const& args, std::vector<payload>& result) {
+      result.push_back(unpack_image(args, 9, args.get<GLsizei>(3), args.get<GLsizei>(4), args.get<GLsizei>(5), args.get<GLenum>(7), args.get<GLenum>(8)));
+    };
+    rules[&Binding::TexSubImage3D] = [](call_arguments const& args, std::vector<payload>& result) {
+      result.push_back(unpack_image(args, 10, args.get<GLsizei>(5), args.get<GLsizei>(6), args.get<GLsizei>(7), args.get<GLenum>(8), args.get<GLenum>(9)));
+    };
+    rules[&Binding::CompressedTexImage2D] = [](call_arguments const& args, std::vector<payload>& result) {
+      result.push_back(args.data(7, std::size_t(args.get<GLsizei>(6))));
+    };
+    rules[&Binding::CompressedTexSubImage2D] = [](call_arguments const& args, std::vector<payload>& result) {
+      result.push_back(args.data(8, std::size_t(args.get<GLsizei>(7))));
+    };
+    rules[&Binding::CompressedTexImage3D] = [](call_arguments const& args, std::vector<payload>& result) {
+      result.push_back(args.data(8, std::size_t(args.get<GLsizei>(7))));
+    };
+    rules[&Binding::CompressedTexSubImage3D] = [](call_arguments const& args, std::vector<payload>& result) {
+      result.push_back(args.data(10, std::size_t(args.get<GLsizei>(9))));
+    };
+    rules[&Binding::ReadPixels] = [](call_arguments const& args, std::vector<payload>& result) {
+      result.push_back(pack_image(6, args.get<GLsizei>(2), args.get<GLsizei>(3), args.get<GLenum>(4), args.get<GLenum>(5)));
+    };
+    rules[&Binding::GetTexImage] = [](call_arguments const& args, std::vector<payload>& result) {
+      GLint width = 0;
+      GLint height = 0;
+      GLint depth = 0;
+      glGetTexLevelParameteriv(args.get<GLenum>(0), args.get<GLint>(1), GL_TEXTURE_WIDTH, &width);
+      glGetTexLevelParameteriv(args.get<GLenum>(0), args.get<GLint>(1), GL_TEXTURE_HEIGHT, &height);
+      glGetTexLevelParameteriv(args.get<GLenum>(0), args.get<GLint>(1), GL_TEXTURE_DEPTH, &depth);
+      payload image = pack_image(4, width, height * depth, args.get<GLenum>(2), args.get<GLenum>(3));
+      result.push_back(image);
+    };
+
+    rules[&Binding::Uniform1fv] = uniform_vector<1>;
+    rules[&Binding::Uniform2fv] = uniform_vector<2>;
+    rules[&Binding::Uniform3fv] = uniform_vector<3>;
+    rules[&Binding::Uniform4fv] = uniform_vector<4>;
+    rules[&Binding::Uniform1iv] = uniform_vector<1>;
+    rules[&Binding::Uniform2iv] = uniform_vector<2>;
+    rules[&Binding::Uniform3iv] = uniform_vector<3>;
+    rules[&Binding::Uniform4iv] = uniform_vector<4>;
+    rules[&Binding::Uniform1uiv] = uniform_vector<1>;
+    rules[&Binding::Uniform2uiv] = uniform_vector<2>;
+    rules[&Binding::Uniform3uiv] = uniform_vector<3>;
+    rules[&Binding::Uniform4uiv] = uniform_vector<4>;
+    rules[&Binding::VertexAttrib4fv] = [](call_arguments const& args, std::vector<payload>& result) {
+      result.push_back(args.data(1, 4 * 4));
+    };
+    rules[&Binding::UniformMatrix2fv] = uniform_matrix<4>;
+    rules[&Binding::UniformMatrix3fv] = uniform_matrix<9>;
+    rules[&Binding::UniformMatrix4fv] = uniform_matrix<16>;
+    rules[&Binding::UniformMatrix2x3fv] = uniform_matrix<6>;
+    rules[&Binding::UniformMatrix3x2fv] = uniform_matrix<6>;
+    rules[&Binding::UniformMatrix2x4fv] = uniform_matrix<8>;
+    rules[&Binding::UniformMatrix4x2fv] = uniform_matrix<8>;
+    rules[&Binding::UniformMatrix3x4fv] = uniform_matrix<12>;
+    rules[&Binding::UniformMatrix4x3fv] = uniform_matrix<12>;
+
+    rules[&Binding::ShaderSource] = [](call_arguments const& args, std::vector<payload>& result) {
+      GLsizei count = args.get<GLsizei>(1);
+      GLchar const* const* sources = args.get<GLchar const* const*>(2);
+      GLint const* lengths = args.get<GLint const*>(3);
+      // store as consecutive null-terminated strings
+      shader_sources.clear();
+      for (GLsizei i = 0; i < count; ++i) {
+        if (lengths && lengths[i] >= 0) {
+          shader_sources.append(sources[i], std::size_t(lengths[i]));
+        }
+        else {
+          shader_sources.append(sources[i]);
+        }
+        shader_sources.push_back('\0');
+      }
+      result.push_back(payload{2, payload_type::strings, shader_sources.data(), shader_sources.size()});
+      result.push_back(payload{3, payload_type::null, nullptr, 0});
+    };
+    rules[&Binding::GetUniformLocation] = string_argument<1>;
+    rules[&Binding::GetUniformBlockIndex] = string_argument<1>;
+    rules[&Binding::GetAttribLocation] = string_argument<1>;
+    rules[&Binding::GetFragDataLocation] = string_argument<1>;
+    rules[&Binding::BindAttribLocation] = string_argument<2>;
+    rules[&Binding::BindFragDataLocation] = string_argument<2>;
+
+    rules[&Binding::GenBuffers] = output_names;
+    rules[&Binding::GenTextures] = output_names;
+    rules[&Binding::GenVertexArrays] = output_names;
+    rules[&Binding::GenFramebuffers] = output_names;
+    rules[&Binding::GenRenderbuffers] = output_names;
+    rules[&Binding::GenQueries] = output_names;
+    rules[&Binding::GenSamplers] = output_names;
+    rules[&Binding::DeleteBuffers] = input_names;
+    rules[&Binding::DeleteTextures] = input_names;
+    rules[&Binding::DeleteVertexArrays] = input_names;
+    rules[&Binding::DeleteFramebuffers] = input_names;
+    rules[&Binding::DeleteRenderbuffers] = input_names;
+    rules[&Binding::DeleteQueries] = input_names;
+    rules[&Binding::DeleteSamplers] = input_names;
+    rules[&Binding::DrawBuffers] = input_names;
+    rules[&Binding::MultiDrawArrays] = [](call_arguments const& args, std::vector<payload>& result) {
+      std::size_t size = std::size_t(args.get<GLsizei>(3)) * 4;
+      result.push_back(args.data(1, size));
+      result.push_back(args.data(2, size));
+    };
+
+    // offsets into bound buffers
+    rules[&Binding::VertexAttribPointer] = keep_pointer<5>;
+    rules[&Binding::VertexAttribIPointer] = keep_pointer<4>;
+    rules[&Binding::DrawElements] = keep_pointer<3>;
+    rules[&Binding::DrawElementsInstanced] = keep_pointer<3>;
+    rules[&Binding::DrawElementsBaseVertex] = keep_pointer<3>;
+    rules[&Binding::DrawRangeElements] = keep_pointer<5>;
+
+    rules[&Binding::ClientWaitSync] = sync_object<0>;
+    rules[&Binding::WaitSync] = sync_object<0>;
+    rules[&Binding::DeleteSync] = sync_object<0>;
+    rules[&Binding::IsSync] = sync_object<0>;
+    rules[&Binding::GetSynciv] = sync_object<0>;
+
+    // remember written ranges, content is captured before unmapping
+    rules[&Binding::MapBuffer] = [](call_arguments const& args, std::vector<payload>&) {
+      void const* pointer = *static_cast<void* const*>(args.record.returnValue);
+      if (!pointer || args.get<GLenum>(1) == GL_READ_ONLY) return;
+      GLint size = 0;
+      glGetBufferParameteriv(args.get<GLenum>(0), GL_BUFFER_SIZE, &size);
+      mappings[args.get<GLenum>(0)] = mapping{pointer, std::size_t(size)};
+    };
+    rules[&Binding::MapBufferRange] = [](call_arguments const& args, std::vector<payload>&) {
+      void const* pointer = *static_cast<void* const*>(args.record.returnValue);
+      if (!pointer || !(args.get<std::uint32_t>(3) & std::uint32_t(GL_MAP_WRITE_BIT))) return;
+      mappings[args.get<GLenum>(0)] = mapping{pointer, std::size_t(args.get<GLsizeiptr>(2))};
+    };
+
+    skipped_functions = {
+      &Binding::DebugMessageCallback,
+      &Binding::DebugMessageCallbackARB,
+      &Binding::DebugMessageCallbackAMD,
+    };
+  }
+
+  void write_payload(call_arguments const& args, payload const& p) {
+    write(std::uint16_t(args.offset(p.argument)));
+    write(p.type);
+    write(std::uint32_t(p.size));
+    // scratch only stores the required size
+    if (p.type == payload_type::data || p.type == payload_type::strings || p.type == payload_type::names) {
+      write_bytes(p.data, p.size);
+    }
+  }
+
+  void record_call(glbinding::CallRecord const& record) {
+    if (in_callback || skipped_functions.count(record.function) > 0) return;
+    in_callback = true;
+
+    auto const& signature = record.signature;
+    packed_arguments.resize(signature.argumentsSize);
+    record.writeArguments(packed_arguments.data());
+    call_arguments args{record, packed_arguments.data()};
+
+    payloads.clear();
+    auto rule = payload_rules.find(record.function);
+    if (rule != payload_rules.end()) {
+      rule->second(args, payloads);
+    }
+    // remaining pointers are outputs of unknown size
+    for (std::size_t i = 0; i < signature.argumentCount; ++i) {
+      if (!(signature.pointerArguments & (1u << i))) continue;
+      bool handled = false;
+      for (auto const& p : payloads) {
+        handled = handled || p.argument == i;
+      }
+      if (!handled && args.get<void const*>(i)) {
+        payloads.push_back(payload{i, payload_type::scratch, nullptr, 0});
+      }
+    }
+    std::uint8_t payload_count = 0;
+    for (auto const& p : payloads) {
+      if (p.type != payload_type::keep) ++payload_count;
+    }
+
+    write(record_kind::call);
+    write(function_indices.at(record.function));
+    write(payload_count);
+    write(std::uint8_t(signature.returnValueSize));
+    write(std::uint16_t(signature.argumentsSize));
+    write_bytes(packed_arguments.data(), packed_arguments.size());
+    buffer.resize(buffer.size() + signature.returnValueSize);
+    record.writeReturnValue(buffer.data() + buffer.size() - signature.returnValueSize);
+    for (auto const& p : payloads) {
+      if (p.type != payload_type::keep) {
+        write_payload(args, p);
+      }
+    }
+
+    if (buffer.size() > FLUSH_SIZE) {
+      flush();
+    }
+    in_callback = false;
+  }
+
+  // before glUnmapBuffer, captures content written by application
+  void record_buffer_data(GLenum target) {
+    auto iter = mappings.find(target);
+    if (!is_active || in_callback || iter == mappings.end()) return;
+
+    write(record_kind::buffer_data);
+    write(std::uint32_t(target));
+    write(std::uint32_t(iter->second.size));
+    write_bytes(iter->second.pointer, iter->second.size);
+    mappings.erase(iter);
+  }
+
+  template<typename T>
+  T read(std::vector<unsigned char> const& data, std::size_t& position) {
+    if (position + sizeof(T) > data.size()) {
+      throw std::runtime_error("Trace is truncated");
+    }
+    T value;
+    std::memcpy(&value, data.data() + position, sizeof(T));
+    position += sizeof(T);
+    return value;
+  }
+
+  // replacement read from trace
+  struct replay_payload {
+    std::size_t offset;
+    payload_type type;
+    unsigned char const* data;
+    std::size_t size;
+    // start of assigned scratch memory
+    std::size_t scratch_offset;
+  };
+
+  // reused per replayed call
+  std::vector<replay_payload> replay_payloads{};
+}
+
+void start(std::string const& path) {
+  if (is_active) return;
+
+  file.open(path, std::ios::binary);
+  if (!file) {
+    throw std::runtime_error("Could not open trace file " + path);
+  }
+  register_rules();
+  auto const& functions = glbinding::Binding::functions();
+  for (std::size_t i = 0; i < functions.size(); ++i) {
+    function_indices[functions[i]] = std::uint16_t(i);
+  }
+
+  header head{};
+  std::memcpy(head.magic, MAGIC, sizeof(MAGIC));
+  head.version = VERSION;
+  head.function_count = std::uint32_t(functions.size());
+  head.pointer_size = sizeof(void*);
+  write(head);
+  frame_count = 0;
+
+  glbinding::setCallbackMask(glbinding::CallbackMask::Record);
+  glbinding::setRecordCallback(record_call);
+  // written buffer content is lost after unmapping
+  glbinding::Binding::UnmapBuffer.addCallbackMask(glbinding::CallbackMask::Before);
+  glbinding::Binding::UnmapBuffer.setBeforeCallback(record_buffer_data);
+  is_active = true;
+}
+
+void stop() {
+  if (!is_active) return;
+  is_active = false;
+
+  glbinding::setCallbackMask(glbinding::CallbackMask::None);
+  glbinding::Binding::UnmapBuffer.clearBeforeCallback();
+  glbinding::setRecordCallback(nullptr);
+  flush();
+  // fill in frame count
+  file.seekp(std::streamoff(offsetof(header, frame_count)));
+  file.write(reinterpret_cast<char const*>(&frame_count), sizeof(frame_count));
+  file.close();
+  mappings.clear();
+}
+
+bool active() {
+  return is_active;
+}
+
+void frame() {
+  if (!is_active) return;
+
+  write(record_kind::frame);
+  ++frame_count;
+}
+
+///////////////////////////// replay ////////////////////////////////
+player::player(std::string const& path)
+ :m_data{}
+ ,m_position{0}
+ ,m_frames{0}
+ ,m_stats{}
+ ,m_arguments{}
+ ,m_scratch{}
+ ,m_strings{}
+ ,m_syncs{}
+{
+  std::ifstream in{path, std::ios::binary};
+  if (!in) {
+    throw std::runtime_error("Could not open trace file " + path);
+  }
+  m_data.assign(std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{});
+
+  header head = read<header>(m_data, m_position);
+  if (std::memcmp(head.magic, MAGIC, sizeof(MAGIC)) != 0 || head.version != VERSION) {
+    throw std::runtime_error(path + " is no trace of version " + std::to_string(VERSION));
+  }
+  if (head.function_count != glbinding::Binding::functions().size() || head.pointer_size != sizeof(void*)) {
+    throw std::runtime_error(path + " was captured with a different glbinding or platform");
+  }
+  m_frames = head.frame_count;
+}
+
+unsigned player::frames() const {
+  return m_frames;
+}
+
+replay_stats const& player::stats() const {
+  return m_stats;
+}
+
+bool player::play_frame() {
+  while (m_position < m_data.size()) {
+    auto kind = read<record_kind>(m_data, m_position);
+    if (kind == record_kind::call) {
+      play_call();
+    }
+    else if (kind == record_kind::buffer_data) {
+      play_buffer_data();
+    }
+    else if (kind == record_kind::frame) {
+      return true;
+    }
+    else {
+      throw std::runtime_error("Invalid record in trace");
+    }
+  }
+  return false;
+}
+
+void player::play_call() {
+  auto index = read<std::uint16_t>(m_data, m_position);
+  auto payload_count = read<std::uint8_t>(m_data, m_position);
+  auto return_size = read<std::uint8_t>(m_data, m_position);
+  auto arguments_size = read<std::uint16_t>(m_data, m_position);
+  if (index >= glbinding::Binding::functions().size()
+   || m_position + arguments_size + return_size > m_data.size()) {
+    throw std::runtime_error("Invalid call in trace");
+  }
+  m_arguments.assign(m_data.begin() + std::ptrdiff_t(m_position), m_data.begin() + std::ptrdiff_t(m_position + arguments_size));
+  m_position += arguments_size;
+  unsigned char const* captured_return = m_data.data() + m_position;
+  m_position += return_size;
+
+  // read payloads and assign scratch memory
+  replay_payloads.clear();
+  std::size_t scratch_size = 0;
+  for (std::uint8_t i = 0; i < payload_count; ++i) {
+    replay_payload p{};
+    p.offset = read<std::uint16_t>(m_data, m_position);
+    p.type = read<payload_type>(m_data, m_position);
+    p.size = read<std::uint32_t>(m_data, m_position);
+    if (p.type == payload_type::data || p.type == payload_type::strings || p.type == payload_type::names) {
+      if (m_position + p.size > m_data.size()) {
+        throw std::runtime_error("Trace is truncated");
+      }
+      p.data = m_data.data() + m_position;
+      m_position += p.size;
+      m_stats.payload_bytes += p.size;
+    }
+    if (p.type == payload_type::scratch || p.type == payload_type::names) {
+      p.scratch_offset = scratch_size;
+      scratch_size += std::max(p.size, SCRATCH_SIZE);
+    }
+    replay_payloads.push_back(p);
+  }
+  if (m_scratch.size() < scratch_size) {
+    m_scratch.resize(scratch_size);
+  }
+
+  // patch pointer arguments
+  m_strings.clear();
+  for (auto const& p : replay_payloads) {
+    void const* pointer = nullptr;
+    if (p.type == payload_type::data) {
+      pointer = p.data;
+    }
+    else if (p.type == payload_type::scratch || p.type == payload_type::names) {
+      pointer = m_scratch.data() + p.scratch_offset;
+    }
+    else if (p.type == payload_type::strings) {
+      char const* begin = reinterpret_cast<char const*>(p.data);
+      for (char const* c = begin; c < begin + p.size; c += std::strlen(c) + 1) {
+        m_strings.push_back(c);
+      }
+      pointer = m_strings.data();
+    }
+    else if (p.type == payload_type::sync) {
+      std::uint64_t captured = 0;
+      std::memcpy(&captured, m_arguments.data() + p.offset, sizeof(GLsync));
+      pointer = m_syncs[captured];
+    }
+    std::memcpy(m_arguments.data() + p.offset, &pointer, sizeof(pointer));
+  }
+
+  auto function = glbinding::Binding::functions()[index];
+  if (!function->isResolved()) return;
+  unsigned char return_value[16] = {};
+  function->replay(m_arguments.data(), return_value);
+  ++m_stats.calls;
+
+  // names are only equal if driver allocates them deterministically
+  for (auto const& p : replay_payloads) {
+    if (p.type == payload_type::names && std::memcmp(p.data, m_scratch.data() + p.scratch_offset, p.size) != 0) {
+      ++m_stats.name_mismatches;
+    }
+  }
+  if (function == &glbinding::Binding::CreateProgram || function == &glbinding::Binding::CreateShader) {
+    if (std::memcmp(captured_return, return_value, return_size) != 0) {
+      ++m_stats.name_mismatches;
+    }
+  }
+  else if (function == &glbinding::Binding::FenceSync) {
+    std::uint64_t captured = 0;
+    std::memcpy(&captured, captured_return, sizeof(GLsync));
+    std::memcpy(&m_syncs[captured], return_value, sizeof(GLsync));
+  }
+}
+
+void player::play_buffer_data() {
+  auto target = GLenum(read<std::uint32_t>(m_data, m_position));
+  auto size = read<std::uint32_t>(m_data, m_position);
+  if (m_position + size > m_data.size()) {
+    throw std::runtime_error("Trace is truncated");
+  }
+  void* pointer = nullptr;
+  glGetBufferPointerv(target, GL_BUFFER_MAP_POINTER, &pointer);
+  if (pointer) {
+    std::memcpy(pointer, m_data.data() + m_position, size);
+  }
+  m_position += size;
+  m_stats.payload_bytes += size;
+}
+
+};
@@ -0,0 +1,141 @@
+#include "gpu_profiler.hpp"
+
+#include <glbinding/gl/gl.h>
+// use gl definitions from glbinding
+using namespace gl;
+
+#include <algorithm>
+#include <map>
+
+namespace gpu_profiler {
+
+namespace {
+  // queries and rolling statistics of one scope
+  struct timer {
+    timer(std::string const& n)
+     :name{n}
+     ,queries{}
+     ,pending{}
+     ,history{}
+     ,history_size{0}
+     ,history_index{0}
+    {
+      // begin and end timestamp for each frame in flight
+      glGenQueries(GLsizei(FRAMES_IN_FLIGHT * 2), &queries[0][0]);
+    }
+
+    std::string name;
+    GLuint queries[FRAMES_IN_FLIGHT][2];
+    // whether queries of frame slot were issued
+    bool pending[FRAMES_IN_FLIGHT];
+    // ring buffer of last measured durations in ms
+    double history[HISTORY_LENGTH];
+    unsigned history_size;
+    unsigned history_index;
+  };
+
+  bool is_active = false;
+  // index of current frame slot
+  unsigned frame_slot = 0;
+  std::vector<timer> timers{};
+  // timer index for each name
+  std::map<std::string, std::size_t> timer_indices{};
+  // indices of currently open scopes
+  std::vector<std::size_t> open_scopes{};
+}
+
+void initialize() {
+  is_active = true;
+  frame_slot = 0;
+}
+
+void release() {
+  for (auto& t : timers) {
+    glDeleteQueries(GLsizei(FRAMES_IN_FLIGHT * 2), &t.queries[0][0]);
+  }
+  timers.clear();
+  timer_indices.clear();
+  open_scopes.clear();
+  is_active = false;
+}
+
+bool active() {
+  return is_active;
+}
+
+void begin(std::string const& name) {
+  if (!is_active) return;
+
+  auto iter = timer_indices.find(name);
+  if (iter == timer_indices.end()) {
+    iter = timer_indices.emplace(name, timers.size()).first;
+    timers.emplace_back(name);
+  }
+  std::size_t index = iter->second;
+
+  glQueryCounter(timers[index].queries[frame_slot][0], GL_TIMESTAMP);
+  open_scopes.push_back(index);
+}
+
+void end() {
+  if (!is_active || open_scopes.empty()) return;
+
+  timer& t = timers[open_scopes.back()];
+  open_scopes.pop_back();
+
+  glQueryCounter(t.queries[frame_slot][1], GL_TIMESTAMP);
+  t.pending[frame_slot] = true;
+}
+
+void frame() {
+  if (!is_active) return;
+  // oldest slot is reused next frame, read its results now
+  unsigned oldest_slot = (frame_slot + 1) % FRAMES_IN_FLIGHT;
+
+  for (auto& t : timers) {
+    if (!t.pending[oldest_slot]) continue;
+    t.pending[oldest_slot] = false;
+
+    // never wait for results, drop sample if gpu is too far behind
+    GLint available = 0;
+    glGetQueryObjectiv(t.queries[oldest_slot][1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) continue;
+
+    GLuint64 start = 0;
+    GLuint64 stop = 0;
+    glGetQueryObjectui64v(t.queries[oldest_slot][0], GL_QUERY_RESULT, &start);
+    glGetQueryObjectui64v(t.queries[oldest_slot][1], GL_QUERY_RESULT, &stop);
+
+    // timestamps are in nanoseconds
+    t.history[t.history_index] = double(stop - start) * 1.0e-6;
+    t.history_index = (t.history_index + 1) % HISTORY_LENGTH;
+    t.history_size = std::min(t.history_size + 1, HISTORY_LENGTH);
+  }
+
+  frame_slot = oldest_slot;
+}
+
+std::vector<result> results() {
+  std::vector<result> stats{};
+  for (auto const& t : timers) {
+    result res{t.name, 0.0, 0.0, t.history_size};
+    for (unsigned i = 0; i < t.history_size; ++i) {
+      res.average_ms += t.history[i];
+      res.max_ms = std::max(res.max_ms, t.history[i]);
+    }
+    if (t.history_size > 0) {
+      res.average_ms /= double(t.history_size);
+    }
+    stats.push_back(res);
+  }
+  return stats;
+}
+
+void print(std::ostream& os) {
+  for (auto const& res : results()) {
+    os << "GPU " << res.name << " - avg " << res.average_ms
+       << " ms, max " << res.max_ms << " ms" << std::endl;
+  }
+}
+
+};
@@ -0,0 +1,133 @@
+#include "instance_batch.hpp"
+
+#include "gl_state.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+instance_batch::instance_batch()
+ :m_buffer{0}
+ ,m_capacity{0}
+ ,m_instances{}
+ ,m_entries{}
+ ,m_sorted{}
+{}
+
+instance_batch::~instance_batch() {
+  if (m_buffer != 0) {
+    gl_state::delete_buffers(1, &m_buffer);
+  }
+}
+
+void instance_batch::add(body_instance const& instance, texture_object const& diffuse, texture_object const& normal,
+                         std::size_t lod) {
+  m_entries.push_back(entry{diffuse, normal, lod, m_instances.size()});
+  m_instances.push_back(instance);
+}
+
+void instance_batch::clear() {
+  m_instances.clear();
+  m_entries.clear();
+}
+
+std::size_t instance_batch::size() const {
+  return m_instances.size();
+}
+
+void instance_batch::set_attribute_pointers(std::size_t first) const {
+  GLsizei stride = GLsizei(sizeof(body_instance));
+  std::uintptr_t base = first * sizeof(body_instance);
+  // matrices occupy one location per column
+  for (GLuint column = 0; column < 4; ++column) {
+    glVertexAttribPointer(FIRST_LOCATION + column, 4, GL_FLOAT, GL_FALSE, stride,
+                          reinterpret_cast<GLvoid*>(base + offsetof(body_instance, model_matrix) + column * sizeof(glm::fvec4)));
+  }
+  for (GLuint column = 0; column < 3; ++column) {
+    glVertexAttribPointer(FIRST_LOCATION + 4 + column, 3, GL_FLOAT, GL_FALSE, stride,
+                          reinterpret_cast<GLvoid*>(base + offsetof(body_instance, normal_matrix) + column * sizeof(glm::fvec3)));
+  }
+  glVertexAttribPointer(FIRST_LOCATION + 7, 3, GL_FLOAT, GL_FALSE, stride,
+                        reinterpret_cast<GLvoid*>(base + offsetof(body_instance, color)));
+  glVertexAttribIPointer(FIRST_LOCATION + 8, 1, GL_INT, stride,
+                         reinterpret_cast<GLvoid*>(base + offsetof(body_instance, flags)));
+  glVertexAttribIPointer(FIRST_LOCATION + 9, 1, GL_INT, stride,
+                         reinterpret_cast<GLvoid*>(base + offsetof(body_instance, layer)));
+  glVertexAttribIPointer(FIRST_LOCATION + 10, 1, GL_INT, stride,
+                         reinterpret_cast<GLvoid*>(base + offsetof(body_instance, normal_layer)));
+}
+
+std::size_t instance_batch::draw(model_object const& object) {
+  if (m_instances.empty()) return 0;
+
+  // group instances with equal textures and level
+  std::sort(m_entries.begin(), m_entries.end(), [](entry const& a, entry const& b) {
+    if (a.diffuse.handle != b.diffuse.handle) return a.diffuse.handle < b.diffuse.handle;
+    if (a.normal.handle != b.normal.handle) return a.normal.handle < b.normal.handle;
+    if (a.lod != b.lod) return a.lod < b.lod;
+    return a.instance < b.instance;
+  });
+  m_sorted.clear();
+  for (auto const& current : m_entries) {
+    m_sorted.push_back(m_instances[current.instance]);
+  }
+
+  gl_state::bind_vertex_array(object.vertex_AO);
+  if (m_buffer == 0) {
+    glGenBuffers(1, &m_buffer);
+  }
+  gl_state::bind_buffer(GL_ARRAY_BUFFER, m_buffer);
+  // orphan storage of last frame instead of waiting until it is read
+  std::size_t bytes = m_sorted.size() * sizeof(body_instance);
+  if (bytes > m_capacity) {
+    m_capacity = bytes;
+    glBufferData(GL_ARRAY_BUFFER, GLsizeiptr(m_capacity), m_sorted.data(), GL_STREAM_DRAW);
+  }
+  else {
+    glBufferData(GL_ARRAY_BUFFER, GLsizeiptr(m_capacity), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, GLsizeiptr(bytes), m_sorted.data());
+  }
+  for (GLuint location = FIRST_LOCATION; location < FIRST_LOCATION + 11; ++location) {
+    glEnableVertexAttribArray(location);
+    glVertexAttribDivisor(location, 1);
+  }
+
+  std::uintptr_t index_bytes = object.index_type == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+  std::size_t draws = 0;
+  GLuint bound_diffuse = 0;
+  GLuint bound_normal = 0;
+  for (std::size_t begin = 0; begin < m_entries.size();) {
+    entry const& group = m_entries[begin];
+    std::size_t end = begin + 1;
+    while (end < m_entries.size() && m_entries[end].diffuse.handle == group.diffuse.handle
+        && m_entries[end].normal.handle == group.normal.handle && m_entries[end].lod == group.lod) {
+      ++end;
+    }
+
+    if (group.diffuse.handle != bound_diffuse) {
+      gl_state::active_texture(GL_TEXTURE0);
+      gl_state::bind_texture(group.diffuse.target, group.diffuse.handle);
+      bound_diffuse = group.diffuse.handle;
+    }
+    if (group.normal.handle != bound_normal && group.normal.handle != 0) {
+      gl_state::active_texture(GL_TEXTURE1);
+      gl_state::bind_texture(group.normal.target, group.normal.handle);
+      bound_normal = group.normal.handle;
+    }
+
+    lod_range range{0, object.num_elements, 0.0f};
+    if (!object.lods.empty()) {
+      range = object.lods[std::min(group.lod, object.lods.size() - 1)];
+    }
+    // no base instance in GL 3.3, attributes start at group instead
+    set_attribute_pointers(begin);
+    glDrawElementsInstanced(object.draw_mode, range.num_elements, object.index_type,
+                            reinterpret_cast<GLvoid*>(std::uintptr_t(range.first) * index_bytes), GLsizei(end - begin));
+    ++draws;
+    begin = end;
+  }
+  gl_state::active_texture(GL_TEXTURE0);
+
+  clear();
+  return draws;
+}
@@ -3,8 +3,6 @@
 #include <glbinding/gl/gl.h>
 // load glbinding extensions
 #include <glbinding/Binding.h>
-// load meta info extension
-#include <glbinding/Meta.h>
 
 //dont load gl bindings from glfw
 #define GLFW_INCLUDE_NONE
@@ -17,6 +15,11 @@
 
 #include "utils.hpp"
 #include "shader_loader.hpp"
+#include "gpu_profiler.hpp"
+#include "gl_errors.hpp"
+#include "gl_trace.hpp"
+#include "gl_state.hpp"
+#include "culling.hpp"
 
 #include <cstdlib>
 #include <functional>
@@ -26,9 +29,9 @@
 using namespace gl;
 
 // helper functions
-std::string resourcePath(int argc, char* argv[]);
+launch_options parse_options(int argc, char* argv[]);
+std::string resourcePath(char* argv[]);
 void glsl_error(int error, const char* description);
-void watch_gl_errors(bool activate = true);
 
 Launcher::Launcher(int argc, char* argv[]) 
  :m_camera_fov{glm::radians(60.0f)}
@@ -37,23 +40,94 @@ Launcher::Launcher(int argc, char* argv[])
  ,m_window{nullptr}
  ,m_last_second_time{0.0}
  ,m_frames_per_second{0u}
- ,m_resource_path{resourcePath(argc, argv)}
+ ,m_options{parse_options(argc, argv)}
+ ,m_resource_path{m_options.resource_path}
+ ,m_benchmark{}
  ,m_application{}
-{}
+{
+  if (m_options.frames > 0) {
+    m_benchmark.reset(new Benchmark{m_options.frames, m_options.warmup});
+  }
+}
 
-std::string resourcePath(int argc, char* argv[]) {
-  std::string resource_path{};
-  //first argument is resource path
-  if (argc > 1) {
-    resource_path = argv[1];
+launch_options parse_options(int argc, char* argv[]) {
+  launch_options options{};
+  // read numeric value following an option
+  auto unsigned_value = [&](int& i) {
+    if (i + 1 >= argc) {
+      std::cerr << "Missing value for option " << argv[i] << std::endl;
+      std::exit(EXIT_FAILURE);
+    }
+    ++i;
+    return unsigned(std::strtoul(argv[i], nullptr, 10));
+  };
+
+  for (int i = 1; i < argc; ++i) {
+    std::string arg{argv[i]};
+    if (arg == "--headless") {
+      options.headless = true;
+    }
+    else if (arg == "--frames") {
+      options.frames = unsigned_value(i);
+    }
+    else if (arg == "--warmup") {
+      options.warmup = unsigned_value(i);
+    }
+    else if (arg == "--gl-errors") {
+      if (i + 1 >= argc) {
+        std::cerr << "Missing value for option " << arg << std::endl;
+        std::exit(EXIT_FAILURE);
+      }
+      try {
+        options.error_check = gl_errors::parse(argv[++i]);
+      }
+      catch (std::invalid_argument& e) {
+        std::cerr << e.what() << std::endl;
+        std::exit(EXIT_FAILURE);
+      }
+    }
+    else if (arg == "--profile") {
+      options.profile = true;
+    }
+    else if (arg == "--state-cache") {
+      options.state_cache = true;
+    }
+    else if (arg == "--report") {
+      if (i + 1 >= argc) {
+        std::cerr << "Missing value for option " << arg << std::endl;
+        std::exit(EXIT_FAILURE);
+      }
+      options.report_path = argv[++i];
+    }
+    else if (arg == "--trace") {
+      if (i + 1 >= argc) {
+        std::cerr << "Missing value for option " << arg << std::endl;
+        std::exit(EXIT_FAILURE);
+      }
+      options.trace_path = argv[++i];
+    }
+    else if (arg.compare(0, 2, "--") == 0) {
+      std::cerr << "Unknown option " << arg << std::endl;
+      std::exit(EXIT_FAILURE);
+    }
+    //first positional argument is resource path
+    else if (options.resource_path.empty()) {
+      options.resource_path = arg;
+    }
   }
   // no resource path specified, use default
-  else {
-    std::string exe_path{argv[0]};
-    resource_path = exe_path.substr(0, exe_path.find_last_of("/\\"));
-    resource_path += "/../../resources/";
+  if (options.resource_path.empty()) {
+    options.resource_path = resourcePath(argv);
   }
 
+  return options;
+}
+
+std::string resourcePath(char* argv[]) {
+  std::string exe_path{argv[0]};
+  std::string resource_path = exe_path.substr(0, exe_path.find_last_of("/\\"));
+  resource_path += "/../../resources/";
+
   return resource_path;
 }
 
@@ -65,9 +139,9 @@ void Launcher::initialize() {
     std::exit(EXIT_FAILURE);
   }
 
-  // set OGL version explicitly 
+  // set OGL version explicitly, 3.3 for timer queries
   glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-  glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 2);
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
   glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, true);
   //MacOS requires core profile
   #ifdef __APPLE__
@@ -75,6 +149,14 @@ void Launcher::initialize() {
   #else
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_COMPAT_PROFILE);
   #endif
+  // headless runs render into an invisible window, e.g. on Xvfb with llvmpipe
+  if (m_options.headless) {
+    glfwWindowHint(GLFW_VISIBLE, false);
+  }
+  // drivers only guarantee debug messages in debug contexts
+  if (m_options.error_check == gl_errors::tier::debug_output) {
+    glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, true);
+  }
   // create m_window, if unsuccessfull, quit
   m_window = glfwCreateWindow(m_window_width, m_window_height, "OpenGL Framework", NULL, NULL);
   if (!m_window) {
@@ -93,8 +175,10 @@ void Launcher::initialize() {
         static_cast<Launcher*>(glfwGetWindowUserPointer(w))->key_callback(w, a, b, c, d);
   };
   glfwSetKeyCallback(m_window, key_func);
-  // allow free mouse movement
-  glfwSetInputMode(m_window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+  // allow free mouse movement, invisible window cannot capture cursor
+  if (!m_options.headless) {
+    glfwSetInputMode(m_window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+  }
   auto mouse_func = [](GLFWwindow* w, double a, double b) {
         static_cast<Launcher*>(glfwGetWindowUserPointer(w))->mouse_callback(w, a, b);
   };
@@ -109,33 +193,74 @@ void Launcher::initialize() {
   // initialize glindings in this context
   glbinding::Binding::initialize();
 
-  // activate error checking after each gl function call
-  watch_gl_errors();
+  // tracing replaces the record callback used for per-call checking
+  if (!m_options.trace_path.empty() && m_options.error_check == gl_errors::tier::per_call) {
+    std::cerr << "Tracing calls, checking errors per frame" << std::endl;
+    m_options.error_check = gl_errors::tier::per_frame;
+  }
+  // activate selected error checking
+  gl_errors::activate(m_options.error_check);
+  // capture calls from application construction on
+  if (!m_options.trace_path.empty()) {
+    gl_trace::start(m_options.trace_path);
+  }
+
+  // measure render passes marked by gpu_profiler scopes
+  if (m_options.profile) {
+    gpu_profiler::initialize();
+  }
+  // filter redundant state changes
+  if (m_options.state_cache) {
+    gl_state::initialize();
+  }
 }
  
 void Launcher::mainLoop() {
+  // application construction changed state directly
+  gl_state::invalidate();
   // do before framebuffer_resize call as it requires the projection uniform location
   // throw exception if shader compilation was unsuccessfull
   update_shader_programs(true);
 
   // enable depth testing
-  glEnable(GL_DEPTH_TEST);
-  glDepthFunc(GL_LESS);
+  gl_state::enable(GL_DEPTH_TEST);
+  gl_state::depth_func(GL_LESS);
   
   // rendering loop
   while (!glfwWindowShouldClose(m_window)) {
+    if (m_benchmark) {
+      // stop after fixed number of frames
+      if (m_benchmark->finished()) {
+        break;
+      }
+      m_benchmark->beginFrame();
+    }
     // query input
     glfwPollEvents();
     // clear buffer
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     // draw geometry
     m_application->render();
+    // report errors if checking per frame
+    gl_errors::check_frame();
     // swap draw buffer to front
     glfwSwapBuffers(m_window);
+    // read back gpu timings of previous frames
+    gpu_profiler::frame();
+    gl_trace::frame();
+    gl_state::frame();
+    culling::frame();
+    if (m_benchmark) {
+      m_benchmark->endFrame();
+    }
     // display fps
     show_fps();
   }
 
+  if (m_benchmark) {
+    report_benchmark();
+  }
+
   quit(EXIT_SUCCESS);
 }
 
@@ -143,7 +268,7 @@ void Launcher::mainLoop() {
 // update viewport and field of view
 void Launcher::update_projection(GLFWwindow* m_window, int width, int height) {
   // resize framebuffer
-  glViewport(0, 0, width, height);
+  gl_state::viewport(0, 0, width, height);
 
   float aspect = float(width) / float(height);
   float fov_y = m_camera_fov;
@@ -167,9 +292,11 @@ void Launcher::update_shader_programs(bool throwing) {
       GLuint new_program = shader_loader::program(pair.second.vertex_path,
                                                   pair.second.fragment_path);
       // free old shader program
-      glDeleteProgram(pair.second.handle);
+      gl_state::delete_program(pair.second.handle);
       // save new shader program
       pair.second.handle = new_program;
+      // refresh active uniforms, handles notice the new generation
+      shader_loader::reflect(pair.second);
     }
   };
 
@@ -220,16 +347,38 @@ void Launcher::show_fps() {
   if (current_time - m_last_second_time >= 1.0) {
     std::string title{"OpenGL Framework - "};
     title += std::to_string(m_frames_per_second) + " fps";
+    // objects of last frame that passed frustum culling
+    culling::counters culled = culling::last_frame();
+    title += ", " + std::to_string(culled.visible) + " of " + std::to_string(culled.tested) + " visible";
 
     glfwSetWindowTitle(m_window, title.c_str());
+    // periodic dump of pass timings
+    if (gpu_profiler::active()) {
+      gpu_profiler::print(std::cout);
+    }
+    if (gl_state::active()) {
+      gl_state::print(std::cout);
+    }
     m_frames_per_second = 0;
     m_last_second_time = current_time;
   }
 }
 
+void Launcher::report_benchmark() {
+  m_benchmark->print(std::cout);
+  culling::print(std::cout);
+  if (!m_options.report_path.empty()) {
+    m_benchmark->writeReport(m_options.report_path);
+    std::cout << "Report written to " << m_options.report_path << std::endl;
+  }
+}
+
 void Launcher::quit(int status) {
   // free opengl resources
   delete m_application;
+  gpu_profiler::release();
+  gl_state::release();
+  gl_trace::stop();
   // free glfw resources
   glfwDestroyWindow(m_window);
   glfwTerminate();
@@ -241,39 +390,3 @@ void Launcher::quit(int status) {
 void glsl_error(int error, const char* description) {
   std::cerr << "GLSL Error " << error << " : "<< description << std::endl;
 }
-
-void watch_gl_errors(bool activate) {
-  if(activate) {
-    // add callback after each function call
-    glbinding::setCallbackMaskExcept(glbinding::CallbackMask::After | glbinding::CallbackMask::ParametersAndReturnValue, {"glGetError", "glBegin", "glVertex3f", "glColor3f"});
-    glbinding::setAfterCallback(
-      [](glbinding::FunctionCall const& call) {
-        GLenum error = glGetError();
-        if (error != GL_NO_ERROR) {
-          // print name
-          std::cerr <<  "OpenGL Error: " << call.function->name() << "(";
-          // parameters
-          for (unsigned i = 0; i < call.parameters.size(); ++i)
-          {
-            std::cerr << call.parameters[i]->asString();
-            if (i < call.parameters.size() - 1)
-              std::cerr << ", ";
-          }
-          std::cerr << ")";
-          // return value
-          if(call.returnValue) {
-            std::cerr << " -> " << call.returnValue->asString();
-          }
-          // error
-          std::cerr  << " - " << glbinding::Meta::getString(error) << std::endl;
-          // throw exception to allow for backtrace
-          throw std::runtime_error("Execution of " + std::string(call.function->name()));
-          exit(EXIT_FAILURE);
-        }
-      }
-    );
-  }
-  else {
-    glbinding::setCallbackMask(glbinding::CallbackMask::None);
-  }
-}
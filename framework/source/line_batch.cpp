@@ -0,0 +1,240 @@
+#include "line_batch.hpp"
+
+#include "gl_state.hpp"
+
+#include <glbinding/gl/gl.h>
+// use gl definitions from glbinding
+using namespace gl;
+
+#include <glm/common.hpp>
+#include <glm/gtc/constants.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace {
+  // number of circle levels from MIN_SEGMENTS to MAX_SEGMENTS
+  const std::size_t LEVEL_NUM = 6;
+  // bytes per frame of the vertex ring at first draw
+  const GLsizeiptr INITIAL_RING_SIZE = GLsizeiptr(1) << 18;
+
+  glm::u8vec4 quantize(glm::fvec4 const& color) {
+    return glm::u8vec4{glm::clamp(color, 0.0f, 1.0f) * 255.0f + 0.5f};
+  }
+
+  std::size_t level_of(unsigned segments) {
+    std::size_t level = 0;
+    while (level + 1 < LEVEL_NUM && (line_batch::MIN_SEGMENTS << level) < segments) {
+      ++level;
+    }
+    return level;
+  }
+}
+
+line_batch::line_batch()
+ :m_stream_array{0}
+ ,m_circle_array{0}
+ ,m_circle_buffer{0}
+ ,m_ring{}
+ ,m_lines{}
+ ,m_points{}
+ ,m_circles(LEVEL_NUM)
+ ,m_sorted{}
+{}
+
+line_batch::~line_batch() {
+  if (m_stream_array != 0) {
+    gl_state::delete_buffers(1, &m_circle_buffer);
+    GLuint arrays[] = {m_stream_array, m_circle_array};
+    gl_state::delete_vertex_arrays(2, arrays);
+  }
+}
+
+unsigned line_batch::segments(float radius_pixels, float tolerance) {
+  if (!(radius_pixels > tolerance)) return MIN_SEGMENTS;
+  // a chord deviates from its arc by r * (1 - cos(pi / n))
+  float needed = glm::pi<float>() / std::acos(1.0f - tolerance / radius_pixels);
+  unsigned result = MIN_SEGMENTS;
+  while (result < MAX_SEGMENTS && float(result) < needed) {
+    result *= 2;
+  }
+  return result;
+}
+
+void line_batch::add_line(glm::fvec3 const& a, glm::fvec3 const& b, glm::fvec4 const& color) {
+  glm::u8vec4 packed = quantize(color);
+  m_lines.push_back(line_vertex{a, packed});
+  m_lines.push_back(line_vertex{b, packed});
+}
+
+void line_batch::add_strip(glm::fvec3 const* points, std::size_t num, glm::fvec4 const& color, bool closed) {
+  if (num < 2) return;
+  glm::u8vec4 packed = quantize(color);
+  // separate lines, so strips of any length share one draw
+  for (std::size_t i = 1; i < num; ++i) {
+    m_lines.push_back(line_vertex{points[i - 1], packed});
+    m_lines.push_back(line_vertex{points[i], packed});
+  }
+  if (closed) {
+    m_lines.push_back(line_vertex{points[num - 1], packed});
+    m_lines.push_back(line_vertex{points[0], packed});
+  }
+}
+
+void line_batch::add_axes(glm::fmat4 const& transform, float length) {
+  glm::fvec3 origin{transform[3]};
+  for (int axis = 0; axis < 3; ++axis) {
+    glm::fvec4 color{0.0f, 0.0f, 0.0f, 1.0f};
+    color[axis] = 1.0f;
+    add_line(origin, origin + glm::fvec3{transform[axis]} * length, color);
+  }
+}
+
+void line_batch::add_point(glm::fvec3 const& position, glm::fvec4 const& color) {
+  m_points.push_back(line_vertex{position, quantize(color)});
+}
+
+void line_batch::add_circle(glm::fmat4 const& transform, glm::fvec4 const& color, unsigned segments) {
+  m_circles[level_of(segments)].push_back(circle_instance{transform, quantize(color)});
+}
+
+void line_batch::clear() {
+  m_lines.clear();
+  m_points.clear();
+  for (auto& level : m_circles) {
+    level.clear();
+  }
+}
+
+std::size_t line_batch::size() const {
+  std::size_t num = m_lines.size() / 2 + m_points.size();
+  for (auto const& level : m_circles) {
+    num += level.size();
+  }
+  return num;
+}
+
+void line_batch::initialize() {
+  glGenVertexArrays(1, &m_stream_array);
+  glGenVertexArrays(1, &m_circle_array);
+  glGenBuffers(1, &m_circle_buffer);
+
+  // streamed vertices, transform stays disabled, pointers are set per draw
+  gl_state::bind_vertex_array(m_stream_array);
+  glEnableVertexAttribArray(POSITION_LOCATION);
+  glEnableVertexAttribArray(COLOR_LOCATION);
+
+  // unit circles of all levels after each other
+  std::vector<glm::fvec3> points{};
+  for (std::size_t level = 0; level < LEVEL_NUM; ++level) {
+    unsigned segments = MIN_SEGMENTS << level;
+    float step = 2.0f * glm::pi<float>() / float(segments);
+    for (unsigned i = 0; i < segments; ++i) {
+      points.push_back(glm::fvec3{std::cos(float(i) * step), 0.0f, std::sin(float(i) * step)});
+    }
+  }
+  gl_state::bind_vertex_array(m_circle_array);
+  gl_state::bind_buffer(GL_ARRAY_BUFFER, m_circle_buffer);
+  glBufferData(GL_ARRAY_BUFFER, GLsizeiptr(points.size() * sizeof(glm::fvec3)), points.data(), GL_STATIC_DRAW);
+  glEnableVertexAttribArray(POSITION_LOCATION);
+  glVertexAttribPointer(POSITION_LOCATION, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
+  // color and transform come from the instance buffer, pointers are set per draw
+  for (GLuint location = COLOR_LOCATION; location < TRANSFORM_LOCATION + 4; ++location) {
+    glEnableVertexAttribArray(location);
+    glVertexAttribDivisor(location, 1);
+  }
+}
+
+void line_batch::set_attribute_pointers(GLintptr offset) const {
+  GLsizei stride = GLsizei(sizeof(circle_instance));
+  std::uintptr_t base = std::uintptr_t(offset);
+  glVertexAttribPointer(COLOR_LOCATION, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride,
+                        reinterpret_cast<GLvoid*>(base + offsetof(circle_instance, color)));
+  // matrices occupy one location per column
+  for (GLuint column = 0; column < 4; ++column) {
+    glVertexAttribPointer(TRANSFORM_LOCATION + column, 4, GL_FLOAT, GL_FALSE, stride,
+                          reinterpret_cast<GLvoid*>(base + offsetof(circle_instance, transform) + column * sizeof(glm::fvec4)));
+  }
+}
+
+void line_batch::set_stream_pointers(GLintptr offset) const {
+  GLsizei stride = GLsizei(sizeof(line_vertex));
+  std::uintptr_t base = std::uintptr_t(offset);
+  glVertexAttribPointer(POSITION_LOCATION, 3, GL_FLOAT, GL_FALSE, stride,
+                        reinterpret_cast<GLvoid*>(base + offsetof(line_vertex, position)));
+  glVertexAttribPointer(COLOR_LOCATION, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride,
+                        reinterpret_cast<GLvoid*>(base + offsetof(line_vertex, color)));
+}
+
+std::size_t line_batch::draw() {
+  if (size() == 0) return 0;
+  if (m_stream_array == 0) {
+    initialize();
+  }
+  std::size_t draws = 0;
+
+  m_sorted.clear();
+  for (auto const& level : m_circles) {
+    m_sorted.insert(m_sorted.end(), level.begin(), level.end());
+  }
+
+  // a larger ring replaces a full one, the driver keeps the old buffer until the gpu is done with it
+  std::size_t instance_bytes = m_sorted.size() * sizeof(circle_instance);
+  std::size_t line_bytes = m_lines.size() * sizeof(line_vertex);
+  std::size_t point_bytes = m_points.size() * sizeof(line_vertex);
+  // each range may start up to one alignment after the end of the previous one
+  GLsizeiptr needed = GLsizeiptr(instance_bytes + line_bytes + point_bytes) + 3 * (m_ring ? m_ring->alignment() : 16);
+  if (!m_ring || needed > m_ring->frame_size()) {
+    GLsizeiptr frame_size = std::max(needed, m_ring ? m_ring->frame_size() * 2 : INITIAL_RING_SIZE);
+    m_ring.reset(new frame_ring{GL_ARRAY_BUFFER, frame_size});
+  }
+  m_ring->next_frame();
+
+  if (!m_sorted.empty()) {
+    ring_range instances = m_ring->upload(m_sorted.data(), GLsizeiptr(instance_bytes));
+    gl_state::bind_vertex_array(m_circle_array);
+    gl_state::bind_buffer(GL_ARRAY_BUFFER, instances.buffer);
+
+    GLintptr offset = instances.offset;
+    GLint first = 0;
+    for (std::size_t level = 0; level < LEVEL_NUM; ++level) {
+      GLsizei segments = GLsizei(MIN_SEGMENTS << level);
+      if (!m_circles[level].empty()) {
+        // no base instance in GL 3.3, attributes start at level instead
+        set_attribute_pointers(offset);
+        glDrawArraysInstanced(GL_LINE_LOOP, first, segments, GLsizei(m_circles[level].size()));
+        ++draws;
+        offset += GLintptr(m_circles[level].size() * sizeof(circle_instance));
+      }
+      first += segments;
+    }
+  }
+
+  if (!m_lines.empty() || !m_points.empty()) {
+    gl_state::bind_vertex_array(m_stream_array);
+    // disabled transform attribute reads the current generic value, which is not part of the vertex array
+    glm::fmat4 const identity{};
+    for (GLuint column = 0; column < 4; ++column) {
+      glVertexAttrib4fv(TRANSFORM_LOCATION + column, &identity[column][0]);
+    }
+    if (!m_lines.empty()) {
+      ring_range lines = m_ring->upload(m_lines.data(), GLsizeiptr(line_bytes));
+      gl_state::bind_buffer(GL_ARRAY_BUFFER, lines.buffer);
+      set_stream_pointers(lines.offset);
+      glDrawArrays(GL_LINES, 0, GLsizei(m_lines.size()));
+      ++draws;
+    }
+    if (!m_points.empty()) {
+      ring_range points = m_ring->upload(m_points.data(), GLsizeiptr(point_bytes));
+      gl_state::bind_buffer(GL_ARRAY_BUFFER, points.buffer);
+      set_stream_pointers(points.offset);
+      glDrawArrays(GL_POINTS, 0, GLsizei(m_points.size()));
+      ++draws;
+    }
+  }
+
+  clear();
+  return draws;
+}
@@ -0,0 +1,120 @@
+#include "mapped_file.hpp"
+
+#ifdef _WIN32
+  #define WIN32_LEAN_AND_MEAN
+  #define NOMINMAX
+  #include <windows.h>
+#else
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+mapped_file::mapped_file()
+ :m_data{nullptr}
+ ,m_size{0}
+ ,m_valid{false}
+{}
+
+mapped_file::mapped_file(std::string const& path)
+ :mapped_file{}
+{
+#ifdef _WIN32
+  HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (file == INVALID_HANDLE_VALUE) return;
+  LARGE_INTEGER file_size;
+  if (!GetFileSizeEx(file, &file_size)) {
+    CloseHandle(file);
+    return;
+  }
+  m_size = std::size_t(file_size.QuadPart);
+  // empty files cannot be mapped
+  if (m_size == 0) {
+    CloseHandle(file);
+    m_valid = true;
+    return;
+  }
+  HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+  CloseHandle(file);
+  if (!mapping) return;
+  m_data = static_cast<unsigned char const*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+  // view keeps mapping alive
+  CloseHandle(mapping);
+  m_valid = m_data != nullptr;
+#else
+  int file = open(path.c_str(), O_RDONLY);
+  if (file < 0) return;
+  struct stat file_stat;
+  if (fstat(file, &file_stat) != 0) {
+    close(file);
+    return;
+  }
+  m_size = std::size_t(file_stat.st_size);
+  // empty files cannot be mapped
+  if (m_size == 0) {
+    close(file);
+    m_valid = true;
+    return;
+  }
+  void* view = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, file, 0);
+  // mapping stays valid after closing
+  close(file);
+  if (view != MAP_FAILED) {
+    m_data = static_cast<unsigned char const*>(view);
+    m_valid = true;
+  }
+#endif
+}
+
+mapped_file::mapped_file(mapped_file&& other)
+ :m_data{other.m_data}
+ ,m_size{other.m_size}
+ ,m_valid{other.m_valid}
+{
+  other.m_data = nullptr;
+  other.m_size = 0;
+  other.m_valid = false;
+}
+
+mapped_file& mapped_file::operator=(mapped_file&& other) {
+  if (this != &other) {
+    unmap();
+    m_data = other.m_data;
+    m_size = other.m_size;
+    m_valid = other.m_valid;
+    other.m_data = nullptr;
+    other.m_size = 0;
+    other.m_valid = false;
+  }
+  return *this;
+}
+
+mapped_file::~mapped_file() {
+  unmap();
+}
+
+void mapped_file::unmap() {
+  if (m_data) {
+  #ifdef _WIN32
+    UnmapViewOfFile(m_data);
+  #else
+    munmap(const_cast<unsigned char*>(m_data), m_size);
+  #endif
+  }
+  m_data = nullptr;
+  m_size = 0;
+  m_valid = false;
+}
+
+bool mapped_file::valid() const {
+  return m_valid;
+}
+
+unsigned char const* mapped_file::data() const {
+  return m_data;
+}
+
+std::size_t mapped_file::size() const {
+  return m_size;
+}
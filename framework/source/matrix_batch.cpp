@@ -0,0 +1,305 @@
+#include "matrix_batch.hpp"
+
+#include <glm/geometric.hpp>
+
+// SSE2 is available on every x86-64 target
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MATRIX_BATCH_SSE
+#include <emmintrin.h>
+#endif
+
+namespace matrix_batch {
+
+namespace {
+#ifdef MATRIX_BATCH_SSE
+  // matrices are processed in groups of four with one lane per matrix
+  // element e[column * 4 + row] holds that entry of all four matrices
+  struct soa_block {
+    __m128 e[16];
+  };
+
+  void load(glm::fmat4 const* m, soa_block& block) {
+    for (int column = 0; column < 4; ++column) {
+      __m128 c0 = _mm_loadu_ps(&m[0][column][0]);
+      __m128 c1 = _mm_loadu_ps(&m[1][column][0]);
+      __m128 c2 = _mm_loadu_ps(&m[2][column][0]);
+      __m128 c3 = _mm_loadu_ps(&m[3][column][0]);
+      _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+      block.e[column * 4] = c0;
+      block.e[column * 4 + 1] = c1;
+      block.e[column * 4 + 2] = c2;
+      block.e[column * 4 + 3] = c3;
+    }
+  }
+
+  void store(soa_block const& block, glm::fmat4* m) {
+    for (int column = 0; column < 4; ++column) {
+      __m128 c0 = block.e[column * 4];
+      __m128 c1 = block.e[column * 4 + 1];
+      __m128 c2 = block.e[column * 4 + 2];
+      __m128 c3 = block.e[column * 4 + 3];
+      _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+      _mm_storeu_ps(&m[0][column][0], c0);
+      _mm_storeu_ps(&m[1][column][0], c1);
+      _mm_storeu_ps(&m[2][column][0], c2);
+      _mm_storeu_ps(&m[3][column][0], c3);
+    }
+  }
+
+  // three component vectors, one lane per matrix
+  struct soa_vec3 {
+    __m128 x, y, z;
+  };
+
+  soa_vec3 column(soa_block const& block, int index) {
+    return soa_vec3{block.e[index * 4], block.e[index * 4 + 1], block.e[index * 4 + 2]};
+  }
+
+  soa_vec3 cross(soa_vec3 const& a, soa_vec3 const& b) {
+    return soa_vec3{_mm_sub_ps(_mm_mul_ps(a.y, b.z), _mm_mul_ps(a.z, b.y)),
+                    _mm_sub_ps(_mm_mul_ps(a.z, b.x), _mm_mul_ps(a.x, b.z)),
+                    _mm_sub_ps(_mm_mul_ps(a.x, b.y), _mm_mul_ps(a.y, b.x))};
+  }
+
+  __m128 dot(soa_vec3 const& a, soa_vec3 const& b) {
+    return _mm_add_ps(_mm_add_ps(_mm_mul_ps(a.x, b.x), _mm_mul_ps(a.y, b.y)), _mm_mul_ps(a.z, b.z));
+  }
+
+  soa_vec3 scale(soa_vec3 const& a, __m128 factor) {
+    return soa_vec3{_mm_mul_ps(a.x, factor), _mm_mul_ps(a.y, factor), _mm_mul_ps(a.z, factor)};
+  }
+
+  // columns of the inverse transpose of the upper 3x3 blocks
+  void inverse_transpose(soa_block const& block, soa_vec3 result[3]) {
+    soa_vec3 c0 = column(block, 0);
+    soa_vec3 c1 = column(block, 1);
+    soa_vec3 c2 = column(block, 2);
+    result[0] = cross(c1, c2);
+    result[1] = cross(c2, c0);
+    result[2] = cross(c0, c1);
+    __m128 inverse_determinant = _mm_div_ps(_mm_set1_ps(1.0f), dot(c0, result[0]));
+    for (int i = 0; i < 3; ++i) {
+      result[i] = scale(result[i], inverse_determinant);
+    }
+  }
+
+  // column of a times broadcast components of b
+  __m128 combine(__m128 const a[4], float const* b) {
+    __m128 result = _mm_mul_ps(a[0], _mm_set1_ps(b[0]));
+    result = _mm_add_ps(result, _mm_mul_ps(a[1], _mm_set1_ps(b[1])));
+    result = _mm_add_ps(result, _mm_mul_ps(a[2], _mm_set1_ps(b[2])));
+    return _mm_add_ps(result, _mm_mul_ps(a[3], _mm_set1_ps(b[3])));
+  }
+
+  void multiply_one(__m128 const a[4], glm::fmat4 const& b, glm::fmat4& out) {
+    // b may alias out, read all columns first
+    __m128 result[4];
+    for (int column = 0; column < 4; ++column) {
+      result[column] = combine(a, &b[column][0]);
+    }
+    for (int column = 0; column < 4; ++column) {
+      _mm_storeu_ps(&out[column][0], result[column]);
+    }
+  }
+
+  // cross product of xyz lanes, w lane is zero for finite inputs
+  __m128 cross(__m128 a, __m128 b) {
+    __m128 a_yzx = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+    __m128 b_yzx = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+    __m128 result = _mm_sub_ps(_mm_mul_ps(a, b_yzx), _mm_mul_ps(a_yzx, b));
+    return _mm_shuffle_ps(result, result, _MM_SHUFFLE(3, 0, 2, 1));
+  }
+
+  void load_columns(glm::fmat4 const& m, __m128 columns[4]) {
+    for (int column = 0; column < 4; ++column) {
+      columns[column] = _mm_loadu_ps(&m[column][0]);
+    }
+  }
+#endif
+
+  // columns of the inverse transpose of the upper 3x3 block
+  void inverse_transpose(glm::fmat4 const& m, glm::fvec3 result[3]) {
+    glm::fvec3 c0{m[0]};
+    glm::fvec3 c1{m[1]};
+    glm::fvec3 c2{m[2]};
+    result[0] = glm::cross(c1, c2);
+    result[1] = glm::cross(c2, c0);
+    result[2] = glm::cross(c0, c1);
+    float inverse_determinant = 1.0f / glm::dot(c0, result[0]);
+    for (int i = 0; i < 3; ++i) {
+      result[i] *= inverse_determinant;
+    }
+  }
+
+  glm::fmat4 compose_one(trs_arrays const& trs, std::size_t i) {
+    float x = trs.rotation[0][i];
+    float y = trs.rotation[1][i];
+    float z = trs.rotation[2][i];
+    float w = trs.rotation[3][i];
+    float sx = trs.scale[0][i];
+    float sy = trs.scale[1][i];
+    float sz = trs.scale[2][i];
+    glm::fmat4 result{};
+    result[0] = glm::fvec4{(1.0f - 2.0f * (y * y + z * z)) * sx, 2.0f * (x * y + w * z) * sx, 2.0f * (x * z - w * y) * sx, 0.0f};
+    result[1] = glm::fvec4{2.0f * (x * y - w * z) * sy, (1.0f - 2.0f * (x * x + z * z)) * sy, 2.0f * (y * z + w * x) * sy, 0.0f};
+    result[2] = glm::fvec4{2.0f * (x * z + w * y) * sz, 2.0f * (y * z - w * x) * sz, (1.0f - 2.0f * (x * x + y * y)) * sz, 0.0f};
+    result[3] = glm::fvec4{trs.translation[0][i], trs.translation[1][i], trs.translation[2][i], 1.0f};
+    return result;
+  }
+}
+
+void multiply(glm::fmat4 const& a, glm::fmat4 const* b, glm::fmat4* out, std::size_t count) {
+#ifdef MATRIX_BATCH_SSE
+  __m128 columns[4];
+  load_columns(a, columns);
+  for (std::size_t i = 0; i < count; ++i) {
+    multiply_one(columns, b[i], out[i]);
+  }
+#else
+  for (std::size_t i = 0; i < count; ++i) {
+    out[i] = a * b[i];
+  }
+#endif
+}
+
+void multiply(glm::fmat4 const* a, glm::fmat4 const* b, glm::fmat4* out, std::size_t count) {
+#ifdef MATRIX_BATCH_SSE
+  __m128 columns[4];
+  for (std::size_t i = 0; i < count; ++i) {
+    load_columns(a[i], columns);
+    multiply_one(columns, b[i], out[i]);
+  }
+#else
+  for (std::size_t i = 0; i < count; ++i) {
+    out[i] = a[i] * b[i];
+  }
+#endif
+}
+
+void affine_inverse(glm::fmat4 const* in, glm::fmat4* out, std::size_t count) {
+  std::size_t i = 0;
+#ifdef MATRIX_BATCH_SSE
+  for (; i + 4 <= count; i += 4) {
+    soa_block block;
+    load(in + i, block);
+    // rows of the inverse are the columns of the inverse transpose
+    soa_vec3 rows[3];
+    inverse_transpose(block, rows);
+    soa_vec3 translation = column(block, 3);
+    __m128 const zero = _mm_setzero_ps();
+    for (int row = 0; row < 3; ++row) {
+      block.e[row] = rows[row].x;
+      block.e[4 + row] = rows[row].y;
+      block.e[8 + row] = rows[row].z;
+      block.e[12 + row] = _mm_sub_ps(zero, dot(rows[row], translation));
+    }
+    block.e[3] = block.e[7] = block.e[11] = zero;
+    block.e[15] = _mm_set1_ps(1.0f);
+    store(block, out + i);
+  }
+#endif
+  for (; i < count; ++i) {
+    out[i] = affine_inverse(in[i]);
+  }
+}
+
+glm::fmat4 affine_inverse(glm::fmat4 const& matrix) {
+  glm::fvec3 rows[3];
+  inverse_transpose(matrix, rows);
+  glm::fvec3 translation{matrix[3]};
+  glm::fmat4 result{};
+  for (int row = 0; row < 3; ++row) {
+    for (int column = 0; column < 3; ++column) {
+      result[column][row] = rows[row][column];
+    }
+    result[3][row] = -glm::dot(rows[row], translation);
+  }
+  return result;
+}
+
+void normal_matrices(glm::fmat4 const* in, glm::fmat3* out, std::size_t count) {
+#ifdef MATRIX_BATCH_SSE
+  // one matrix per iteration, fmat3 columns do not fit the lane layout of soa_block
+  for (std::size_t i = 0; i < count; ++i) {
+    __m128 c0 = _mm_loadu_ps(&in[i][0][0]);
+    __m128 c1 = _mm_loadu_ps(&in[i][1][0]);
+    __m128 c2 = _mm_loadu_ps(&in[i][2][0]);
+    __m128 n0 = cross(c1, c2);
+    __m128 n1 = cross(c2, c0);
+    __m128 n2 = cross(c0, c1);
+    // determinant in all lanes
+    __m128 product = _mm_mul_ps(c0, n0);
+    __m128 determinant = _mm_add_ps(_mm_add_ps(_mm_shuffle_ps(product, product, _MM_SHUFFLE(0, 0, 0, 0)),
+                                               _mm_shuffle_ps(product, product, _MM_SHUFFLE(1, 1, 1, 1))),
+                                    _mm_shuffle_ps(product, product, _MM_SHUFFLE(2, 2, 2, 2)));
+    __m128 inverse_determinant = _mm_div_ps(_mm_set1_ps(1.0f), determinant);
+    n0 = _mm_mul_ps(n0, inverse_determinant);
+    n1 = _mm_mul_ps(n1, inverse_determinant);
+    n2 = _mm_mul_ps(n2, inverse_determinant);
+    // overlapping stores, each column overwrites the excess lane of the previous one
+    float* target = &out[i][0][0];
+    _mm_storeu_ps(target, n0);
+    _mm_storeu_ps(target + 3, n1);
+    _mm_storel_pi(reinterpret_cast<__m64*>(target + 6), n2);
+    _mm_store_ss(target + 8, _mm_shuffle_ps(n2, n2, _MM_SHUFFLE(2, 2, 2, 2)));
+  }
+#else
+  for (std::size_t i = 0; i < count; ++i) {
+    glm::fvec3 columns[3];
+    inverse_transpose(in[i], columns);
+    out[i] = glm::fmat3{columns[0], columns[1], columns[2]};
+  }
+#endif
+}
+
+void compose(trs_arrays const& trs, glm::fmat4* out, std::size_t count) {
+  std::size_t i = 0;
+#ifdef MATRIX_BATCH_SSE
+  __m128 const zero = _mm_setzero_ps();
+  __m128 const one = _mm_set1_ps(1.0f);
+  __m128 const two = _mm_set1_ps(2.0f);
+  for (; i + 4 <= count; i += 4) {
+    __m128 x = _mm_loadu_ps(trs.rotation[0] + i);
+    __m128 y = _mm_loadu_ps(trs.rotation[1] + i);
+    __m128 z = _mm_loadu_ps(trs.rotation[2] + i);
+    __m128 w = _mm_loadu_ps(trs.rotation[3] + i);
+    __m128 sx = _mm_loadu_ps(trs.scale[0] + i);
+    __m128 sy = _mm_loadu_ps(trs.scale[1] + i);
+    __m128 sz = _mm_loadu_ps(trs.scale[2] + i);
+
+    __m128 xx = _mm_mul_ps(x, x);
+    __m128 yy = _mm_mul_ps(y, y);
+    __m128 zz = _mm_mul_ps(z, z);
+    __m128 xy = _mm_mul_ps(x, y);
+    __m128 xz = _mm_mul_ps(x, z);
+    __m128 yz = _mm_mul_ps(y, z);
+    __m128 wx = _mm_mul_ps(w, x);
+    __m128 wy = _mm_mul_ps(w, y);
+    __m128 wz = _mm_mul_ps(w, z);
+
+    soa_block block;
+    block.e[0] = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), sx);
+    block.e[1] = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xy, wz)), sx);
+    block.e[2] = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xz, wy)), sx);
+    block.e[3] = zero;
+    block.e[4] = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xy, wz)), sy);
+    block.e[5] = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), sy);
+    block.e[6] = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(yz, wx)), sy);
+    block.e[7] = zero;
+    block.e[8] = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xz, wy)), sz);
+    block.e[9] = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(yz, wx)), sz);
+    block.e[10] = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))), sz);
+    block.e[11] = zero;
+    block.e[12] = _mm_loadu_ps(trs.translation[0] + i);
+    block.e[13] = _mm_loadu_ps(trs.translation[1] + i);
+    block.e[14] = _mm_loadu_ps(trs.translation[2] + i);
+    block.e[15] = one;
+    store(block, out + i);
+  }
+#endif
+  for (; i < count; ++i) {
+    out[i] = compose_one(trs, i);
+  }
+}
+
+};
@@ -0,0 +1,300 @@
+#include "mesh_attributes.hpp"
+
+#include "parallel.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+// SSE2 is available on every x86-64 target
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MESH_ATTRIBUTES_SSE
+#include <emmintrin.h>
+#endif
+
+namespace mesh_attributes {
+
+namespace {
+  // items per parallel task, large enough to amortize scheduling
+  const std::size_t BLOCK_SIZE = 1 << 14;
+  // partial vertex sums, limits memory to a few copies of the result
+  const std::size_t MAX_PARTITIONS = 8;
+
+  // calls function(begin, end) for blocks of [0, count) on all cores
+  template<typename Function>
+  void for_blocks(std::size_t count, Function const& function) {
+    std::size_t blocks = (count + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    parallel::for_each(blocks, [&](std::size_t block) {
+      function(block * BLOCK_SIZE, std::min(count, (block + 1) * BLOCK_SIZE));
+    });
+  }
+
+  // vectors of up to four triangles in separate component arrays, matching SSE lanes
+  struct face_block {
+    float x[4];
+    float y[4];
+    float z[4];
+    // factor of each corner
+    float weights[3][4];
+  };
+
+  // scale vectors to unit length, zero vectors are kept
+  void normalize(float* x, float* y, float* z, std::size_t count) {
+    std::size_t i = 0;
+#ifdef MESH_ATTRIBUTES_SSE
+    __m128 const zero = _mm_setzero_ps();
+    __m128 const one = _mm_set1_ps(1.0f);
+    for (; i + 4 <= count; i += 4) {
+      __m128 vx = _mm_loadu_ps(x + i);
+      __m128 vy = _mm_loadu_ps(y + i);
+      __m128 vz = _mm_loadu_ps(z + i);
+      __m128 length2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy)), _mm_mul_ps(vz, vz));
+      __m128 scale = _mm_and_ps(_mm_cmpgt_ps(length2, zero), _mm_div_ps(one, _mm_sqrt_ps(length2)));
+      _mm_storeu_ps(x + i, _mm_mul_ps(vx, scale));
+      _mm_storeu_ps(y + i, _mm_mul_ps(vy, scale));
+      _mm_storeu_ps(z + i, _mm_mul_ps(vz, scale));
+    }
+#endif
+    for (; i < count; ++i) {
+      float length2 = x[i] * x[i] + y[i] * y[i] + z[i] * z[i];
+      float scale = length2 > 0.0f ? 1.0f / std::sqrt(length2) : 0.0f;
+      x[i] *= scale;
+      y[i] *= scale;
+      z[i] *= scale;
+    }
+  }
+
+#ifdef MESH_ATTRIBUTES_SSE
+  // component of attribute at given corner of four consecutive triangles
+  inline __m128 gather(float const* data, std::size_t components, unsigned const* indices, std::size_t corner, std::size_t component) {
+    return _mm_setr_ps(data[indices[corner] * components + component],
+                       data[indices[corner + 3] * components + component],
+                       data[indices[corner + 6] * components + component],
+                       data[indices[corner + 9] * components + component]);
+  }
+#endif
+
+  // unnormalized face normals, length is twice the triangle area
+  void face_normals(float const* p, unsigned const* indices, std::size_t count, face_block& block) {
+#ifdef MESH_ATTRIBUTES_SSE
+    if (count == 4) {
+      __m128 ax = gather(p, 3, indices, 0, 0);
+      __m128 ay = gather(p, 3, indices, 0, 1);
+      __m128 az = gather(p, 3, indices, 0, 2);
+      __m128 e1x = _mm_sub_ps(gather(p, 3, indices, 1, 0), ax);
+      __m128 e1y = _mm_sub_ps(gather(p, 3, indices, 1, 1), ay);
+      __m128 e1z = _mm_sub_ps(gather(p, 3, indices, 1, 2), az);
+      __m128 e2x = _mm_sub_ps(gather(p, 3, indices, 2, 0), ax);
+      __m128 e2y = _mm_sub_ps(gather(p, 3, indices, 2, 1), ay);
+      __m128 e2z = _mm_sub_ps(gather(p, 3, indices, 2, 2), az);
+      _mm_storeu_ps(block.x, _mm_sub_ps(_mm_mul_ps(e1y, e2z), _mm_mul_ps(e2y, e1z)));
+      _mm_storeu_ps(block.y, _mm_sub_ps(_mm_mul_ps(e1z, e2x), _mm_mul_ps(e2z, e1x)));
+      _mm_storeu_ps(block.z, _mm_sub_ps(_mm_mul_ps(e1x, e2y), _mm_mul_ps(e2x, e1y)));
+      return;
+    }
+#endif
+    for (std::size_t t = 0; t < count; ++t) {
+      float const* a = p + indices[t * 3] * 3;
+      float const* b = p + indices[t * 3 + 1] * 3;
+      float const* c = p + indices[t * 3 + 2] * 3;
+      float e1x = b[0] - a[0];
+      float e1y = b[1] - a[1];
+      float e1z = b[2] - a[2];
+      float e2x = c[0] - a[0];
+      float e2y = c[1] - a[1];
+      float e2z = c[2] - a[2];
+      block.x[t] = e1y * e2z - e2y * e1z;
+      block.y[t] = e1z * e2x - e2z * e1x;
+      block.z[t] = e1x * e2y - e2x * e1y;
+    }
+  }
+
+  // angle between the two edges at each triangle corner as weights
+  void corner_angles(float const* p, unsigned const* indices, std::size_t count, face_block& block) {
+    for (std::size_t t = 0; t < count; ++t) {
+      for (std::size_t k = 0; k < 3; ++k) {
+        float const* a = p + indices[t * 3 + k] * 3;
+        float const* b = p + indices[t * 3 + (k + 1) % 3] * 3;
+        float const* c = p + indices[t * 3 + (k + 2) % 3] * 3;
+        float ux = b[0] - a[0];
+        float uy = b[1] - a[1];
+        float uz = b[2] - a[2];
+        float vx = c[0] - a[0];
+        float vy = c[1] - a[1];
+        float vz = c[2] - a[2];
+        float lengths = std::sqrt((ux * ux + uy * uy + uz * uz) * (vx * vx + vy * vy + vz * vz));
+        float cosine = lengths > 0.0f ? (ux * vx + uy * vy + uz * vz) / lengths : 1.0f;
+        block.weights[k][t] = std::acos(std::max(-1.0f, std::min(1.0f, cosine)));
+      }
+    }
+  }
+
+  // tangents of triangles in direction of increasing u, zero for degenerate texture coordinates
+  void face_tangents(float const* p, float const* uv, unsigned const* indices, std::size_t count, face_block& block) {
+#ifdef MESH_ATTRIBUTES_SSE
+    if (count == 4) {
+      __m128 const zero = _mm_setzero_ps();
+      __m128 const one = _mm_set1_ps(1.0f);
+      __m128 u = gather(uv, 2, indices, 0, 0);
+      __m128 v = gather(uv, 2, indices, 0, 1);
+      __m128 d_t1x = _mm_sub_ps(gather(uv, 2, indices, 1, 0), u);
+      __m128 d_t1y = _mm_sub_ps(gather(uv, 2, indices, 1, 1), v);
+      __m128 d_t2x = _mm_sub_ps(gather(uv, 2, indices, 2, 0), u);
+      __m128 d_t2y = _mm_sub_ps(gather(uv, 2, indices, 2, 1), v);
+      __m128 det = _mm_sub_ps(_mm_mul_ps(d_t1x, d_t2y), _mm_mul_ps(d_t1y, d_t2x));
+      __m128 r = _mm_and_ps(_mm_cmpneq_ps(det, zero), _mm_div_ps(one, det));
+      float* out[3] = {block.x, block.y, block.z};
+      for (std::size_t axis = 0; axis < 3; ++axis) {
+        __m128 a = gather(p, 3, indices, 0, axis);
+        __m128 d_p1 = _mm_sub_ps(gather(p, 3, indices, 1, axis), a);
+        __m128 d_p2 = _mm_sub_ps(gather(p, 3, indices, 2, axis), a);
+        _mm_storeu_ps(out[axis], _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(d_p1, d_t2y), _mm_mul_ps(d_p2, d_t1y)), r));
+      }
+      return;
+    }
+#endif
+    for (std::size_t t = 0; t < count; ++t) {
+      unsigned const* i = indices + t * 3;
+      float d_t1x = uv[i[1] * 2] - uv[i[0] * 2];
+      float d_t1y = uv[i[1] * 2 + 1] - uv[i[0] * 2 + 1];
+      float d_t2x = uv[i[2] * 2] - uv[i[0] * 2];
+      float d_t2y = uv[i[2] * 2 + 1] - uv[i[0] * 2 + 1];
+      float det = d_t1x * d_t2y - d_t1y * d_t2x;
+      float r = det != 0.0f ? 1.0f / det : 0.0f;
+      float* out[3] = {block.x, block.y, block.z};
+      for (std::size_t axis = 0; axis < 3; ++axis) {
+        float d_p1 = p[i[1] * 3 + axis] - p[i[0] * 3 + axis];
+        float d_p2 = p[i[2] * 3 + axis] - p[i[0] * 3 + axis];
+        out[axis][t] = (d_p1 * d_t2y - d_p2 * d_t1y) * r;
+      }
+    }
+  }
+
+  // interleaved sums of face vectors at adjacent vertices, one buffer per partition of triangles
+  // faces(triangle, count, block) computes vectors of up to four consecutive triangles
+  template<bool Weighted, typename Faces>
+  std::vector<std::vector<float>> accumulate(std::vector<unsigned> const& indices, std::size_t vertex_count, Faces const& faces) {
+    std::size_t triangle_count = indices.size() / 3;
+    for_blocks(triangle_count * 3, [&](std::size_t begin, std::size_t end) {
+      for (std::size_t i = begin; i < end; ++i) {
+        if (indices[i] >= vertex_count) {
+          throw std::out_of_range("Vertex index out of range");
+        }
+      }
+    });
+
+    // partitions write to separate buffers, so scattered additions need no synchronization
+    std::size_t partitions = std::min(std::min(std::size_t(parallel::thread_count()), MAX_PARTITIONS), triangle_count / BLOCK_SIZE);
+    partitions = std::max(partitions, std::size_t(1));
+    std::vector<std::vector<float>> sums(partitions);
+    parallel::for_each(partitions, [&](std::size_t partition) {
+      std::vector<float>& sum = sums[partition];
+      sum.assign(vertex_count * 3, 0.0f);
+      std::size_t end = triangle_count * (partition + 1) / partitions;
+      face_block block{};
+      for (std::size_t t = triangle_count * partition / partitions; t < end; t += 4) {
+        std::size_t count = std::min(end - t, std::size_t(4));
+        faces(t, count, block);
+        for (std::size_t lane = 0; lane < count; ++lane) {
+          for (std::size_t corner = 0; corner < 3; ++corner) {
+            float* vertex = &sum[indices[(t + lane) * 3 + corner] * 3];
+            if (Weighted) {
+              vertex[0] += block.x[lane] * block.weights[corner][lane];
+              vertex[1] += block.y[lane] * block.weights[corner][lane];
+              vertex[2] += block.z[lane] * block.weights[corner][lane];
+            }
+            else {
+              vertex[0] += block.x[lane];
+              vertex[1] += block.y[lane];
+              vertex[2] += block.z[lane];
+            }
+          }
+        }
+      }
+    });
+    return sums;
+  }
+
+  // adds partition sums per vertex, calls process(first, x, y, z, count) on blocks of component arrays
+  // result is written interleaved into first partition buffer
+  template<typename Process>
+  std::vector<float> reduce(std::vector<std::vector<float>>& sums, Process const& process) {
+    std::vector<float>& result = sums.front();
+    for_blocks(result.size() / 3, [&](std::size_t begin, std::size_t end) {
+      std::vector<float> x(end - begin);
+      std::vector<float> y(end - begin);
+      std::vector<float> z(end - begin);
+      for (std::size_t v = begin; v < end; ++v) {
+        for (auto const& sum : sums) {
+          x[v - begin] += sum[v * 3];
+          y[v - begin] += sum[v * 3 + 1];
+          z[v - begin] += sum[v * 3 + 2];
+        }
+      }
+      process(begin, x.data(), y.data(), z.data(), end - begin);
+      for (std::size_t v = begin; v < end; ++v) {
+        result[v * 3] = x[v - begin];
+        result[v * 3 + 1] = y[v - begin];
+        result[v * 3 + 2] = z[v - begin];
+      }
+    });
+    return std::move(result);
+  }
+}
+
+std::vector<float> normals(std::vector<float> const& positions,
+                           std::vector<unsigned> const& indices,
+                           weighting weights) {
+  std::size_t vertex_count = positions.size() / 3;
+  float const* p = positions.data();
+
+  std::vector<std::vector<float>> sums{};
+  if (weights == weighting::angle) {
+    sums = accumulate<true>(indices, vertex_count, [&](std::size_t t, std::size_t count, face_block& block) {
+      face_normals(p, &indices[t * 3], count, block);
+      normalize(block.x, block.y, block.z, count);
+      corner_angles(p, &indices[t * 3], count, block);
+    });
+  }
+  else {
+    sums = accumulate<false>(indices, vertex_count, [&](std::size_t t, std::size_t count, face_block& block) {
+      face_normals(p, &indices[t * 3], count, block);
+    });
+  }
+
+  return reduce(sums, [](std::size_t, float* x, float* y, float* z, std::size_t count) {
+    normalize(x, y, z, count);
+  });
+}
+
+std::vector<float> tangents(std::vector<float> const& positions,
+                            std::vector<float> const& normals,
+                            std::vector<float> const& texcoords,
+                            std::vector<unsigned> const& indices) {
+  std::size_t vertex_count = positions.size() / 3;
+  if (normals.size() < positions.size()) {
+    throw std::invalid_argument("Tangent generation requires vertex normals");
+  }
+  // missing texture coordinates are zero
+  std::vector<float> uv(texcoords.begin(), texcoords.begin() + std::ptrdiff_t(std::min(texcoords.size(), vertex_count * 2)));
+  uv.resize(vertex_count * 2, 0.0f);
+  float const* p = positions.data();
+
+  std::vector<std::vector<float>> sums = accumulate<false>(indices, vertex_count, [&](std::size_t t, std::size_t count, face_block& block) {
+    face_tangents(p, uv.data(), &indices[t * 3], count, block);
+  });
+
+  // remove normal component, then normalize
+  return reduce(sums, [&](std::size_t first, float* x, float* y, float* z, std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i) {
+      float const* n = &normals[(first + i) * 3];
+      float d = n[0] * x[i] + n[1] * y[i] + n[2] * z[i];
+      x[i] -= n[0] * d;
+      y[i] -= n[1] * d;
+      z[i] -= n[2] * d;
+    }
+    normalize(x, y, z, count);
+  });
+}
+
+};
@@ -0,0 +1,152 @@
+#include "mesh_cache.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace mesh_cache {
+
+namespace {
+  const char MAGIC[4] = {'M', 'E', 'S', 'H'};
+  // alignment of index data in file
+  const std::size_t ALIGNMENT = 16;
+
+  std::size_t aligned(std::size_t offset) {
+    return (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+  }
+}
+
+cached_model::cached_model(model&& imported)
+ :data{nullptr}
+ ,data_size{imported.data.size()}
+ ,indices{nullptr}
+ ,index_num{imported.indices.size()}
+ ,layout{}
+ ,m_imported{std::move(imported)}
+ ,m_header{}
+ ,m_file{}
+{
+  data = m_imported.data.data();
+  indices = m_imported.indices.data();
+  layout = model{std::vector<GLfloat>{}, m_imported.attributes};
+  layout.vertex_num = m_imported.vertex_num;
+}
+
+cached_model::cached_model(std::string const& cache_path)
+ :data{nullptr}
+ ,data_size{0}
+ ,indices{nullptr}
+ ,index_num{0}
+ ,layout{}
+ ,m_imported{}
+ ,m_header{}
+ ,m_file{cache_path}
+{
+  // check header and that buffers are contained in file
+  if (m_file.size() < sizeof(header)) {
+    m_file = mapped_file{};
+    return;
+  }
+  std::memcpy(&m_header, m_file.data(), sizeof(header));
+  std::size_t index_offset = aligned(sizeof(header) + std::size_t(m_header.data_size) * sizeof(GLfloat));
+  if (std::memcmp(m_header.magic, MAGIC, sizeof(MAGIC)) != 0
+   || m_header.version != VERSION
+   || !(m_header.attributes & model::POSITION)
+   || index_offset + std::size_t(m_header.index_num) * sizeof(GLuint) > m_file.size()) {
+    m_file = mapped_file{};
+    return;
+  }
+
+  unsigned char const* bytes = m_file.data();
+  data = reinterpret_cast<GLfloat const*>(bytes + sizeof(header));
+  data_size = std::size_t(m_header.data_size);
+  indices = reinterpret_cast<GLuint const*>(bytes + index_offset);
+  index_num = std::size_t(m_header.index_num);
+  // compute offsets and vertex size from attributes
+  layout = model{std::vector<GLfloat>{}, m_header.attributes};
+  layout.vertex_num = std::size_t(m_header.vertex_num);
+}
+
+cached_model::cached_model(cached_model&& other)
+ :data{other.data}
+ ,data_size{other.data_size}
+ ,indices{other.indices}
+ ,index_num{other.index_num}
+ ,layout{std::move(other.layout)}
+ ,m_imported{std::move(other.m_imported)}
+ ,m_header(other.m_header)
+ ,m_file{std::move(other.m_file)}
+{
+  // moved vectors and mapping keep their buffers
+  other.data = nullptr;
+  other.indices = nullptr;
+}
+
+bool cached_model::valid() const {
+  return data != nullptr;
+}
+
+header const& cached_model::file_header() const {
+  return m_header;
+}
+
+std::uint64_t hash_file(std::string const& path) {
+  std::ifstream file{path, std::ios::binary};
+  if (!file) {
+    throw std::invalid_argument("Could not open file " + path);
+  }
+  std::uint64_t hash = 14695981039346656037ull;
+  char chunk[1 << 16];
+  while (file) {
+    file.read(chunk, sizeof(chunk));
+    std::streamsize count = file.gcount();
+    for (std::streamsize i = 0; i < count; ++i) {
+      hash = (hash ^ std::uint64_t(static_cast<unsigned char>(chunk[i]))) * 1099511628211ull;
+    }
+  }
+  return hash;
+}
+
+std::string cache_path(std::string const& source_path, model::attrib_flag_t import_attribs, bool optimized) {
+  std::ostringstream path;
+  path << source_path << "." << std::hex << import_attribs << (optimized ? ".opt" : "") << ".meshcache";
+  return path.str();
+}
+
+bool store(std::string const& cache_path, std::uint64_t source_hash, model::attrib_flag_t import_attribs, model const& imported) {
+  header head{};
+  std::memcpy(head.magic, MAGIC, sizeof(MAGIC));
+  head.version = VERSION;
+  head.source_hash = source_hash;
+  head.import_attribs = import_attribs;
+  head.attributes = imported.attributes;
+  head.vertex_num = imported.vertex_num;
+  head.data_size = imported.data.size();
+  head.index_num = imported.indices.size();
+
+  // write to temporary file so readers never map partial files
+  std::string temp_path = cache_path + ".tmp";
+  {
+    std::ofstream file{temp_path, std::ios::binary};
+    if (!file) return false;
+
+    std::size_t data_bytes = imported.data.size() * sizeof(GLfloat);
+    char const padding[ALIGNMENT] = {};
+    file.write(reinterpret_cast<char const*>(&head), sizeof(head));
+    file.write(reinterpret_cast<char const*>(imported.data.data()), std::streamsize(data_bytes));
+    file.write(padding, std::streamsize(aligned(sizeof(head) + data_bytes) - sizeof(head) - data_bytes));
+    file.write(reinterpret_cast<char const*>(imported.indices.data()), std::streamsize(imported.indices.size() * sizeof(GLuint)));
+    if (!file) {
+      file.close();
+      std::remove(temp_path.c_str());
+      return false;
+    }
+  }
+  // rename does not replace existing files on windows
+  std::remove(cache_path.c_str());
+  return std::rename(temp_path.c_str(), cache_path.c_str()) == 0;
+}
+
+};
@@ -0,0 +1,300 @@
+#include "mesh_optimizer.hpp"
+
+#include <glm/geometric.hpp>
+#include <glm/vec3.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace mesh_optimizer {
+
+namespace {
+  // clusters with a lower cache miss ratio are closed, a new cluster costs at most one cache flush
+  const double CLUSTER_ACMR = 0.75;
+  const GLuint UNUSED = std::numeric_limits<GLuint>::max();
+
+  void check_indices(std::vector<GLuint> const& indices, std::size_t vertex_num) {
+    for (GLuint index : indices) {
+      if (index >= vertex_num) {
+        throw std::out_of_range("Vertex index out of range");
+      }
+    }
+  }
+
+  // triangles using each vertex, in compressed rows
+  struct adjacency {
+    adjacency(std::vector<GLuint> const& indices, std::size_t vertex_num)
+     :offsets(vertex_num + 1, 0)
+     ,triangles(indices.size() / 3 * 3)
+    {
+      for (std::size_t i = 0; i < triangles.size(); ++i) {
+        ++offsets[indices[i] + 1];
+      }
+      for (std::size_t v = 0; v < vertex_num; ++v) {
+        offsets[v + 1] += offsets[v];
+      }
+      std::vector<std::size_t> next(offsets.begin(), offsets.end() - 1);
+      for (std::size_t i = 0; i < triangles.size(); ++i) {
+        triangles[next[indices[i]]++] = GLuint(i / 3);
+      }
+    }
+
+    std::vector<std::size_t> offsets;
+    std::vector<GLuint> triangles;
+  };
+}
+
+cache_stats analyze(std::vector<GLuint> const& indices, std::size_t vertex_num, unsigned cache_size) {
+  check_indices(indices, vertex_num);
+  // vertex is cached while less than cache_size other vertices were inserted after it
+  std::vector<std::size_t> cache_time(vertex_num, 0);
+  std::vector<bool> used(vertex_num, false);
+  std::size_t time = cache_size + 1;
+  std::size_t misses = 0;
+  std::size_t used_num = 0;
+  for (GLuint index : indices) {
+    if (time - cache_time[index] > cache_size) {
+      cache_time[index] = time++;
+      ++misses;
+    }
+    if (!used[index]) {
+      used[index] = true;
+      ++used_num;
+    }
+  }
+
+  std::size_t triangle_num = indices.size() / 3;
+  cache_stats stats{};
+  stats.acmr = triangle_num > 0 ? double(misses) / double(triangle_num) : 0.0;
+  stats.atvr = used_num > 0 ? double(misses) / double(used_num) : 0.0;
+  return stats;
+}
+
+// "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw", Sander et al. 2007
+std::vector<std::size_t> reorder_triangles(std::vector<GLuint>& indices, std::size_t vertex_num, unsigned cache_size) {
+  check_indices(indices, vertex_num);
+  std::size_t triangle_num = indices.size() / 3;
+  adjacency adjacent{indices, vertex_num};
+
+  // number of not yet emitted triangles of each vertex
+  std::vector<std::size_t> live(vertex_num);
+  for (std::size_t v = 0; v < vertex_num; ++v) {
+    live[v] = adjacent.offsets[v + 1] - adjacent.offsets[v];
+  }
+  std::vector<std::size_t> cache_time(vertex_num, 0);
+  std::vector<bool> emitted(triangle_num, false);
+  std::vector<GLuint> dead_end{};
+  std::vector<GLuint> candidates{};
+  std::vector<GLuint> result{};
+  result.reserve(triangle_num * 3);
+  std::size_t time = cache_size + 1;
+  std::size_t cursor = 0;
+
+  // recently used vertex with remaining triangles, otherwise next in input order
+  GLuint vertex = 0;
+  auto skip_dead_end = [&]() {
+    while (!dead_end.empty()) {
+      vertex = dead_end.back();
+      dead_end.pop_back();
+      if (live[vertex] > 0) return true;
+    }
+    for (; cursor < vertex_num; ++cursor) {
+      if (live[cursor] > 0) {
+        vertex = GLuint(cursor);
+        return true;
+      }
+    }
+    return false;
+  };
+
+  // jumps to unrelated vertices flush the cache and start a new cluster
+  std::vector<std::size_t> clusters{};
+  bool fanning = skip_dead_end();
+  bool new_cluster = true;
+  while (fanning) {
+    candidates.clear();
+    for (std::size_t i = adjacent.offsets[vertex]; i < adjacent.offsets[vertex + 1]; ++i) {
+      GLuint triangle = adjacent.triangles[i];
+      if (emitted[triangle]) continue;
+      if (new_cluster) {
+        clusters.push_back(result.size() / 3);
+        new_cluster = false;
+      }
+      for (std::size_t corner = 0; corner < 3; ++corner) {
+        GLuint v = indices[triangle * 3 + corner];
+        result.push_back(v);
+        dead_end.push_back(v);
+        candidates.push_back(v);
+        --live[v];
+        if (time - cache_time[v] > cache_size) {
+          cache_time[v] = time++;
+        }
+      }
+      emitted[triangle] = true;
+    }
+
+    // prefer oldest vertex which stays in cache while fanning its remaining triangles
+    std::ptrdiff_t best = -1;
+    for (GLuint v : candidates) {
+      if (live[v] == 0) continue;
+      std::ptrdiff_t priority = 0;
+      if (time - cache_time[v] + 2 * live[v] <= cache_size) {
+        priority = std::ptrdiff_t(time - cache_time[v]);
+      }
+      if (priority > best) {
+        best = priority;
+        vertex = v;
+      }
+    }
+    if (best < 0) {
+      fanning = skip_dead_end();
+      new_cluster = true;
+    }
+  }
+  // keep trailing indices of incomplete triangle
+  result.insert(result.end(), indices.begin() + std::ptrdiff_t(triangle_num * 3), indices.end());
+  indices.swap(result);
+
+  // split clusters where they already reuse the cache well, more clusters allow better overdraw order
+  std::vector<std::size_t> split{};
+  std::fill(cache_time.begin(), cache_time.end(), 0);
+  time = cache_size + 1;
+  std::size_t cluster_start = 0;
+  std::size_t cluster_misses = 0;
+  std::size_t next_cluster = 0;
+  for (std::size_t t = 0; t < triangle_num; ++t) {
+    bool hard_boundary = next_cluster < clusters.size() && clusters[next_cluster] == t;
+    bool soft_boundary = t - cluster_start >= cache_size && double(cluster_misses) / double(t - cluster_start) < CLUSTER_ACMR;
+    if (hard_boundary || soft_boundary) {
+      if (hard_boundary) ++next_cluster;
+      split.push_back(t);
+      cluster_start = t;
+      cluster_misses = 0;
+      // simulate flush at cluster start
+      time += cache_size + 1;
+    }
+    for (std::size_t corner = 0; corner < 3; ++corner) {
+      GLuint v = indices[t * 3 + corner];
+      if (time - cache_time[v] > cache_size) {
+        cache_time[v] = time++;
+        ++cluster_misses;
+      }
+    }
+  }
+  return split;
+}
+
+void reorder_clusters(std::vector<GLuint>& indices, std::vector<std::size_t> const& clusters,
+                      GLfloat const* positions, std::size_t vertex_stride) {
+  std::size_t triangle_num = indices.size() / 3;
+  if (clusters.size() < 2) return;
+
+  auto position = [&](GLuint index) {
+    GLfloat const* p = positions + std::size_t(index) * vertex_stride;
+    return glm::vec3{p[0], p[1], p[2]};
+  };
+
+  // area weighted centroid and normal of clusters and mesh
+  struct cluster {
+    std::size_t begin;
+    std::size_t end;
+    glm::vec3 centroid;
+    glm::vec3 normal;
+    float area;
+    float occlusion;
+  };
+  std::vector<cluster> ordered{};
+  glm::vec3 mesh_centroid{0.0f};
+  float mesh_area = 0.0f;
+  for (std::size_t c = 0; c < clusters.size(); ++c) {
+    cluster current{clusters[c], c + 1 < clusters.size() ? clusters[c + 1] : triangle_num, glm::vec3{0.0f}, glm::vec3{0.0f}, 0.0f, 0.0f};
+    for (std::size_t t = current.begin; t < current.end; ++t) {
+      glm::vec3 a = position(indices[t * 3]);
+      glm::vec3 b = position(indices[t * 3 + 1]);
+      glm::vec3 c = position(indices[t * 3 + 2]);
+      glm::vec3 normal = glm::cross(b - a, c - a);
+      float area = glm::length(normal) * 0.5f;
+      current.centroid += (a + b + c) * (area / 3.0f);
+      current.normal += normal;
+      current.area += area;
+    }
+    mesh_centroid += current.centroid;
+    mesh_area += current.area;
+    ordered.push_back(current);
+  }
+  if (mesh_area > 0.0f) {
+    mesh_centroid /= mesh_area;
+  }
+
+  // clusters facing away from the center are likely to occlude others
+  for (auto& current : ordered) {
+    if (current.area <= 0.0f) continue;
+    float normal_length = glm::length(current.normal);
+    glm::vec3 normal = normal_length > 0.0f ? current.normal / normal_length : current.normal;
+    current.occlusion = glm::dot(current.centroid / current.area - mesh_centroid, normal);
+  }
+  std::stable_sort(ordered.begin(), ordered.end(), [](cluster const& a, cluster const& b) {
+    return a.occlusion > b.occlusion;
+  });
+
+  std::vector<GLuint> result{};
+  result.reserve(indices.size());
+  for (auto const& current : ordered) {
+    result.insert(result.end(), indices.begin() + std::ptrdiff_t(current.begin * 3), indices.begin() + std::ptrdiff_t(current.end * 3));
+  }
+  result.insert(result.end(), indices.begin() + std::ptrdiff_t(triangle_num * 3), indices.end());
+  indices.swap(result);
+}
+
+void reorder_vertices(model& mesh) {
+  check_indices(mesh.indices, mesh.vertex_num);
+  std::size_t components = std::size_t(mesh.vertex_bytes) / sizeof(GLfloat);
+
+  std::vector<GLuint> remap(mesh.vertex_num, UNUSED);
+  GLuint next = 0;
+  for (GLuint& index : mesh.indices) {
+    if (remap[index] == UNUSED) {
+      remap[index] = next++;
+    }
+    index = remap[index];
+  }
+  for (auto& target : remap) {
+    if (target == UNUSED) {
+      target = next++;
+    }
+  }
+
+  std::vector<GLfloat> data(mesh.data.size());
+  for (std::size_t v = 0; v < mesh.vertex_num; ++v) {
+    std::copy(mesh.data.begin() + std::ptrdiff_t(v * components),
+              mesh.data.begin() + std::ptrdiff_t((v + 1) * components),
+              data.begin() + std::ptrdiff_t(remap[v] * components));
+  }
+  mesh.data.swap(data);
+}
+
+report optimize(model& mesh, unsigned cache_size) {
+  report result{};
+  result.before = analyze(mesh.indices, mesh.vertex_num, cache_size);
+
+  std::vector<std::size_t> clusters = reorder_triangles(mesh.indices, mesh.vertex_num, cache_size);
+  // positions are the first attribute
+  if (mesh.attributes & model::POSITION) {
+    reorder_clusters(mesh.indices, clusters, mesh.data.data(), std::size_t(mesh.vertex_bytes) / sizeof(GLfloat));
+  }
+  reorder_vertices(mesh);
+
+  result.after = analyze(mesh.indices, mesh.vertex_num, cache_size);
+  result.clusters = clusters.size();
+  return result;
+}
+
+std::ostream& operator<<(std::ostream& os, report const& result) {
+  os << "ACMR " << result.before.acmr << " -> " << result.after.acmr
+     << ", ATVR " << result.before.atvr << " -> " << result.after.atvr
+     << ", " << result.clusters << " clusters";
+  return os;
+}
+
+};
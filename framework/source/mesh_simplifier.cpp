@@ -0,0 +1,296 @@
+#include "mesh_simplifier.hpp"
+
+#include "mesh_optimizer.hpp"
+
+#include <glm/geometric.hpp>
+#include <glm/vec3.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <queue>
+#include <unordered_map>
+
+namespace mesh_simplifier {
+
+namespace {
+  // collapses bending a triangle normal further are rejected
+  const double MIN_NORMAL_COSINE = 0.25;
+
+  // symmetric 4x4 matrix summing squared distances to planes, error of point is p^T Q p
+  struct quadric {
+    static quadric plane(glm::dvec3 const& n, double d) {
+      quadric q{};
+      q.a[0] = n.x * n.x; q.a[1] = n.x * n.y; q.a[2] = n.x * n.z; q.a[3] = n.x * d;
+      q.a[4] = n.y * n.y; q.a[5] = n.y * n.z; q.a[6] = n.y * d;
+      q.a[7] = n.z * n.z; q.a[8] = n.z * d;
+      q.a[9] = d * d;
+      return q;
+    }
+
+    void add(quadric const& other) {
+      for (int i = 0; i < 10; ++i) {
+        a[i] += other.a[i];
+      }
+    }
+
+    double error(glm::dvec3 const& p) const {
+      return a[0] * p.x * p.x + 2.0 * a[1] * p.x * p.y + 2.0 * a[2] * p.x * p.z + 2.0 * a[3] * p.x
+           + a[4] * p.y * p.y + 2.0 * a[5] * p.y * p.z + 2.0 * a[6] * p.y
+           + a[7] * p.z * p.z + 2.0 * a[8] * p.z
+           + a[9];
+    }
+
+    double a[10];
+  };
+
+  // moving vertex from onto vertex to, entries are outdated when a version changed
+  struct collapse {
+    double cost;
+    GLuint from;
+    GLuint to;
+    unsigned from_version;
+    unsigned to_version;
+
+    bool operator>(collapse const& other) const {
+      return cost > other.cost;
+    }
+  };
+
+  // edge collapse state, reduce can be called repeatedly with decreasing targets
+  class simplifier {
+   public:
+    simplifier(GLfloat const* data, model const& layout, GLuint const* indices, std::size_t index_num)
+     :m_positions(layout.vertex_num)
+     ,m_indices(indices, indices + index_num / 3 * 3)
+     ,m_alive(index_num / 3, true)
+     ,m_vertex_triangles(layout.vertex_num)
+     ,m_quadrics(layout.vertex_num, quadric{})
+     ,m_locked(layout.vertex_num, false)
+     ,m_removed(layout.vertex_num, false)
+     ,m_versions(layout.vertex_num, 0)
+     ,m_collapses{}
+     ,m_live{index_num / 3}
+     ,m_max_cost{0.0}
+    {
+      // positions are the first attribute
+      std::size_t stride = std::size_t(layout.vertex_bytes) / sizeof(GLfloat);
+      for (std::size_t v = 0; v < layout.vertex_num; ++v) {
+        m_positions[v] = glm::dvec3{data[v * stride], data[v * stride + 1], data[v * stride + 2]};
+      }
+
+      std::unordered_map<std::uint64_t, unsigned> edge_count{};
+      for (GLuint t = 0; t < m_alive.size(); ++t) {
+        GLuint const* triangle = &m_indices[t * 3];
+        glm::dvec3 normal = glm::cross(m_positions[triangle[1]] - m_positions[triangle[0]], m_positions[triangle[2]] - m_positions[triangle[0]]);
+        double length = glm::length(normal);
+        quadric plane{};
+        if (length > 0.0) {
+          normal /= length;
+          plane = quadric::plane(normal, -glm::dot(normal, m_positions[triangle[0]]));
+        }
+        for (std::size_t corner = 0; corner < 3; ++corner) {
+          m_vertex_triangles[triangle[corner]].push_back(t);
+          m_quadrics[triangle[corner]].add(plane);
+          GLuint a = triangle[corner];
+          GLuint b = triangle[(corner + 1) % 3];
+          ++edge_count[std::uint64_t(std::min(a, b)) << 32 | std::max(a, b)];
+        }
+      }
+      // open borders and attribute seams only have one triangle per edge
+      for (auto const& edge : edge_count) {
+        if (edge.second == 1) {
+          m_locked[edge.first >> 32] = true;
+          m_locked[edge.first & 0xffffffffu] = true;
+        }
+      }
+
+      for (GLuint v = 0; v < m_positions.size(); ++v) {
+        push_collapses(v);
+      }
+    }
+
+    void reduce(std::size_t target) {
+      while (m_live > target && !m_collapses.empty()) {
+        collapse next = m_collapses.top();
+        m_collapses.pop();
+        if (m_removed[next.from] || m_removed[next.to]
+         || m_versions[next.from] != next.from_version
+         || m_versions[next.to] != next.to_version
+         || !valid(next.from, next.to)) {
+          continue;
+        }
+        apply(next);
+      }
+    }
+
+    std::vector<GLuint> triangles() const {
+      std::vector<GLuint> result{};
+      result.reserve(m_live * 3);
+      for (std::size_t t = 0; t < m_alive.size(); ++t) {
+        if (m_alive[t]) {
+          result.insert(result.end(), &m_indices[t * 3], &m_indices[t * 3] + 3);
+        }
+      }
+      return result;
+    }
+
+    // approximate largest distance to original surface
+    float error() const {
+      return float(std::sqrt(std::max(m_max_cost, 0.0)));
+    }
+
+   private:
+    // vertices sharing an alive triangle with vertex
+    std::vector<GLuint> neighbours(GLuint vertex) const {
+      std::vector<GLuint> result{};
+      for (GLuint t : m_vertex_triangles[vertex]) {
+        if (!m_alive[t]) continue;
+        for (std::size_t corner = 0; corner < 3; ++corner) {
+          if (m_indices[t * 3 + corner] != vertex) {
+            result.push_back(m_indices[t * 3 + corner]);
+          }
+        }
+      }
+      std::sort(result.begin(), result.end());
+      result.erase(std::unique(result.begin(), result.end()), result.end());
+      return result;
+    }
+
+    void push_collapses(GLuint vertex) {
+      for (GLuint neighbour : neighbours(vertex)) {
+        if (!m_locked[vertex]) push(vertex, neighbour);
+        if (!m_locked[neighbour]) push(neighbour, vertex);
+      }
+    }
+
+    void push(GLuint from, GLuint to) {
+      quadric sum = m_quadrics[from];
+      sum.add(m_quadrics[to]);
+      m_collapses.push(collapse{sum.error(m_positions[to]), from, to, m_versions[from], m_versions[to]});
+    }
+
+    // keeps the surface manifold and triangles from flipping
+    bool valid(GLuint from, GLuint to) const {
+      std::size_t shared = 0;
+      for (GLuint t : m_vertex_triangles[from]) {
+        if (!m_alive[t]) continue;
+        GLuint const* triangle = &m_indices[t * 3];
+        if (triangle[0] == to || triangle[1] == to || triangle[2] == to) {
+          ++shared;
+          continue;
+        }
+        glm::dvec3 corners[3] = {m_positions[triangle[0]], m_positions[triangle[1]], m_positions[triangle[2]]};
+        glm::dvec3 before = glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+        for (auto& corner : corners) {
+          if (corner == m_positions[from]) corner = m_positions[to];
+        }
+        glm::dvec3 after = glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+        if (glm::dot(before, after) < MIN_NORMAL_COSINE * glm::length(before) * glm::length(after)) {
+          return false;
+        }
+      }
+      // link condition, only the vertices opposite of the edge may be common neighbours
+      std::vector<GLuint> from_neighbours = neighbours(from);
+      std::vector<GLuint> to_neighbours = neighbours(to);
+      std::vector<GLuint> common{};
+      std::set_intersection(from_neighbours.begin(), from_neighbours.end(), to_neighbours.begin(), to_neighbours.end(), std::back_inserter(common));
+      return shared > 0 && common.size() == shared;
+    }
+
+    void apply(collapse const& edge) {
+      for (GLuint t : m_vertex_triangles[edge.from]) {
+        if (!m_alive[t]) continue;
+        GLuint* triangle = &m_indices[t * 3];
+        if (triangle[0] == edge.to || triangle[1] == edge.to || triangle[2] == edge.to) {
+          m_alive[t] = false;
+          --m_live;
+          continue;
+        }
+        std::replace(triangle, triangle + 3, edge.from, edge.to);
+        m_vertex_triangles[edge.to].push_back(t);
+      }
+      m_vertex_triangles[edge.from].clear();
+      auto& to_triangles = m_vertex_triangles[edge.to];
+      to_triangles.erase(std::remove_if(to_triangles.begin(), to_triangles.end(), [this](GLuint t) {
+        return !m_alive[t];
+      }), to_triangles.end());
+
+      m_quadrics[edge.to].add(m_quadrics[edge.from]);
+      m_removed[edge.from] = true;
+      ++m_versions[edge.to];
+      m_max_cost = std::max(m_max_cost, edge.cost);
+      push_collapses(edge.to);
+    }
+
+    std::vector<glm::dvec3> m_positions;
+    std::vector<GLuint> m_indices;
+    std::vector<bool> m_alive;
+    std::vector<std::vector<GLuint>> m_vertex_triangles;
+    std::vector<quadric> m_quadrics;
+    std::vector<bool> m_locked;
+    std::vector<bool> m_removed;
+    std::vector<unsigned> m_versions;
+    std::priority_queue<collapse, std::vector<collapse>, std::greater<collapse>> m_collapses;
+    std::size_t m_live;
+    double m_max_cost;
+  };
+}
+
+std::vector<GLuint> simplify(GLfloat const* data, model const& layout, GLuint const* indices, std::size_t index_num,
+                             std::size_t target_triangles, float* error) {
+  simplifier collapser{data, layout, indices, index_num};
+  collapser.reduce(target_triangles);
+  if (error) {
+    *error = collapser.error();
+  }
+  return collapser.triangles();
+}
+
+lod_chain build_lods(GLfloat const* data, model const& layout, GLuint const* indices, std::size_t index_num,
+                     std::vector<float> const& ratios) {
+  lod_chain chain{};
+  std::size_t triangle_num = index_num / 3;
+  simplifier collapser{data, layout, indices, index_num};
+
+  for (float ratio : ratios) {
+    std::vector<GLuint> level{};
+    if (ratio >= 1.0f) {
+      // keep order of source, it may be optimized for overdraw
+      level.assign(indices, indices + triangle_num * 3);
+    }
+    else {
+      // levels continue from the previous one
+      collapser.reduce(std::size_t(double(ratio) * double(triangle_num)));
+      level = collapser.triangles();
+      // mesh can not be reduced further
+      if (!chain.levels.empty() && GLsizei(level.size()) >= chain.levels.back().num_elements) break;
+      std::vector<std::size_t> clusters = mesh_optimizer::reorder_triangles(level, layout.vertex_num);
+      mesh_optimizer::reorder_clusters(level, clusters, data, std::size_t(layout.vertex_bytes) / sizeof(GLfloat));
+    }
+    chain.levels.push_back(lod_range{GLsizei(chain.indices.size()), GLsizei(level.size()), ratio >= 1.0f ? 0.0f : collapser.error()});
+    chain.indices.insert(chain.indices.end(), level.begin(), level.end());
+  }
+  return chain;
+}
+
+std::size_t select_level(std::vector<lod_range> const& levels, float pixels_per_unit, std::size_t current,
+                         float threshold, float hysteresis) {
+  // full detail if camera is inside or size is unknown
+  if (levels.empty() || !(pixels_per_unit < std::numeric_limits<float>::max())) {
+    return 0;
+  }
+  std::size_t level = std::min(current, levels.size() - 1);
+  while (level > 0 && levels[level].error * pixels_per_unit > threshold) {
+    --level;
+  }
+  while (level + 1 < levels.size() && levels[level + 1].error * pixels_per_unit < threshold * (1.0f - hysteresis)) {
+    ++level;
+  }
+  return level;
+}
+
+};
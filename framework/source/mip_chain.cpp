@@ -0,0 +1,231 @@
+#include "mip_chain.hpp"
+
+#include "parallel.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+
+// SSE2 is available on every x86-64 target
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MIP_CHAIN_SSE
+#include <emmintrin.h>
+#endif
+
+namespace mip_chain {
+
+namespace {
+  // target texels per work item, smaller levels are filtered by one thread
+  const std::size_t CHUNK_TEXELS = std::size_t(1) << 14;
+  // resolution of the table encoding linear values
+  const std::size_t ENCODE_STEPS = std::size_t(1) << 16;
+
+  float decode_srgb(float value) {
+    return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+  }
+
+  // conversion of 8 bit values to [0, 1] and back, with and without the srgb curve
+  struct conversion_tables {
+    float srgb_to_linear[256];
+    float unorm_to_float[256];
+    std::uint8_t linear_to_srgb[ENCODE_STEPS];
+
+    conversion_tables() {
+      for (std::size_t i = 0; i < 256; ++i) {
+        unorm_to_float[i] = float(i) / 255.0f;
+        srgb_to_linear[i] = decode_srgb(float(i) / 255.0f);
+      }
+      // nearest srgb value, code advances when linear value passes the midpoint to the next one
+      std::size_t code = 0;
+      for (std::size_t i = 0; i < ENCODE_STEPS; ++i) {
+        float linear = float(i) / float(ENCODE_STEPS - 1);
+        while (code < 255 && linear > decode_srgb((float(code) + 0.5f) / 255.0f)) {
+          ++code;
+        }
+        linear_to_srgb[i] = std::uint8_t(code);
+      }
+    }
+  };
+  // built during static initialization, before any worker can read it
+  const conversion_tables TABLES{};
+
+  // channels following the srgb curve, the second of two channels is alpha of grey images
+  std::size_t color_count(std::size_t channels) {
+    return channels < 3 ? 1 : 3;
+  }
+
+  // source texels of one target texel along an axis
+  // even sizes average pairs, odd sizes weight three texels so each source texel contributes equally
+  struct tap {
+    std::size_t first;
+    std::size_t count;
+    float weights[3];
+  };
+
+  std::vector<tap> compute_taps(std::size_t source, std::size_t target) {
+    std::vector<tap> taps(target);
+    for (std::size_t t = 0; t < target; ++t) {
+      tap& current = taps[t];
+      current.first = std::min(2 * t, source - 1);
+      if (source == 1) {
+        current.count = 1;
+        current.weights[0] = 1.0f;
+      }
+      else if (source % 2 == 0) {
+        current.count = 2;
+        current.weights[0] = 0.5f;
+        current.weights[1] = 0.5f;
+      }
+      else {
+        float n = float(target);
+        float sum = 2.0f * n + 1.0f;
+        current.count = 3;
+        current.weights[0] = (n - float(t)) / sum;
+        current.weights[1] = n / sum;
+        current.weights[2] = (float(t) + 1.0f) / sum;
+      }
+    }
+    return taps;
+  }
+
+  // row of 8 bit texels to four floats per texel in linear space
+  void decode_row(std::uint8_t const* source, std::size_t width, std::size_t channels,
+                  float const* const* decoders, float* target) {
+    for (std::size_t x = 0; x < width; ++x) {
+      std::uint8_t const* texel = source + x * channels;
+      float* out = target + x * 4;
+      for (std::size_t c = 0; c < 4; ++c) {
+        out[c] = c < channels ? decoders[c][texel[c]] : 0.0f;
+      }
+    }
+  }
+
+  // weighted sum of source rows
+  void combine_rows(float const* const* rows, tap const& vertical, std::size_t size, float* target) {
+    std::size_t i = 0;
+#ifdef MIP_CHAIN_SSE
+    __m128 w0 = _mm_set1_ps(vertical.weights[0]);
+    __m128 w1 = _mm_set1_ps(vertical.count > 1 ? vertical.weights[1] : 0.0f);
+    __m128 w2 = _mm_set1_ps(vertical.count > 2 ? vertical.weights[2] : 0.0f);
+    float const* r1 = rows[vertical.count > 1 ? 1 : 0];
+    float const* r2 = rows[vertical.count > 2 ? 2 : 0];
+    for (; i + 4 <= size; i += 4) {
+      __m128 sum = _mm_mul_ps(_mm_loadu_ps(rows[0] + i), w0);
+      sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(r1 + i), w1));
+      sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(r2 + i), w2));
+      _mm_storeu_ps(target + i, sum);
+    }
+#endif
+    for (; i < size; ++i) {
+      float sum = 0.0f;
+      for (std::size_t k = 0; k < vertical.count; ++k) {
+        sum += rows[k][i] * vertical.weights[k];
+      }
+      target[i] = sum;
+    }
+  }
+
+  // horizontal filter of combined row, one texel of four floats at a time
+  void filter_row(float const* row, std::vector<tap> const& horizontal, float* target) {
+    for (std::size_t x = 0; x < horizontal.size(); ++x) {
+      tap const& current = horizontal[x];
+      float const* source = row + current.first * 4;
+#ifdef MIP_CHAIN_SSE
+      __m128 sum = _mm_mul_ps(_mm_loadu_ps(source), _mm_set1_ps(current.weights[0]));
+      for (std::size_t k = 1; k < current.count; ++k) {
+        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(source + k * 4), _mm_set1_ps(current.weights[k])));
+      }
+      _mm_storeu_ps(target + x * 4, sum);
+#else
+      for (std::size_t c = 0; c < 4; ++c) {
+        float sum = 0.0f;
+        for (std::size_t k = 0; k < current.count; ++k) {
+          sum += source[k * 4 + c] * current.weights[k];
+        }
+        target[x * 4 + c] = sum;
+      }
+#endif
+    }
+  }
+
+  // four floats per texel back to 8 bit
+  void encode_row(float const* source, std::size_t width, std::size_t channels, bool const* srgb, std::uint8_t* target) {
+    for (std::size_t x = 0; x < width; ++x) {
+      float const* texel = source + x * 4;
+      std::uint8_t* out = target + x * channels;
+      for (std::size_t c = 0; c < channels; ++c) {
+        float value = std::min(std::max(texel[c], 0.0f), 1.0f);
+        out[c] = srgb[c] ? TABLES.linear_to_srgb[std::size_t(value * float(ENCODE_STEPS - 1) + 0.5f)]
+                         : std::uint8_t(value * 255.0f + 0.5f);
+      }
+    }
+  }
+}
+
+std::size_t level_num(std::size_t width, std::size_t height) {
+  std::size_t num = 1;
+  while (width > 1 || height > 1) {
+    width = std::max(width / 2, std::size_t(1));
+    height = std::max(height / 2, std::size_t(1));
+    ++num;
+  }
+  return num;
+}
+
+pixel_data next_level(pixel_data const& image, bool srgb) {
+  if (image.channel_type != GL_UNSIGNED_BYTE) {
+    throw std::invalid_argument("Mip chain: no 8 bit image");
+  }
+  std::size_t channels = channel_count(image.channels);
+  if (image.width == 0 || image.height == 0 || image.pixels.size() < image.width * image.height * channels) {
+    throw std::invalid_argument("Mip chain: image has too few pixels");
+  }
+  std::size_t width = std::max(image.width / 2, std::size_t(1));
+  std::size_t height = std::max(image.height / 2, std::size_t(1));
+  std::vector<tap> horizontal = compute_taps(image.width, width);
+  std::vector<tap> vertical = compute_taps(image.height, height);
+
+  float const* decoders[4] = {};
+  bool encode_srgb[4] = {};
+  for (std::size_t c = 0; c < channels; ++c) {
+    encode_srgb[c] = srgb && c < color_count(channels);
+    decoders[c] = encode_srgb[c] ? TABLES.srgb_to_linear : TABLES.unorm_to_float;
+  }
+
+  std::vector<std::uint8_t> pixels(width * height * channels);
+  std::size_t rows_per_chunk = std::max(CHUNK_TEXELS / width, std::size_t(1));
+  std::size_t chunk_num = (height + rows_per_chunk - 1) / rows_per_chunk;
+  parallel::for_each(chunk_num, [&](std::size_t chunk) {
+    std::size_t source_row_size = image.width * 4;
+    std::vector<float> decoded(source_row_size * 3);
+    std::vector<float> combined(source_row_size);
+    std::vector<float> filtered(width * 4);
+    std::size_t end = std::min(height, (chunk + 1) * rows_per_chunk);
+    for (std::size_t y = chunk * rows_per_chunk; y < end; ++y) {
+      tap const& rows = vertical[y];
+      float const* sources[3] = {};
+      for (std::size_t k = 0; k < rows.count; ++k) {
+        float* target = &decoded[k * source_row_size];
+        decode_row(&image.pixels[(rows.first + k) * image.width * channels], image.width, channels, decoders, target);
+        sources[k] = target;
+      }
+      combine_rows(sources, rows, source_row_size, combined.data());
+      filter_row(combined.data(), horizontal, filtered.data());
+      encode_row(filtered.data(), width, channels, encode_srgb, &pixels[y * width * channels]);
+    }
+  });
+  return pixel_data{pixels, image.channels, image.channel_type, width, height};
+}
+
+std::vector<pixel_data> build(pixel_data const& image, bool srgb) {
+  std::vector<pixel_data> levels{};
+  levels.reserve(level_num(image.width, image.height));
+  levels.push_back(image);
+  while (levels.back().width > 1 || levels.back().height > 1) {
+    levels.push_back(next_level(levels.back(), srgb));
+  }
+  return levels;
+}
+
+};
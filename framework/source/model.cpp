@@ -20,9 +20,17 @@ model::attribute const& model::TANGENT = model::VERTEX_ATTRIBS[3];
 model::attribute const& model::BITANGENT = model::VERTEX_ATTRIBS[4];
 model::attribute const  model::INDEX{1 << 5, sizeof(unsigned),  1, GL_UNSIGNED_INT};
 
+model::attribute const  model::POSITION_HALF{   1 << 0, sizeof(GLhalf),   4, GL_HALF_FLOAT};
+model::attribute const  model::TEXCOORD_HALF{   1 << 2, sizeof(GLhalf),   2, GL_HALF_FLOAT};
+model::attribute const  model::NORMAL_PACKED{   1 << 1, 1,                4, GL_INT_2_10_10_10_REV, true};
+model::attribute const  model::TANGENT_PACKED{  1 << 3, 1,                4, GL_INT_2_10_10_10_REV, true};
+model::attribute const  model::BITANGENT_PACKED{1 << 4, 1,                4, GL_INT_2_10_10_10_REV, true};
+model::attribute const  model::INDEX_SHORT{     1 << 5, sizeof(GLushort), 1, GL_UNSIGNED_SHORT};
+
 model::model()
  :data{}
  ,indices{}
+ ,attributes{0}
  ,offsets{}
  ,vertex_bytes{0}
  ,vertex_num{0}
@@ -31,6 +39,7 @@ model::model()
 model::model(std::vector<GLfloat> const& databuff, attrib_flag_t contained_attributes, std::vector<GLuint> const& trianglebuff)
  :data(databuff)
  ,indices(trianglebuff)
+ ,attributes{contained_attributes}
  ,offsets{}
  ,vertex_bytes{0}
  ,vertex_num{0}
@@ -1,22 +1,17 @@
 #include "model_loader.hpp"
-
-// use floats and med precision operations
-#include <glm/gtc/type_precision.hpp>
-#include <glm/geometric.hpp>
+#include "obj_parser.hpp"
+#include "mesh_attributes.hpp"
+#include "mesh_optimizer.hpp"
 
 #include <iostream>
 
 namespace model_loader {
 
-void generate_normals(tinyobj::mesh_t& model);
-
-std::vector<glm::fvec3> generate_tangents(tinyobj::mesh_t const& model);
-
-model obj(std::string const& name, model::attrib_flag_t import_attribs){
+model obj(std::string const& name, model::attrib_flag_t import_attribs, bool optimize){
   std::vector<tinyobj::shape_t> shapes;
   std::vector<tinyobj::material_t> materials;
 
-  std::string err = tinyobj::LoadObj(shapes, materials, name.c_str());
+  std::string err = obj_parser::load(shapes, materials, name);
 
   if (!err.empty()) {
     if (err[0] == 'W' && err[1] == 'A' && err[2] == 'R') {
@@ -41,7 +36,7 @@ model obj(std::string const& name, model::attrib_flag_t import_attribs){
     if(has_normals) {
       // generate normals if necessary
       if (curr_mesh.normals.empty()) {
-        generate_normals(curr_mesh);
+        curr_mesh.normals = mesh_attributes::normals(curr_mesh.positions, curr_mesh.indices);
       }
     }
 
@@ -55,7 +50,7 @@ model obj(std::string const& name, model::attrib_flag_t import_attribs){
     }
 
     bool has_tangents = import_attribs & model::TANGENT;
-    std::vector<glm::fvec3> tangents;
+    std::vector<float> tangents;
     if (has_tangents) {
       if (!has_uvs) {
         has_tangents = false;
@@ -63,7 +58,11 @@ model obj(std::string const& name, model::attrib_flag_t import_attribs){
         std::cerr << "Shape has no texcoords" << std::endl;
       }
       else {
-        tangents = generate_tangents(curr_mesh);
+        // tangents are orthogonalized against normals
+        if (curr_mesh.normals.empty()) {
+          curr_mesh.normals = mesh_attributes::normals(curr_mesh.positions, curr_mesh.indices);
+        }
+        tangents = mesh_attributes::tangents(curr_mesh.positions, curr_mesh.normals, curr_mesh.texcoords, curr_mesh.indices);
       }
     }
 
@@ -85,9 +84,9 @@ model obj(std::string const& name, model::attrib_flag_t import_attribs){
       }
 
       if (has_tangents) {
-        vertex_data.push_back(tangents[i].x);
-        vertex_data.push_back(tangents[i].y);
-        vertex_data.push_back(tangents[i].z);
+        vertex_data.push_back(tangents[i * 3]);
+        vertex_data.push_back(tangents[i * 3 + 1]);
+        vertex_data.push_back(tangents[i * 3 + 2]);
       }
     }
 
@@ -99,82 +98,30 @@ model obj(std::string const& name, model::attrib_flag_t import_attribs){
     vertex_offset += unsigned(curr_mesh.positions.size() / 3);
   }
 
-  return model{vertex_data, attributes, triangles};
-}
-
-void generate_normals(tinyobj::mesh_t& model) {
-  std::vector<glm::fvec3> positions(model.positions.size() / 3);
-
-  for (unsigned i = 0; i < model.positions.size(); i+=3) {
-    positions[i / 3] = glm::fvec3{model.positions[i], model.positions[i + 1], model.positions[i + 2]};
-  }
-
-  std::vector<glm::fvec3> normals(model.positions.size() / 3, glm::fvec3{0.0f});
-  for (unsigned i = 0; i < model.indices.size(); i+=3) {
-    glm::fvec3 normal = glm::cross(positions[model.indices[i+1]] - positions[model.indices[i]], positions[model.indices[i+2]] - positions[model.indices[i]]);
-
-    normals[model.indices[i]] += normal;
-    normals[model.indices[i+1]] += normal;
-    normals[model.indices[i+2]] += normal;
-  }
-
-  model.normals.reserve(model.positions.size());
-  for (unsigned i = 0; i < normals.size(); ++i) {
-    glm::fvec3 normal = glm::normalize(normals[i]);
-    model.normals[i * 3] = normal[0];
-    model.normals[i * 3 + 1] = normal[1];
-    model.normals[i * 3 + 2] = normal[2];
+  model result{vertex_data, attributes, triangles};
+  if (optimize) {
+    mesh_optimizer::report optimized = mesh_optimizer::optimize(result);
+    std::cout << "Optimized " << name << " - " << optimized << std::endl;
   }
+  return result;
 }
 
-std::vector<glm::fvec3> generate_tangents(tinyobj::mesh_t const& model) {
-  // containers for vertex attributes
-  std::vector<glm::fvec3> positions(model.positions.size() / 3);
-  std::vector<glm::fvec3> normals(model.positions.size() / 3);
-  std::vector<glm::fvec2> texcoords(model.positions.size() / 3);
-  std::vector<glm::fvec3> tangents(model.positions.size() / 3, glm::fvec3{0.0f});
-
-  // get vertex positions and texture coordinates from mesh_t
-  for (unsigned i = 0; i < model.positions.size(); i+=3) {
-    positions[i / 3] = glm::fvec3{model.positions[i],
-                                 model.positions[i + 1],
-                                 model.positions[i + 2]};
-    normals[i / 3] = glm::fvec3{model.normals[i],
-                                 model.normals[i + 1],
-                                 model.normals[i + 2]};
-  }
-  for (unsigned i = 0; i < model.texcoords.size(); i+=2) {
-    texcoords[i / 2] = glm::fvec2{model.texcoords[i], model.texcoords[i + 1]};
-  }
+mesh_cache::cached_model cached_obj(std::string const& path, model::attrib_flag_t import_attribs, bool optimize) {
+  std::uint64_t source_hash = mesh_cache::hash_file(path);
+  std::string cache_path = mesh_cache::cache_path(path, import_attribs, optimize);
 
-  // calculate tangent for triangles
-  for (unsigned i = 0; i < model.indices.size() / 3; i++) {
-    // indices of vertices of this triangle
-    unsigned indices[3] = {model.indices[i * 3],
-                           model.indices[i * 3 + 1],
-                           model.indices[i * 3 + 2]};
-    // access an attribute of xth vert with vector access "attribute[indices[x]]"
-    
-      
-      glm::fvec3 d_p1 = positions[indices[1]] - positions[indices[0]];
-      glm::fvec3 d_p2 = positions[indices[2]] - positions[indices[0]];
-      glm::fvec2 d_t1 = texcoords[indices[1]] - texcoords[indices[0]];
-      glm::fvec2 d_t2 = texcoords[indices[2]] - texcoords[indices[0]];
-      float r = 1.0f / (d_t1.x * d_t2.y - d_t1.y * d_t2.x);
-      glm::vec3 tangent = (d_p1 * d_t2.y - d_p2 * d_t1.y) * r;
-      tangents[indices[0]] += tangent;
-      tangents[indices[1]] += tangent;
-      tangents[indices[2]] += tangent;
-    // calculate tangent for the triangle and add it to the accumulation tangents of the adjacent vertices
-    // see generate_normals() for similar workflow 
-  }
-  // normalize and orthogonalize accumulated vertex tangents
-  for (unsigned i = 0; i < tangents.size(); ++i) {
-    // implement orthogonalization and normalization here
-      tangents[i] = glm::normalize(tangents[i] - normals[i] * glm::dot(normals[i], tangents[i]));
+  mesh_cache::cached_model cached{cache_path};
+  if (cached.valid()
+   && cached.file_header().source_hash == source_hash
+   && cached.file_header().import_attribs == import_attribs) {
+    return cached;
   }
 
-  return tangents;
+  model imported = obj(path, import_attribs, optimize);
+  if (!mesh_cache::store(cache_path, source_hash, import_attribs, imported)) {
+    std::cerr << "Could not write mesh cache " << cache_path << std::endl;
+  }
+  return mesh_cache::cached_model{std::move(imported)};
 }
 
 };
\ No newline at end of file
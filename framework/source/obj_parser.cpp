@@ -0,0 +1,628 @@
+#include "obj_parser.hpp"
+
+#include "mapped_file.hpp"
+#include "parallel.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+
+namespace obj_parser {
+
+namespace {
+  // smaller files are parsed by a single thread
+  const std::size_t MIN_CHUNK_SIZE = 1 << 20;
+  // chunks per thread, for balancing of uneven chunks
+  const std::size_t CHUNKS_PER_THREAD = 4;
+  // marks empty slot in vertex table
+  const unsigned EMPTY = std::numeric_limits<unsigned>::max();
+
+  // zero-based indices of one face corner, -1 if attribute is absent
+  struct face_vertex {
+    int v;
+    int vt;
+    int vn;
+  };
+
+  bool operator==(face_vertex const& a, face_vertex const& b) {
+    return a.v == b.v && a.vt == b.vt && a.vn == b.vn;
+  }
+
+  // statements that end the current face group
+  enum class statement_kind {
+    usemtl,
+    mtllib,
+    group,
+    object
+  };
+
+  struct statement {
+    statement_kind kind;
+    // number of faces in chunk before statement
+    std::size_t face;
+    std::string name;
+  };
+
+  // parse result of a range of complete lines
+  struct chunk {
+    char const* begin;
+    char const* end;
+    std::vector<float> v;
+    std::vector<float> vn;
+    std::vector<float> vt;
+    std::vector<face_vertex> corners;
+    // first corner of each face, last entry is number of corners
+    std::vector<std::size_t> faces;
+    std::vector<statement> statements;
+    // corner components with relative indices, offset of previous chunks is added later
+    std::vector<std::size_t> relative;
+  };
+
+  // faces of one chunk belonging to a face group
+  struct segment {
+    std::size_t chunk;
+    std::size_t face_begin;
+    std::size_t face_end;
+    // corners in order of first use by triangles
+    std::vector<face_vertex> unique;
+    // triangle corners as indices into unique, replaced by shape indices
+    std::vector<unsigned> indices;
+    // shape index of each unique corner
+    std::vector<unsigned> remap;
+    // first triangle in shape
+    std::size_t triangle_offset;
+  };
+
+  // faces between two statements, becomes one shape
+  struct face_group {
+    std::string name;
+    int material;
+    std::vector<std::size_t> segments;
+  };
+
+  // open addressing hash map from corner to index, with linear probing
+  class vertex_table {
+   public:
+    vertex_table(std::size_t expected)
+     :m_slots{}
+     ,m_mask{0}
+     ,m_size{0}
+    {
+      std::size_t capacity = 16;
+      while (capacity < expected * 2) capacity *= 2;
+      m_slots.resize(capacity, slot{face_vertex{0, 0, 0}, EMPTY});
+      m_mask = capacity - 1;
+    }
+
+    // index of corner, inserts given index if corner is new
+    unsigned insert(face_vertex const& key, unsigned value) {
+      if ((m_size + 1) * 2 > m_slots.size()) {
+        grow();
+      }
+      for (std::size_t i = hash(key) & m_mask; ; i = (i + 1) & m_mask) {
+        if (m_slots[i].value == EMPTY) {
+          m_slots[i] = slot{key, value};
+          ++m_size;
+          return value;
+        }
+        if (m_slots[i].key == key) {
+          return m_slots[i].value;
+        }
+      }
+    }
+
+    std::size_t size() const {
+      return m_size;
+    }
+
+   private:
+    struct slot {
+      face_vertex key;
+      unsigned value;
+    };
+
+    static std::size_t hash(face_vertex const& key) {
+      std::uint64_t h = std::uint64_t(std::uint32_t(key.v)) * 0x9E3779B97F4A7C15ull;
+      h ^= std::uint64_t(std::uint32_t(key.vt)) * 0xC2B2AE3D27D4EB4Full;
+      h ^= std::uint64_t(std::uint32_t(key.vn)) * 0x165667B19E3779F9ull;
+      return std::size_t(h ^ (h >> 32));
+    }
+
+    void grow() {
+      std::vector<slot> old{};
+      old.swap(m_slots);
+      m_slots.resize(old.size() * 2, slot{face_vertex{0, 0, 0}, EMPTY});
+      m_mask = m_slots.size() - 1;
+      for (auto const& s : old) {
+        if (s.value == EMPTY) continue;
+        std::size_t i = hash(s.key) & m_mask;
+        while (m_slots[i].value != EMPTY) i = (i + 1) & m_mask;
+        m_slots[i] = s;
+      }
+    }
+
+    std::vector<slot> m_slots;
+    std::size_t m_mask;
+    std::size_t m_size;
+  };
+
+  // powers 10^-n computed like tinyobj, so parsed values are identical
+  std::vector<double> negative_powers() {
+    std::vector<double> powers(32);
+    for (std::size_t i = 0; i < powers.size(); ++i) {
+      powers[i] = std::pow(10.0, -int(i));
+    }
+    return powers;
+  }
+  std::vector<double> const NEGATIVE_POWERS = negative_powers();
+
+  inline bool is_space(char c) {
+    return c == ' ' || c == '\t';
+  }
+
+  inline bool is_digit(char c) {
+    return c >= '0' && c <= '9';
+  }
+
+  // whitespace as skipped by sscanf and atoi
+  inline bool is_whitespace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f' || c == '\n';
+  }
+
+  inline char const* skip_space(char const* p, char const* end) {
+    while (p < end && is_space(*p)) ++p;
+    return p;
+  }
+
+  // same grammar and arithmetic as tinyobj tryParseDouble, without per-digit pow
+  bool parse_double(char const* s, char const* s_end, double& result) {
+    if (s >= s_end) return false;
+
+    double mantissa = 0.0;
+    int exponent = 0;
+    char sign = '+';
+    char exp_sign = '+';
+    char const* curr = s;
+    int read = 0;
+    bool end_not_reached = false;
+
+    if (*curr == '+' || *curr == '-') {
+      sign = *curr;
+      ++curr;
+    }
+    else if (!is_digit(*curr)) {
+      return false;
+    }
+
+    while ((end_not_reached = (curr != s_end)) && is_digit(*curr)) {
+      mantissa *= 10;
+      mantissa += static_cast<int>(*curr - '0');
+      ++curr;
+      ++read;
+    }
+    if (read == 0) return false;
+
+    if (end_not_reached) {
+      bool has_exponent = false;
+      if (*curr == '.') {
+        ++curr;
+        read = 1;
+        while ((end_not_reached = (curr != s_end)) && is_digit(*curr)) {
+          double power = std::size_t(read) < NEGATIVE_POWERS.size() ? NEGATIVE_POWERS[std::size_t(read)] : std::pow(10.0, -read);
+          mantissa += static_cast<int>(*curr - '0') * power;
+          ++read;
+          ++curr;
+        }
+        has_exponent = end_not_reached && (*curr == 'e' || *curr == 'E');
+      }
+      else if (*curr == 'e' || *curr == 'E') {
+        has_exponent = true;
+      }
+
+      if (has_exponent) {
+        ++curr;
+        if (curr == s_end) return false;
+        if (*curr == '+' || *curr == '-') {
+          exp_sign = *curr;
+          ++curr;
+        }
+        else if (!is_digit(*curr)) {
+          return false;
+        }
+        read = 0;
+        while (curr != s_end && is_digit(*curr)) {
+          exponent *= 10;
+          exponent += static_cast<int>(*curr - '0');
+          ++curr;
+          ++read;
+        }
+        exponent *= (exp_sign == '+' ? 1 : -1);
+        if (read == 0) return false;
+      }
+    }
+
+    double value = exponent == 0 ? mantissa : std::ldexp(mantissa * std::pow(5.0, exponent), exponent);
+    result = (sign == '+' ? 1 : -1) * value;
+    return true;
+  }
+
+  // value up to next space, 0 if invalid
+  inline float parse_float(char const*& p, char const* line_end) {
+    p = skip_space(p, line_end);
+    char const* end = p;
+    while (end < line_end && !is_space(*end) && *end != '\r') ++end;
+    double value = 0.0;
+    parse_double(p, end, value);
+    p = end;
+    return static_cast<float>(value);
+  }
+
+  // integer prefix like atoi
+  inline int parse_int(char const* p, char const* end) {
+    while (p < end && is_whitespace(*p)) ++p;
+    bool negative = false;
+    if (p < end && (*p == '+' || *p == '-')) {
+      negative = *p == '-';
+      ++p;
+    }
+    long long value = 0;
+    while (p < end && is_digit(*p)) {
+      value = value * 10 + (*p - '0');
+      ++p;
+    }
+    return int(negative ? -value : value);
+  }
+
+  inline char const* skip_index(char const* p, char const* end) {
+    while (p < end && *p != '/' && !is_space(*p) && *p != '\r') ++p;
+    return p;
+  }
+
+  // zero-based index, relative indices are resolved against local count
+  inline int fix_index(int index, std::size_t count, std::size_t slot, chunk& c) {
+    if (index > 0) return index - 1;
+    if (index == 0) return 0;
+    c.relative.push_back(slot);
+    return int(count) + index;
+  }
+
+  // parse triples: i, i/j/k, i//k, i/j
+  face_vertex parse_triple(char const*& p, char const* end, chunk& c) {
+    face_vertex vertex{-1, -1, -1};
+    std::size_t slot = c.corners.size() * 3;
+
+    vertex.v = fix_index(parse_int(p, end), c.v.size() / 3, slot, c);
+    p = skip_index(p, end);
+    if (p >= end || *p != '/') return vertex;
+    ++p;
+
+    // i//k
+    if (p < end && *p == '/') {
+      ++p;
+      vertex.vn = fix_index(parse_int(p, end), c.vn.size() / 3, slot + 2, c);
+      p = skip_index(p, end);
+      return vertex;
+    }
+
+    // i/j/k or i/j
+    vertex.vt = fix_index(parse_int(p, end), c.vt.size() / 2, slot + 1, c);
+    p = skip_index(p, end);
+    if (p >= end || *p != '/') return vertex;
+    ++p;
+
+    vertex.vn = fix_index(parse_int(p, end), c.vn.size() / 3, slot + 2, c);
+    p = skip_index(p, end);
+    return vertex;
+  }
+
+  // first whitespace separated word like sscanf("%s")
+  std::string parse_word(char const* p, char const* end) {
+    while (p < end && is_whitespace(*p)) ++p;
+    char const* word_end = p;
+    while (word_end < end && !is_whitespace(*word_end)) ++word_end;
+    return std::string(p, word_end);
+  }
+
+  // second word of group statement, first one is "g"
+  std::string parse_group_name(char const* p, char const* end) {
+    while (p < end && !is_space(*p) && *p != '\r') ++p;
+    while (p < end && (is_space(*p) || *p == '\r')) ++p;
+    char const* word_end = p;
+    while (word_end < end && !is_space(*word_end) && *word_end != '\r') ++word_end;
+    return std::string(p, word_end);
+  }
+
+  void parse_line(char const* p, char const* end, chunk& c) {
+    p = skip_space(p, end);
+    if (p == end || *p == '#') return;
+    // characters behind line end are treated as terminator
+    auto at = [&](std::size_t i) {
+      return p + i < end ? p[i] : '\0';
+    };
+
+    if (at(0) == 'v' && is_space(at(1))) {
+      p += 2;
+      c.v.push_back(parse_float(p, end));
+      c.v.push_back(parse_float(p, end));
+      c.v.push_back(parse_float(p, end));
+    }
+    else if (at(0) == 'v' && at(1) == 'n' && is_space(at(2))) {
+      p += 3;
+      c.vn.push_back(parse_float(p, end));
+      c.vn.push_back(parse_float(p, end));
+      c.vn.push_back(parse_float(p, end));
+    }
+    else if (at(0) == 'v' && at(1) == 't' && is_space(at(2))) {
+      p += 3;
+      c.vt.push_back(parse_float(p, end));
+      c.vt.push_back(parse_float(p, end));
+    }
+    else if (at(0) == 'f' && is_space(at(1))) {
+      p = skip_space(p + 2, end);
+      while (p < end && *p != '\r') {
+        c.corners.push_back(parse_triple(p, end, c));
+        while (p < end && (is_space(*p) || *p == '\r')) ++p;
+      }
+      c.faces.push_back(c.corners.size());
+    }
+    else if (end - p > 6 && std::strncmp(p, "usemtl", 6) == 0 && is_space(p[6])) {
+      c.statements.push_back(statement{statement_kind::usemtl, c.faces.size() - 1, parse_word(p + 7, end)});
+    }
+    else if (end - p > 6 && std::strncmp(p, "mtllib", 6) == 0 && is_space(p[6])) {
+      c.statements.push_back(statement{statement_kind::mtllib, c.faces.size() - 1, parse_word(p + 7, end)});
+    }
+    else if (at(0) == 'g' && is_space(at(1))) {
+      c.statements.push_back(statement{statement_kind::group, c.faces.size() - 1, parse_group_name(p, end)});
+    }
+    else if (at(0) == 'o' && is_space(at(1))) {
+      c.statements.push_back(statement{statement_kind::object, c.faces.size() - 1, parse_word(p + 2, end)});
+    }
+    // ignore unknown statements
+  }
+
+  void parse_chunk(chunk& c) {
+    c.faces.push_back(0);
+    for (char const* p = c.begin; p < c.end; ) {
+      char const* line_end = static_cast<char const*>(std::memchr(p, '\n', std::size_t(c.end - p)));
+      if (!line_end) line_end = c.end;
+      parse_line(p, line_end, c);
+      p = line_end + 1;
+    }
+  }
+
+  // split file into chunks of complete lines
+  std::vector<chunk> split(char const* data, std::size_t size) {
+    std::size_t count = std::max(std::size_t(1), std::min(size / MIN_CHUNK_SIZE, parallel::thread_count() * CHUNKS_PER_THREAD));
+    std::vector<chunk> chunks(count);
+    char const* begin = data;
+    for (std::size_t i = 0; i < count; ++i) {
+      char const* end = data + size * (i + 1) / count;
+      if (i + 1 < count && end > begin) {
+        // include rest of line
+        char const* line_end = static_cast<char const*>(std::memchr(end, '\n', std::size_t(data + size - end)));
+        end = line_end ? line_end + 1 : data + size;
+      }
+      end = std::max(begin, end);
+      chunks[i].begin = begin;
+      chunks[i].end = end;
+      begin = end;
+    }
+    return chunks;
+  }
+
+  // deduplicate corners of triangle fans within segment
+  void triangulate(segment& s, chunk const& c) {
+    std::size_t corner_count = c.faces[s.face_end] - c.faces[s.face_begin];
+    vertex_table table{corner_count / 2};
+    auto add = [&](face_vertex const& corner) {
+      unsigned index = table.insert(corner, unsigned(s.unique.size()));
+      if (index == s.unique.size()) {
+        s.unique.push_back(corner);
+      }
+      s.indices.push_back(index);
+    };
+
+    s.indices.reserve(corner_count * 3);
+    for (std::size_t f = s.face_begin; f < s.face_end; ++f) {
+      std::size_t first = c.faces[f];
+      std::size_t last = c.faces[f + 1];
+      // polygon to triangle fan
+      for (std::size_t k = first + 2; k < last; ++k) {
+        add(c.corners[first]);
+        add(c.corners[k - 1]);
+        add(c.corners[k]);
+      }
+    }
+  }
+
+  // copy attributes of new corners into shape, in order of first use
+  void merge(face_group const& group, std::vector<segment>& segments,
+             std::vector<float> const& v, std::vector<float> const& vn, std::vector<float> const& vt,
+             tinyobj::mesh_t& mesh) {
+    std::size_t unique_count = 0;
+    for (std::size_t s : group.segments) {
+      unique_count += segments[s].unique.size();
+    }
+    vertex_table table{unique_count};
+    mesh.positions.reserve(unique_count * 3);
+
+    for (std::size_t s : group.segments) {
+      segment& seg = segments[s];
+      seg.remap.resize(seg.unique.size());
+      for (std::size_t i = 0; i < seg.unique.size(); ++i) {
+        face_vertex const& corner = seg.unique[i];
+        unsigned next = unsigned(mesh.positions.size() / 3);
+        seg.remap[i] = table.insert(corner, next);
+        if (seg.remap[i] != next) continue;
+
+        if (corner.v < 0 || std::size_t(corner.v) * 3 + 2 >= v.size()
+         || std::size_t(corner.vn + 1) * 3 > vn.size()
+         || std::size_t(corner.vt + 1) * 2 > vt.size()) {
+          throw std::out_of_range("Vertex index out of range in group " + group.name);
+        }
+        mesh.positions.insert(mesh.positions.end(), &v[std::size_t(corner.v) * 3], &v[std::size_t(corner.v) * 3] + 3);
+        if (corner.vn >= 0) {
+          mesh.normals.insert(mesh.normals.end(), &vn[std::size_t(corner.vn) * 3], &vn[std::size_t(corner.vn) * 3] + 3);
+        }
+        if (corner.vt >= 0) {
+          mesh.texcoords.insert(mesh.texcoords.end(), &vt[std::size_t(corner.vt) * 2], &vt[std::size_t(corner.vt) * 2] + 2);
+        }
+      }
+    }
+  }
+}
+
+std::string load(std::vector<tinyobj::shape_t>& shapes,
+                 std::vector<tinyobj::material_t>& materials,
+                 std::string const& path,
+                 std::string const& mtl_basepath) {
+  shapes.clear();
+
+  mapped_file file{path};
+  if (!file.valid()) {
+    std::stringstream err;
+    err << "Cannot open file [" << path << "]" << std::endl;
+    return err.str();
+  }
+
+  // parse chunks independently
+  std::vector<chunk> chunks = split(reinterpret_cast<char const*>(file.data()), file.size());
+  parallel::for_each(chunks.size(), [&](std::size_t i) {
+    parse_chunk(chunks[i]);
+  });
+
+  // concatenate attributes, offsets of chunks resolve relative indices
+  std::vector<std::size_t> v_offsets(chunks.size() + 1, 0);
+  std::vector<std::size_t> vn_offsets(chunks.size() + 1, 0);
+  std::vector<std::size_t> vt_offsets(chunks.size() + 1, 0);
+  for (std::size_t i = 0; i < chunks.size(); ++i) {
+    v_offsets[i + 1] = v_offsets[i] + chunks[i].v.size();
+    vn_offsets[i + 1] = vn_offsets[i] + chunks[i].vn.size();
+    vt_offsets[i + 1] = vt_offsets[i] + chunks[i].vt.size();
+  }
+  std::vector<float> v(v_offsets.back());
+  std::vector<float> vn(vn_offsets.back());
+  std::vector<float> vt(vt_offsets.back());
+  parallel::for_each(chunks.size(), [&](std::size_t i) {
+    chunk& c = chunks[i];
+    std::copy(c.v.begin(), c.v.end(), v.begin() + std::ptrdiff_t(v_offsets[i]));
+    std::copy(c.vn.begin(), c.vn.end(), vn.begin() + std::ptrdiff_t(vn_offsets[i]));
+    std::copy(c.vt.begin(), c.vt.end(), vt.begin() + std::ptrdiff_t(vt_offsets[i]));
+    std::vector<float>().swap(c.v);
+    std::vector<float>().swap(c.vn);
+    std::vector<float>().swap(c.vt);
+
+    for (std::size_t slot : c.relative) {
+      face_vertex& corner = c.corners[slot / 3];
+      switch (slot % 3) {
+        case 0: corner.v += int(v_offsets[i] / 3); break;
+        case 1: corner.vt += int(vt_offsets[i] / 2); break;
+        default: corner.vn += int(vn_offsets[i] / 3); break;
+      }
+    }
+  });
+
+  // split faces into groups at statements, in file order
+  std::vector<segment> segments{};
+  std::vector<face_group> groups{};
+  face_group current{"", -1, {}};
+  std::size_t current_faces = 0;
+  std::map<std::string, int> material_map{};
+  tinyobj::MaterialFileReader material_reader{mtl_basepath};
+  std::string material_error{};
+
+  auto add_faces = [&](std::size_t chunk_index, std::size_t begin, std::size_t end) {
+    if (end <= begin) return;
+    current.segments.push_back(segments.size());
+    segments.push_back(segment{chunk_index, begin, end, {}, {}, {}, 0});
+    current_faces += end - begin;
+  };
+  auto flush = [&]() {
+    if (current_faces > 0) {
+      groups.push_back(current);
+    }
+    current.segments.clear();
+    current_faces = 0;
+  };
+
+  for (std::size_t i = 0; i < chunks.size() && material_error.empty(); ++i) {
+    std::size_t face = 0;
+    for (auto const& s : chunks[i].statements) {
+      add_faces(i, face, s.face);
+      face = s.face;
+
+      if (s.kind == statement_kind::mtllib) {
+        material_error = material_reader(s.name, materials, material_map);
+        if (!material_error.empty()) break;
+        continue;
+      }
+      flush();
+      if (s.kind == statement_kind::usemtl) {
+        auto material = material_map.find(s.name);
+        current.material = material != material_map.end() ? material->second : -1;
+      }
+      else {
+        current.name = s.name;
+      }
+    }
+    if (material_error.empty()) {
+      add_faces(i, face, chunks[i].faces.size() - 1);
+    }
+  }
+  if (material_error.empty()) {
+    flush();
+  }
+  else {
+    // tinyobj stops at first material error and drops current group
+    segments.resize(groups.empty() ? 0 : groups.back().segments.back() + 1);
+  }
+
+  // triangulate and deduplicate segments, then merge them per group
+  parallel::for_each(segments.size(), [&](std::size_t i) {
+    triangulate(segments[i], chunks[segments[i].chunk]);
+  });
+
+  shapes.resize(groups.size());
+  try {
+    parallel::for_each(groups.size(), [&](std::size_t g) {
+      merge(groups[g], segments, v, vn, vt, shapes[g].mesh);
+      shapes[g].name = groups[g].name;
+
+      std::size_t triangles = 0;
+      for (std::size_t s : groups[g].segments) {
+        segments[s].triangle_offset = triangles;
+        triangles += segments[s].indices.size() / 3;
+      }
+      shapes[g].mesh.indices.resize(triangles * 3);
+      shapes[g].mesh.material_ids.assign(triangles, groups[g].material);
+    });
+  }
+  catch (std::out_of_range& e) {
+    shapes.clear();
+    return e.what();
+  }
+
+  // write final indices of each segment
+  std::vector<std::size_t> segment_groups(segments.size());
+  for (std::size_t g = 0; g < groups.size(); ++g) {
+    for (std::size_t s : groups[g].segments) {
+      segment_groups[s] = g;
+    }
+  }
+  parallel::for_each(segments.size(), [&](std::size_t i) {
+    segment const& s = segments[i];
+    auto& indices = shapes[segment_groups[i]].mesh.indices;
+    for (std::size_t j = 0; j < s.indices.size(); ++j) {
+      indices[s.triangle_offset * 3 + j] = s.remap[s.indices[j]];
+    }
+  });
+
+  return material_error;
+}
+
+};
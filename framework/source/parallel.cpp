@@ -0,0 +1,215 @@
+#include "parallel.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace parallel {
+
+namespace {
+  // one worker per core, waiting for tasks
+  class pool {
+   public:
+    pool()
+     :m_mutex{}
+     ,m_queued{}
+     ,m_tasks{}
+     ,m_workers{}
+    {
+      for (unsigned i = 0; i < thread_count(); ++i) {
+        m_workers.emplace_back(&pool::work, this);
+      }
+    }
+
+    // true if called from one of the workers
+    bool is_worker() const {
+      auto id = std::this_thread::get_id();
+      return std::any_of(m_workers.begin(), m_workers.end(), [&](std::thread const& worker) {
+        return worker.get_id() == id;
+      });
+    }
+
+    void run(std::function<void()> task) {
+      std::lock_guard<std::mutex> lock{m_mutex};
+      m_tasks.push_back(std::move(task));
+      m_queued.notify_one();
+    }
+
+   private:
+    void work() {
+      for (;;) {
+        std::function<void()> task{};
+        {
+          std::unique_lock<std::mutex> lock{m_mutex};
+          m_queued.wait(lock, [this]() { return !m_tasks.empty(); });
+          task = std::move(m_tasks.front());
+          m_tasks.pop_front();
+        }
+        task();
+      }
+    }
+
+    std::mutex m_mutex;
+    std::condition_variable m_queued;
+    std::deque<std::function<void()>> m_tasks;
+    std::vector<std::thread> m_workers;
+  };
+
+  // never destroyed, joining threads during static destruction can deadlock
+  // idle workers end with the process
+  pool& workers() {
+    static pool* instance = new pool{};
+    return *instance;
+  }
+
+  // items shared by a caller and the tasks helping it
+  // tasks may start after the caller returned, so they own the state
+  struct shared_items {
+    std::size_t count;
+    // items are taken one by one, so uneven items are balanced
+    std::atomic<std::size_t> next;
+    std::mutex mutex;
+    std::condition_variable idle;
+    // tasks taking items, none start once closed
+    std::size_t running;
+    bool closed;
+    std::exception_ptr error;
+
+    explicit shared_items(std::size_t item_count)
+     :count{item_count}
+     ,next{0}
+     ,mutex{}
+     ,idle{}
+     ,running{0}
+     ,closed{false}
+     ,error{}
+    {}
+
+    // false if the caller no longer waits for tasks
+    bool start() {
+      std::lock_guard<std::mutex> lock{mutex};
+      if (closed) return false;
+      ++running;
+      return true;
+    }
+
+    void stop() {
+      std::lock_guard<std::mutex> lock{mutex};
+      --running;
+      idle.notify_all();
+    }
+
+    // waits for started tasks, tasks starting later do nothing
+    void close() {
+      std::unique_lock<std::mutex> lock{mutex};
+      closed = true;
+      next = count;
+      idle.wait(lock, [this]() { return running == 0; });
+    }
+  };
+
+  void take_items(shared_items& items, std::function<void(std::size_t)> const& function) {
+    for (std::size_t i = items.next++; i < items.count; i = items.next++) {
+      try {
+        function(i);
+      }
+      catch (...) {
+        std::lock_guard<std::mutex> lock{items.mutex};
+        if (!items.error) items.error = std::current_exception();
+      }
+    }
+  }
+}
+
+unsigned thread_count() {
+  // may return 0 if unknown
+  return std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+void for_each(std::size_t count, std::function<void(std::size_t)> const& function) {
+  std::size_t threads = std::min(std::size_t(thread_count()), count);
+  // nested calls stay on their worker, the other workers are busy with the outer items
+  if (threads <= 1 || workers().is_worker()) {
+    for (std::size_t i = 0; i < count; ++i) {
+      function(i);
+    }
+    return;
+  }
+
+  auto items = std::make_shared<shared_items>(count);
+  for (std::size_t i = 1; i < threads; ++i) {
+    // function is only used while the caller waits
+    workers().run([items, &function]() {
+      if (!items->start()) return;
+      take_items(*items, function);
+      items->stop();
+    });
+  }
+  // calling thread works as well, helpers still queued once it is done are skipped
+  take_items(*items, function);
+  items->close();
+
+  if (items->error) {
+    std::rethrow_exception(items->error);
+  }
+}
+
+struct batch::state : shared_items {
+  std::function<void(std::size_t)> function;
+  // finished calls not yet returned by next_finished
+  std::condition_variable finished_call;
+  std::deque<std::size_t> finished;
+
+  state(std::size_t count, std::function<void(std::size_t)> const& item_function)
+   :shared_items{count}
+   ,function{item_function}
+   ,finished_call{}
+   ,finished{}
+  {}
+};
+
+batch::batch(std::size_t count, std::function<void(std::size_t)> const& function)
+ :m_state{std::make_shared<state>(count, function)}
+ ,m_returned{0}
+{
+  std::size_t tasks = std::min(std::size_t(thread_count()), count);
+  std::shared_ptr<state> shared = m_state;
+  for (std::size_t task = 0; task < tasks; ++task) {
+    workers().run([shared]() {
+      if (!shared->start()) return;
+      for (std::size_t i = shared->next++; i < shared->count; i = shared->next++) {
+        shared->function(i);
+        std::lock_guard<std::mutex> lock{shared->mutex};
+        shared->finished.push_back(i);
+        shared->finished_call.notify_one();
+      }
+      shared->stop();
+    });
+  }
+}
+
+batch::~batch() {
+  m_state->close();
+}
+
+std::size_t batch::size() const {
+  return m_state->count;
+}
+
+std::size_t batch::next_finished() {
+  if (m_returned == m_state->count) return m_state->count;
+
+  std::unique_lock<std::mutex> lock{m_state->mutex};
+  m_state->finished_call.wait(lock, [this]() { return !m_state->finished.empty(); });
+  std::size_t index = m_state->finished.front();
+  m_state->finished.pop_front();
+  ++m_returned;
+  return index;
+}
+
+};
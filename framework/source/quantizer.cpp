@@ -0,0 +1,177 @@
+#include "quantizer.hpp"
+
+#include <glbinding/gl/gl.h>
+
+#include <glm/gtc/packing.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+namespace quantizer {
+
+namespace {
+  // largest error of converting components of all vertices to format
+  float max_error(GLfloat const* data, std::size_t stride, std::size_t offset, std::size_t components,
+                  std::size_t vertex_num, model::attribute const& format) {
+    float error = 0.0f;
+    for (std::size_t v = 0; v < vertex_num; ++v) {
+      GLfloat const* values = data + v * stride + offset;
+      if (format.type == GL_HALF_FLOAT) {
+        for (std::size_t c = 0; c < components; ++c) {
+          // out of range values become infinite
+          float converted = glm::unpackHalf1x16(glm::packHalf1x16(values[c]));
+          error = std::max(error, std::abs(converted - values[c]));
+        }
+      }
+      else if (format.type == GL_INT_2_10_10_10_REV) {
+        glm::vec4 converted = glm::unpackSnorm3x10_1x2(glm::packSnorm3x10_1x2(glm::vec4{values[0], values[1], values[2], 0.0f}));
+        for (std::size_t c = 0; c < components; ++c) {
+          error = std::max(error, std::abs(converted[int(c)] - values[c]));
+        }
+      }
+      if (!(error <= std::numeric_limits<float>::max())) {
+        return std::numeric_limits<float>::infinity();
+      }
+    }
+    return error;
+  }
+
+  // write one attribute value in given format
+  void encode(GLfloat const* values, std::size_t components, model::attribute const& format, unsigned char* out) {
+    if (format.type == GL_HALF_FLOAT) {
+      for (std::size_t c = 0; c < std::size_t(format.components); ++c) {
+        // padding component is 1 like the default w
+        std::uint16_t half = glm::packHalf1x16(c < components ? values[c] : 1.0f);
+        std::memcpy(out + c * sizeof(half), &half, sizeof(half));
+      }
+    }
+    else if (format.type == GL_INT_2_10_10_10_REV) {
+      std::uint32_t packed = glm::packSnorm3x10_1x2(glm::vec4{values[0], values[1], values[2], 0.0f});
+      std::memcpy(out, &packed, sizeof(packed));
+    }
+    else {
+      std::memcpy(out, values, components * sizeof(GLfloat));
+    }
+  }
+
+  // compact format of attribute, if there is one
+  model::attribute const* compact_format(model::attribute const& attribute) {
+    if (attribute == model::POSITION) return &model::POSITION_HALF;
+    if (attribute == model::TEXCOORD) return &model::TEXCOORD_HALF;
+    if (attribute == model::NORMAL) return &model::NORMAL_PACKED;
+    if (attribute == model::TANGENT) return &model::TANGENT_PACKED;
+    if (attribute == model::BITANGENT) return &model::BITANGENT_PACKED;
+    return nullptr;
+  }
+}
+
+packed_model pack(GLfloat const* data, model const& layout, GLuint const* indices, std::size_t index_num,
+                  error_bounds const& bounds) {
+  packed_model packed{};
+  packed.vertex_num = layout.vertex_num;
+  packed.index_num = index_num;
+  packed.float_vertex_bytes = layout.vertex_bytes;
+  std::size_t stride = std::size_t(layout.vertex_bytes) / sizeof(GLfloat);
+
+  // largest bounding box extent scales the position bound
+  float extent = 0.0f;
+  if (layout.attributes & model::POSITION) {
+    for (int c = 0; c < 3; ++c) {
+      float min = std::numeric_limits<float>::max();
+      float max = std::numeric_limits<float>::lowest();
+      for (std::size_t v = 0; v < layout.vertex_num; ++v) {
+        min = std::min(min, data[v * stride + std::size_t(c)]);
+        max = std::max(max, data[v * stride + std::size_t(c)]);
+      }
+      extent = std::max(extent, max - min);
+    }
+  }
+
+  // choose formats, attributes exceeding their bound stay float
+  std::vector<std::size_t> source_offsets{};
+  std::vector<std::size_t> source_components{};
+  for (auto const& attribute : model::VERTEX_ATTRIBS) {
+    if (!(layout.attributes & attribute)) continue;
+    std::size_t offset = std::size_t(reinterpret_cast<std::uintptr_t>(layout.offsets.at(attribute))) / sizeof(GLfloat);
+    std::size_t components = std::size_t(attribute.components);
+
+    model::attribute format = attribute;
+    float error = 0.0f;
+    model::attribute const* compact = compact_format(attribute);
+    if (compact) {
+      float bound = bounds.direction;
+      if (attribute == model::POSITION) bound = bounds.position * extent;
+      if (attribute == model::TEXCOORD) bound = bounds.texcoord;
+      float compact_error = max_error(data, stride, offset, components, layout.vertex_num, *compact);
+      if (compact_error <= bound) {
+        format = *compact;
+        error = compact_error;
+      }
+    }
+
+    format.offset = reinterpret_cast<GLvoid*>(std::uintptr_t(packed.vertex_bytes));
+    packed.vertex_bytes += format.size * format.components;
+    packed.attributes.push_back(format);
+    packed.errors[attribute] = error;
+    source_offsets.push_back(offset);
+    source_components.push_back(components);
+  }
+
+  packed.data.resize(packed.vertex_num * std::size_t(packed.vertex_bytes));
+  for (std::size_t v = 0; v < packed.vertex_num; ++v) {
+    unsigned char* vertex = packed.data.data() + v * std::size_t(packed.vertex_bytes);
+    for (std::size_t a = 0; a < packed.attributes.size(); ++a) {
+      model::attribute const& format = packed.attributes[a];
+      encode(data + v * stride + source_offsets[a], source_components[a], format,
+             vertex + reinterpret_cast<std::uintptr_t>(format.offset));
+    }
+  }
+
+  // 16 bit indices if every vertex can be addressed
+  if (packed.vertex_num < 65536) {
+    packed.index = model::INDEX_SHORT;
+    packed.indices.resize(index_num * sizeof(GLushort));
+    for (std::size_t i = 0; i < index_num; ++i) {
+      GLushort index = GLushort(indices[i]);
+      std::memcpy(packed.indices.data() + i * sizeof(index), &index, sizeof(index));
+    }
+  }
+  else {
+    packed.indices.resize(index_num * sizeof(GLuint));
+    std::memcpy(packed.indices.data(), indices, index_num * sizeof(GLuint));
+  }
+  return packed;
+}
+
+packed_model pack(model const& source, error_bounds const& bounds) {
+  return pack(source.data.data(), source, source.indices.data(), source.indices.size(), bounds);
+}
+
+packed_model pack(mesh_cache::cached_model const& source, error_bounds const& bounds) {
+  return pack(source.data, source.layout, source.indices, source.index_num, bounds);
+}
+
+void set_attribute_pointers(packed_model const& packed) {
+  for (auto const& attribute : packed.attributes) {
+    for (GLuint location = 0; location < model::VERTEX_ATTRIBS.size(); ++location) {
+      if (model::VERTEX_ATTRIBS[location].flag != attribute.flag) continue;
+      glEnableVertexAttribArray(location);
+      glVertexAttribPointer(location, attribute.components, attribute.type, attribute.normalized ? GL_TRUE : GL_FALSE,
+                            packed.vertex_bytes, attribute.offset);
+    }
+  }
+}
+
+std::ostream& operator<<(std::ostream& os, packed_model const& packed) {
+  os << packed.float_vertex_bytes << " -> " << packed.vertex_bytes << " bytes per vertex, "
+     << packed.index.size * 8 << " bit indices, max error";
+  for (std::size_t a = 0; a < packed.attributes.size(); ++a) {
+    os << (a > 0 ? ", " : " ") << packed.errors.at(packed.attributes[a].flag);
+  }
+  return os;
+}
+
+};
@@ -0,0 +1,95 @@
+#include "scene_graph.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+scene_graph::scene_graph()
+ :m_parents{}
+ ,m_locals{}
+ ,m_worlds{}
+ ,m_dirty{}
+ ,m_first_dirty{0}
+{}
+
+std::size_t scene_graph::add(std::size_t parent, glm::fmat4 const& local) {
+  if (parent != NO_PARENT && parent >= size()) {
+    throw std::out_of_range{"scene_graph - parent " + std::to_string(parent) + " does not exist"};
+  }
+  std::size_t node = size();
+  m_parents.push_back(parent);
+  m_locals.push_back(local);
+  m_worlds.push_back(local);
+  m_dirty.push_back(1);
+  m_first_dirty = std::min(m_first_dirty, node);
+  return node;
+}
+
+void scene_graph::clear() {
+  m_parents.clear();
+  m_locals.clear();
+  m_worlds.clear();
+  m_dirty.clear();
+  m_first_dirty = 0;
+}
+
+void scene_graph::reserve(std::size_t nodes) {
+  m_parents.reserve(nodes);
+  m_locals.reserve(nodes);
+  m_worlds.reserve(nodes);
+  m_dirty.reserve(nodes);
+}
+
+std::size_t scene_graph::size() const {
+  return m_parents.size();
+}
+
+std::size_t scene_graph::parent(std::size_t node) const {
+  return m_parents[node];
+}
+
+glm::fmat4 const& scene_graph::local(std::size_t node) const {
+  return m_locals[node];
+}
+
+void scene_graph::set_local(std::size_t node, glm::fmat4 const& local) {
+  m_locals[node] = local;
+  m_dirty[node] = 1;
+  m_first_dirty = std::min(m_first_dirty, node);
+}
+
+std::size_t scene_graph::update() {
+  std::size_t const count = size();
+  std::size_t updated = 0;
+  for (std::size_t node = m_first_dirty; node < count; ++node) {
+    std::size_t parent = m_parents[node];
+    // parent was handled before, its flag tells whether its world matrix changed
+    if (parent != NO_PARENT && m_dirty[parent]) {
+      m_dirty[node] = 1;
+    }
+    if (!m_dirty[node]) continue;
+
+    m_worlds[node] = parent == NO_PARENT ? m_locals[node] : m_worlds[parent] * m_locals[node];
+    ++updated;
+  }
+  if (m_first_dirty < count) {
+    std::fill(m_dirty.begin() + std::ptrdiff_t(m_first_dirty), m_dirty.end(), std::uint8_t(0));
+  }
+  m_first_dirty = count;
+  return updated;
+}
+
+glm::fmat4 const& scene_graph::world(std::size_t node) const {
+  return m_worlds[node];
+}
+
+glm::fmat4 const* scene_graph::world_matrices() const {
+  return m_worlds.data();
+}
+
+void scene_graph::gather(std::vector<std::size_t> const& nodes, std::vector<glm::fmat4>& out) const {
+  out.resize(nodes.size());
+  for (std::size_t i = 0; i < nodes.size(); ++i) {
+    out[i] = m_worlds[nodes[i]];
+  }
+}
@@ -1,10 +1,14 @@
 #include "shader_loader.hpp"
 #include "utils.hpp"
+#include "structs.hpp"
 
 #include <glbinding/gl/functions.h>
 // use gl definitions from glbinding 
 using namespace gl;
 
+#include <algorithm>
+#include <vector>
+
 namespace shader_loader {
 
 GLuint shader(std::string const& file_path, GLenum shader_type) {
@@ -126,4 +130,44 @@ GLuint program(std::string const& vertex_path, std::string const& geometry_path,
   return program;
 }
 
+void reflect(shader_program& program) {
+  program.uniforms.clear();
+  program.uniform_blocks.clear();
+
+  GLint max_length = 0;
+  glGetProgramiv(program.handle, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_length);
+  GLint block_max_length = 0;
+  glGetProgramiv(program.handle, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &block_max_length);
+  std::vector<GLchar> name(std::size_t(std::max(max_length, block_max_length)) + 1);
+
+  GLint count = 0;
+  glGetProgramiv(program.handle, GL_ACTIVE_UNIFORMS, &count);
+  for (GLuint i = 0; i < GLuint(count); ++i) {
+    GLsizei length = 0;
+    GLint size = 0;
+    GLenum type = GL_NONE;
+    glGetActiveUniform(program.handle, i, GLsizei(name.size()), &length, &size, &type, name.data());
+    std::string uniform_name{name.data(), std::size_t(length)};
+    // members of blocks have no location
+    GLint location = glGetUniformLocation(program.handle, uniform_name.c_str());
+    if (location < 0) continue;
+    // arrays are reported as first element
+    if (uniform_name.size() > 3 && uniform_name.compare(uniform_name.size() - 3, 3, "[0]") == 0) {
+      uniform_name.resize(uniform_name.size() - 3);
+    }
+    program.uniforms.push_back(uniform_info{uniform_name, location, type, size});
+  }
+
+  glGetProgramiv(program.handle, GL_ACTIVE_UNIFORM_BLOCKS, &count);
+  for (GLuint i = 0; i < GLuint(count); ++i) {
+    GLsizei length = 0;
+    glGetActiveUniformBlockName(program.handle, i, GLsizei(name.size()), &length, name.data());
+    GLint data_size = 0;
+    glGetActiveUniformBlockiv(program.handle, i, GL_UNIFORM_BLOCK_DATA_SIZE, &data_size);
+    program.uniform_blocks.push_back(uniform_block_info{std::string{name.data(), std::size_t(length)}, i, data_size});
+  }
+
+  ++program.generation;
+}
+
 };
\ No newline at end of file
@@ -0,0 +1,211 @@
+#include "star_catalog.hpp"
+
+#include "gl_state.hpp"
+#include "parallel.hpp"
+
+#include <glbinding/gl/gl.h>
+// use gl definitions from glbinding
+using namespace gl;
+
+#include <glm/common.hpp>
+#include <glm/gtc/constants.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <numeric>
+
+namespace {
+  // stars generated per work item, each with its own random stream
+  const std::size_t CHUNK_SIZE = std::size_t(1) << 16;
+
+  // splitmix64, fast and good enough for placing stars
+  struct random_stream {
+    std::uint64_t state;
+
+    std::uint64_t next() {
+      std::uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+      z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+      z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+      return z ^ (z >> 31);
+    }
+    // uniform in [0, 1)
+    float uniform() {
+      return float(next() >> 40) * (1.0f / 16777216.0f);
+    }
+  };
+
+  // from hot blue to cool red stars
+  glm::fvec3 const TINTS[] = {
+    glm::fvec3{0.7f, 0.8f, 1.0f}, glm::fvec3{0.9f, 0.95f, 1.0f}, glm::fvec3{1.0f, 1.0f, 1.0f},
+    glm::fvec3{1.0f, 0.95f, 0.8f}, glm::fvec3{1.0f, 0.8f, 0.6f}
+  };
+  const std::size_t TINT_NUM = sizeof(TINTS) / sizeof(glm::fvec3);
+
+  // cell of direction on the cube, faces ordered +x, -x, +y, -y, +z, -z
+  std::size_t cell_of(glm::fvec3 const& direction, unsigned resolution) {
+    glm::fvec3 extent = glm::abs(direction);
+    std::size_t face = 0;
+    glm::fvec2 coordinates{};
+    float major = 0.0f;
+    if (extent.x >= extent.y && extent.x >= extent.z) {
+      face = direction.x < 0.0f ? 1 : 0;
+      coordinates = glm::fvec2{direction.y, direction.z};
+      major = extent.x;
+    }
+    else if (extent.y >= extent.z) {
+      face = direction.y < 0.0f ? 3 : 2;
+      coordinates = glm::fvec2{direction.x, direction.z};
+      major = extent.y;
+    }
+    else {
+      face = direction.z < 0.0f ? 5 : 4;
+      coordinates = glm::fvec2{direction.x, direction.y};
+      major = extent.z;
+    }
+    // face coordinates from [-1, 1] to cells
+    glm::fvec2 scaled = (coordinates / major * 0.5f + 0.5f) * float(resolution);
+    std::size_t u = std::min(std::size_t(std::max(scaled.x, 0.0f)), std::size_t(resolution - 1));
+    std::size_t v = std::min(std::size_t(std::max(scaled.y, 0.0f)), std::size_t(resolution - 1));
+    return (face * resolution + u) * resolution + v;
+  }
+}
+
+star_catalog::star_catalog(std::size_t count, float radius, std::uint64_t seed, unsigned resolution)
+ :m_vertex_array{0}
+ ,m_buffer{0}
+ ,m_faintest{count > 1 ? 2.0f * std::log10(float(count)) : 0.0f}
+ ,m_cells{}
+ ,m_bounds{}
+ ,m_magnitudes{}
+ ,m_last_drawn{0}
+ ,m_visible{}
+ ,m_firsts{}
+ ,m_counts{}
+{
+  resolution = std::max(resolution, 1u);
+  std::vector<star_vertex> generated(count);
+  std::vector<std::size_t> cells(count);
+  std::size_t chunk_num = (count + CHUNK_SIZE - 1) / CHUNK_SIZE;
+  parallel::for_each(chunk_num, [&](std::size_t chunk) {
+    // hashed seed, so streams of neighbouring chunks do not overlap
+    random_stream random{random_stream{seed + chunk}.next()};
+    std::size_t end = std::min(count, (chunk + 1) * CHUNK_SIZE);
+    for (std::size_t i = chunk * CHUNK_SIZE; i < end; ++i) {
+      // uniform direction from height and angle
+      float height = random.uniform() * 2.0f - 1.0f;
+      float angle = random.uniform() * 2.0f * glm::pi<float>();
+      float ring = std::sqrt(std::max(0.0f, 1.0f - height * height));
+      glm::fvec3 direction{ring * std::cos(angle), ring * std::sin(angle), height};
+      // number of stars brighter than m grows with 10^(0.5 * m)
+      float magnitude = m_faintest + 2.0f * std::log10(1.0f - random.uniform());
+      glm::fvec3 tint = TINTS[random.next() % TINT_NUM];
+      generated[i] = star_vertex{direction * radius, magnitude, glm::u8vec4{glm::u8vec3{tint * 255.0f + 0.5f}, 255}};
+      cells[i] = cell_of(direction, resolution);
+    }
+  });
+
+  // counting sort by cell
+  std::size_t cell_num = 6 * std::size_t(resolution) * resolution;
+  std::vector<std::size_t> offsets(cell_num + 1, 0);
+  for (std::size_t cell_index : cells) {
+    ++offsets[cell_index + 1];
+  }
+  std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+  std::vector<star_vertex> stars(count);
+  std::vector<std::size_t> next(offsets.begin(), offsets.end() - 1);
+  for (std::size_t i = 0; i < count; ++i) {
+    stars[next[cells[i]]++] = generated[i];
+  }
+  // brightest first, so every magnitude limit keeps a prefix of a cell
+  parallel::for_each(cell_num, [&](std::size_t cell_index) {
+    std::sort(stars.begin() + offsets[cell_index], stars.begin() + offsets[cell_index + 1],
+              [](star_vertex const& a, star_vertex const& b) { return a.magnitude < b.magnitude; });
+  });
+
+  m_magnitudes.reserve(count);
+  for (auto const& star : stars) {
+    m_magnitudes.push_back(star.magnitude);
+  }
+  for (std::size_t cell_index = 0; cell_index < cell_num; ++cell_index) {
+    std::size_t first = offsets[cell_index];
+    std::size_t num = offsets[cell_index + 1] - first;
+    if (num == 0) continue;
+    m_cells.push_back(cell{GLint(first), GLsizei(num)});
+    m_bounds.push_back(culling::bounds(&stars[first].position.x, num, sizeof(star_vertex) / sizeof(GLfloat)));
+  }
+
+  upload(stars);
+}
+
+star_catalog::~star_catalog() {
+  if (m_buffer != 0) {
+    gl_state::delete_buffers(1, &m_buffer);
+    gl_state::delete_vertex_arrays(1, &m_vertex_array);
+  }
+}
+
+void star_catalog::upload(std::vector<star_vertex> const& stars) {
+  glGenVertexArrays(1, &m_vertex_array);
+  glGenBuffers(1, &m_buffer);
+  gl_state::bind_vertex_array(m_vertex_array);
+  gl_state::bind_buffer(GL_ARRAY_BUFFER, m_buffer);
+  glBufferData(GL_ARRAY_BUFFER, GLsizeiptr(stars.size() * sizeof(star_vertex)), stars.data(), GL_STATIC_DRAW);
+
+  GLsizei stride = GLsizei(sizeof(star_vertex));
+  glEnableVertexAttribArray(POSITION_LOCATION);
+  glVertexAttribPointer(POSITION_LOCATION, 3, GL_FLOAT, GL_FALSE, stride,
+                        reinterpret_cast<GLvoid*>(offsetof(star_vertex, position)));
+  glEnableVertexAttribArray(MAGNITUDE_LOCATION);
+  glVertexAttribPointer(MAGNITUDE_LOCATION, 1, GL_FLOAT, GL_FALSE, stride,
+                        reinterpret_cast<GLvoid*>(offsetof(star_vertex, magnitude)));
+  glEnableVertexAttribArray(COLOR_LOCATION);
+  glVertexAttribPointer(COLOR_LOCATION, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride,
+                        reinterpret_cast<GLvoid*>(offsetof(star_vertex, color)));
+}
+
+std::size_t star_catalog::size() const {
+  return m_magnitudes.size();
+}
+
+float star_catalog::faintest() const {
+  return m_faintest;
+}
+
+std::size_t star_catalog::brighter(float limit) const {
+  std::size_t num = 0;
+  for (auto const& current : m_cells) {
+    auto begin = m_magnitudes.begin() + current.first;
+    num += std::size_t(std::upper_bound(begin, begin + current.count, limit) - begin);
+  }
+  return num;
+}
+
+std::size_t star_catalog::draw(culling::frustum const& volume, float limit) {
+  m_visible.clear();
+  m_firsts.clear();
+  m_counts.clear();
+  m_last_drawn = 0;
+  // cells are not counted, so the culling statistics keep showing bodies and orbits
+  culling::cull(volume, m_bounds.data(), m_bounds.size(), m_visible, false);
+
+  // bright prefix of every visible cell
+  for (std::size_t i : m_visible) {
+    cell const& current = m_cells[i];
+    auto begin = m_magnitudes.begin() + current.first;
+    GLsizei num = GLsizei(std::upper_bound(begin, begin + current.count, limit) - begin);
+    if (num == 0) continue;
+    m_firsts.push_back(current.first);
+    m_counts.push_back(num);
+    m_last_drawn += std::size_t(num);
+  }
+  if (m_counts.empty()) return 0;
+
+  gl_state::bind_vertex_array(m_vertex_array);
+  glMultiDrawArrays(GL_POINTS, m_firsts.data(), m_counts.data(), GLsizei(m_counts.size()));
+  return 1;
+}
+
+std::size_t star_catalog::last_drawn() const {
+  return m_last_drawn;
+}
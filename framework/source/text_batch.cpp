@@ -0,0 +1,148 @@
+#include "text_batch.hpp"
+
+#include "gl_state.hpp"
+
+#include <glbinding/gl/gl.h>
+// use gl definitions from glbinding
+using namespace gl;
+
+#include <glm/common.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+
+namespace {
+  // size of a letter in texture coordinates
+  const float TEX_LETTER_SIZE = 1.0f / 16.0f;
+  // extent of text coordinate space
+  const float SCREEN_WIDTH = 800.0f;
+  const float SCREEN_HEIGHT = 600.0f;
+  // bytes per frame of the vertex ring at first draw, about 800 letters
+  const GLsizeiptr INITIAL_RING_SIZE = GLsizeiptr(1) << 16;
+
+  glm::u8vec4 quantize(glm::fvec4 const& color) {
+    return glm::u8vec4{glm::clamp(color, 0.0f, 1.0f) * 255.0f + 0.5f};
+  }
+}
+
+bool text_batch::cache_key::operator<(cache_key const& other) const {
+  return std::tie(x, y, size, color.r, color.g, color.b, color.a, text)
+       < std::tie(other.x, other.y, other.size, other.color.r, other.color.g, other.color.b, other.color.a, other.text);
+}
+
+text_batch::text_batch()
+ :m_vertex_array{0}
+ ,m_ring{}
+ ,m_frame{0}
+ ,m_vertices{}
+ ,m_cache{}
+{}
+
+text_batch::~text_batch() {
+  if (m_vertex_array != 0) {
+    gl_state::delete_vertex_arrays(1, &m_vertex_array);
+  }
+}
+
+std::vector<glyph_vertex> text_batch::build(cache_key const& key) {
+  // translate to device coordinates from (-1, -1) to (1, 1)
+  float x_size = key.size / (SCREEN_WIDTH * 0.5f);
+  float y_size = key.size / (SCREEN_HEIGHT * 0.5f);
+  float rx = key.x / (SCREEN_WIDTH * 0.5f) - 1.0f;
+  float ry = key.y / (SCREEN_HEIGHT * 0.5f) - 1.0f;
+
+  // two triangles per letter
+  std::vector<glyph_vertex> vertices{};
+  vertices.reserve(key.text.size() * 6);
+  for (std::size_t i = 0; i < key.text.size(); ++i) {
+    // texture is indexed from top left
+    unsigned char letter = static_cast<unsigned char>(key.text[i]);
+    float tx = float(letter % 16) * TEX_LETTER_SIZE;
+    float ty = float(15 - letter / 16) * TEX_LETTER_SIZE;
+
+    float left = rx + float(i) * x_size;
+    float right = left + x_size;
+    glyph_vertex const lower_left{glm::fvec2{left, ry}, key.color, glm::fvec2{tx, ty}};
+    glyph_vertex const lower_right{glm::fvec2{right, ry}, key.color, glm::fvec2{tx + TEX_LETTER_SIZE, ty}};
+    glyph_vertex const upper_left{glm::fvec2{left, ry + y_size}, key.color, glm::fvec2{tx, ty + TEX_LETTER_SIZE}};
+    glyph_vertex const upper_right{glm::fvec2{right, ry + y_size}, key.color, glm::fvec2{tx + TEX_LETTER_SIZE, ty + TEX_LETTER_SIZE}};
+
+    vertices.push_back(lower_left);
+    vertices.push_back(lower_right);
+    vertices.push_back(upper_left);
+    vertices.push_back(upper_left);
+    vertices.push_back(lower_right);
+    vertices.push_back(upper_right);
+  }
+  return vertices;
+}
+
+void text_batch::add(float x, float y, float size, std::string const& text, glm::fvec4 const& color) {
+  if (text.empty()) return;
+
+  cache_key key{text, x, y, size, quantize(color)};
+  auto found = m_cache.find(key);
+  if (found == m_cache.end()) {
+    found = m_cache.emplace(key, cached_text{build(key), m_frame}).first;
+  }
+  found->second.frame = m_frame;
+  m_vertices.insert(m_vertices.end(), found->second.vertices.begin(), found->second.vertices.end());
+}
+
+void text_batch::clear() {
+  m_vertices.clear();
+}
+
+std::size_t text_batch::size() const {
+  return m_vertices.size() / 6;
+}
+
+std::size_t text_batch::draw() {
+  // strings not drawn this frame have changed or disappeared
+  for (auto i = m_cache.begin(); i != m_cache.end();) {
+    if (i->second.frame != m_frame) {
+      i = m_cache.erase(i);
+    }
+    else {
+      ++i;
+    }
+  }
+  ++m_frame;
+  if (m_vertices.empty()) return 0;
+
+  // a larger ring replaces a full one, the driver keeps the old buffer until the gpu is done with it
+  std::size_t bytes = m_vertices.size() * sizeof(glyph_vertex);
+  if (!m_ring || GLsizeiptr(bytes) > m_ring->frame_size()) {
+    GLsizeiptr frame_size = std::max(GLsizeiptr(bytes), m_ring ? m_ring->frame_size() * 2 : INITIAL_RING_SIZE);
+    m_ring.reset(new frame_ring{GL_ARRAY_BUFFER, frame_size});
+  }
+  m_ring->next_frame();
+  ring_range range = m_ring->upload(m_vertices.data(), GLsizeiptr(bytes));
+
+  if (m_vertex_array == 0) {
+    glGenVertexArrays(1, &m_vertex_array);
+    gl_state::bind_vertex_array(m_vertex_array);
+    glEnableVertexAttribArray(POSITION_LOCATION);
+    glEnableVertexAttribArray(COLOR_LOCATION);
+    glEnableVertexAttribArray(TEX_COORD_LOCATION);
+  }
+  else {
+    gl_state::bind_vertex_array(m_vertex_array);
+  }
+  // vertices start at the offset of this frame's range
+  gl_state::bind_buffer(GL_ARRAY_BUFFER, range.buffer);
+  GLsizei stride = GLsizei(sizeof(glyph_vertex));
+  std::uintptr_t base = std::uintptr_t(range.offset);
+  glVertexAttribPointer(POSITION_LOCATION, 2, GL_FLOAT, GL_FALSE, stride,
+                        reinterpret_cast<GLvoid*>(base + offsetof(glyph_vertex, position)));
+  glVertexAttribPointer(COLOR_LOCATION, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride,
+                        reinterpret_cast<GLvoid*>(base + offsetof(glyph_vertex, color)));
+  glVertexAttribPointer(TEX_COORD_LOCATION, 2, GL_FLOAT, GL_FALSE, stride,
+                        reinterpret_cast<GLvoid*>(base + offsetof(glyph_vertex, tex_coord)));
+  glDrawArrays(GL_TRIANGLES, 0, GLsizei(m_vertices.size()));
+
+  clear();
+  return 1;
+}
@@ -0,0 +1,284 @@
+#include "texture_array.hpp"
+
+#include "mip_chain.hpp"
+#include "utils.hpp"
+
+#include <glbinding/gl/gl.h>
+// use gl definitions from glbinding
+using namespace gl;
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace texture_array {
+
+namespace {
+  GLenum channel_format(std::size_t count) {
+    GLenum const formats[] = {GL_RED, GL_RG, GL_RGB, GL_RGBA};
+    return formats[count - 1];
+  }
+
+  GLenum internal_format(std::size_t count) {
+    GLenum const formats[] = {GL_R8, GL_RG8, GL_RGB8, GL_RGBA8};
+    return formats[count - 1];
+  }
+
+  std::size_t nearest_power_of_two(std::size_t value) {
+    std::size_t power = 1;
+    // round in log space, 1448 is the geometric mean of 1024 and 2048
+    while (double(power) * std::sqrt(2.0) < double(value)) {
+      power *= 2;
+    }
+    return power;
+  }
+
+  // copy pixels with more channels, grey is replicated to rgb and missing alpha is opaque
+  std::vector<std::uint8_t> expand(pixel_data const& image, std::size_t from, std::size_t to) {
+    std::size_t pixel_num = image.width * image.height;
+    if (from == to) {
+      return std::vector<std::uint8_t>(image.pixels.begin(), image.pixels.begin() + std::ptrdiff_t(pixel_num * from));
+    }
+    std::vector<std::uint8_t> result(pixel_num * to);
+    bool grey = from <= 2;
+    for (std::size_t p = 0; p < pixel_num; ++p) {
+      std::uint8_t const* source = &image.pixels[p * from];
+      std::uint8_t* target = &result[p * to];
+      if (grey) {
+        std::uint8_t alpha = from == 2 ? source[1] : 255;
+        for (std::size_t c = 0; c < to; ++c) {
+          // last of two or four channels is alpha
+          target[c] = (c == 1 && to == 2) || c == 3 ? alpha : source[0];
+        }
+      }
+      else {
+        std::copy(source, source + from, target);
+        target[3] = 255;
+      }
+    }
+    return result;
+  }
+
+  // source texels and weights contributing to each target texel along one axis
+  typedef std::vector<std::vector<std::pair<std::size_t, float>>> filter_taps;
+
+  // tent filter, widened when minifying so every source texel contributes
+  filter_taps compute_taps(std::size_t source, std::size_t target) {
+    filter_taps taps(target);
+    double scale = double(source) / double(target);
+    double radius = std::max(1.0, scale);
+    for (std::size_t t = 0; t < target; ++t) {
+      double center = (double(t) + 0.5) * scale - 0.5;
+      auto first = std::ptrdiff_t(std::ceil(center - radius));
+      auto last = std::ptrdiff_t(std::floor(center + radius));
+      float sum = 0.0f;
+      for (std::ptrdiff_t s = first; s <= last; ++s) {
+        float weight = float(std::max(0.0, 1.0 - std::abs(double(s) - center) / radius));
+        if (weight <= 0.0f) continue;
+        std::size_t clamped = std::size_t(std::min(std::max(s, std::ptrdiff_t(0)), std::ptrdiff_t(source) - 1));
+        taps[t].push_back(std::make_pair(clamped, weight));
+        sum += weight;
+      }
+      for (auto& tap : taps[t]) {
+        tap.second /= sum;
+      }
+    }
+    return taps;
+  }
+
+  // separable resampling of 8 bit pixels with given channel number
+  std::vector<std::uint8_t> resize(std::vector<std::uint8_t> const& pixels, std::size_t channels,
+                                   std::size_t width, std::size_t height, std::size_t new_width, std::size_t new_height) {
+    if (width == new_width && height == new_height) {
+      return pixels;
+    }
+    filter_taps horizontal = compute_taps(width, new_width);
+    filter_taps vertical = compute_taps(height, new_height);
+
+    std::vector<float> rows(new_width * height * channels, 0.0f);
+    for (std::size_t y = 0; y < height; ++y) {
+      for (std::size_t x = 0; x < new_width; ++x) {
+        float* target = &rows[(y * new_width + x) * channels];
+        for (auto const& tap : horizontal[x]) {
+          std::uint8_t const* source = &pixels[(y * width + tap.first) * channels];
+          for (std::size_t c = 0; c < channels; ++c) {
+            target[c] += tap.second * float(source[c]);
+          }
+        }
+      }
+    }
+
+    std::vector<std::uint8_t> result(new_width * new_height * channels);
+    std::vector<float> accumulated(new_width * channels);
+    for (std::size_t y = 0; y < new_height; ++y) {
+      std::fill(accumulated.begin(), accumulated.end(), 0.0f);
+      for (auto const& tap : vertical[y]) {
+        float const* source = &rows[tap.first * new_width * channels];
+        for (std::size_t i = 0; i < accumulated.size(); ++i) {
+          accumulated[i] += tap.second * source[i];
+        }
+      }
+      for (std::size_t i = 0; i < accumulated.size(); ++i) {
+        result[y * new_width * channels + i] = std::uint8_t(std::min(std::max(accumulated[i] + 0.5f, 0.0f), 255.0f));
+      }
+    }
+    return result;
+  }
+}
+
+std::pair<std::size_t, std::size_t> bucket_size(std::size_t width, std::size_t height, std::size_t max_extent) {
+  std::size_t bucket_width = nearest_power_of_two(width);
+  std::size_t bucket_height = nearest_power_of_two(height);
+  // halving both keeps the aspect ratio
+  while ((bucket_width > max_extent || bucket_height > max_extent) && bucket_width > 1 && bucket_height > 1) {
+    bucket_width /= 2;
+    bucket_height /= 2;
+  }
+  return std::make_pair(bucket_width, bucket_height);
+}
+
+pixel_data resample(pixel_data const& image, std::size_t width, std::size_t height) {
+  if (image.channel_type != GL_UNSIGNED_BYTE) {
+    throw std::invalid_argument("Texture array: no 8 bit image");
+  }
+  std::size_t channels = channel_count(image.channels);
+  return pixel_data{resize(image.pixels, channels, image.width, image.height, width, height),
+                    image.channels, GL_UNSIGNED_BYTE, width, height};
+}
+
+std::map<std::string, texture_layer> build(std::map<std::string, pixel_data> const& images, std::size_t max_extent,
+                                           std::set<std::string> const& data_images) {
+  // image names of each bucket, names keep the layer order deterministic
+  std::map<std::pair<std::size_t, std::size_t>, std::vector<std::string>> buckets{};
+  for (auto const& image : images) {
+    if (image.second.channel_type != GL_UNSIGNED_BYTE) {
+      throw std::invalid_argument("Texture array: " + image.first + " is no 8 bit image");
+    }
+    if (image.second.pixels.size() < image.second.width * image.second.height * channel_count(image.second.channels)) {
+      throw std::invalid_argument("Texture array: " + image.first + " has too few pixels");
+    }
+    buckets[bucket_size(image.second.width, image.second.height, max_extent)].push_back(image.first);
+  }
+
+  GLint max_layers = 0;
+  glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &max_layers);
+  // minimum guaranteed by GL 3.3
+  std::size_t layer_limit = max_layers > 0 ? std::size_t(max_layers) : 256;
+
+  std::map<std::string, texture_layer> layers{};
+  GLint alignment = 4;
+  glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
+  // rows are tightly packed
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  for (auto const& bucket : buckets) {
+    std::size_t width = bucket.first.first;
+    std::size_t height = bucket.first.second;
+    auto const& names = bucket.second;
+
+    for (std::size_t first = 0; first < names.size(); first += layer_limit) {
+      std::size_t last = std::min(names.size(), first + layer_limit);
+      std::size_t channels = 0;
+      for (std::size_t i = first; i < last; ++i) {
+        channels = std::max(channels, channel_count(images.at(names[i]).channels));
+      }
+
+      texture_object array{};
+      array.target = GL_TEXTURE_2D_ARRAY;
+      glGenTextures(1, &array.handle);
+      glBindTexture(GL_TEXTURE_2D_ARRAY, array.handle);
+      std::size_t level_num = mip_chain::level_num(width, height);
+      for (std::size_t level = 0; level < level_num; ++level) {
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, GLint(level), GLint(internal_format(channels)),
+                     GLsizei(std::max(width >> level, std::size_t(1))), GLsizei(std::max(height >> level, std::size_t(1))),
+                     GLsizei(last - first), 0, channel_format(channels), GL_UNSIGNED_BYTE, nullptr);
+      }
+      utils::set_mip_filtering(GL_TEXTURE_2D_ARRAY, level_num);
+
+      for (std::size_t i = first; i < last; ++i) {
+        pixel_data const& image = images.at(names[i]);
+        pixel_data resized{resize(expand(image, channel_count(image.channels), channels), channels,
+                                  image.width, image.height, width, height),
+                           channel_format(channels), GL_UNSIGNED_BYTE, width, height};
+        std::vector<pixel_data> levels = mip_chain::build(resized, data_images.count(names[i]) == 0);
+        GLint layer = GLint(i - first);
+        for (std::size_t level = 0; level < levels.size(); ++level) {
+          glTexSubImage3D(GL_TEXTURE_2D_ARRAY, GLint(level), 0, 0, layer,
+                          GLsizei(levels[level].width), GLsizei(levels[level].height), 1,
+                          channel_format(channels), GL_UNSIGNED_BYTE, levels[level].ptr());
+        }
+        texture_layer location{};
+        location.texture = array;
+        location.layer = layer;
+        layers[names[i]] = location;
+      }
+    }
+  }
+  glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+  return layers;
+}
+
+std::map<std::string, texture_layer> build(std::map<std::string, texture_cache::cached_texture> const& textures) {
+  // texture names of each format, size and level number
+  typedef std::tuple<GLenum, std::size_t, std::size_t, std::size_t> group_key;
+  std::map<group_key, std::vector<std::string>> groups{};
+  for (auto const& texture : textures) {
+    if (!texture.second.valid()) {
+      throw std::invalid_argument("Texture array: " + texture.first + " has no compressed levels");
+    }
+    texture_cache::header const& head = texture.second.file_header();
+    groups[group_key{texture.second.format(), head.width, head.height, texture.second.level_num()}].push_back(texture.first);
+  }
+
+  GLint max_layers = 0;
+  glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &max_layers);
+  // minimum guaranteed by GL 3.3
+  std::size_t layer_limit = max_layers > 0 ? std::size_t(max_layers) : 256;
+
+  std::map<std::string, texture_layer> layers{};
+  for (auto const& group : groups) {
+    GLenum format = std::get<0>(group.first);
+    std::size_t level_num = std::get<3>(group.first);
+    auto const& names = group.second;
+
+    for (std::size_t first = 0; first < names.size(); first += layer_limit) {
+      std::size_t last = std::min(names.size(), first + layer_limit);
+      texture_cache::cached_texture const& front = textures.at(names[first]);
+
+      texture_object array{};
+      array.target = GL_TEXTURE_2D_ARRAY;
+      glGenTextures(1, &array.handle);
+      glBindTexture(GL_TEXTURE_2D_ARRAY, array.handle);
+      // allocate every level before filling layers
+      for (std::size_t level = 0; level < level_num; ++level) {
+        texture_cache::level const& info = front.level_info(level);
+        GLsizei layer_num = GLsizei(last - first);
+        glCompressedTexImage3D(GL_TEXTURE_2D_ARRAY, GLint(level), format, GLsizei(info.width), GLsizei(info.height),
+                               layer_num, 0, GLsizei(info.size) * layer_num, nullptr);
+      }
+      utils::set_mip_filtering(GL_TEXTURE_2D_ARRAY, level_num);
+
+      for (std::size_t i = first; i < last; ++i) {
+        texture_cache::cached_texture const& texture = textures.at(names[i]);
+        GLint layer = GLint(i - first);
+        for (std::size_t level = 0; level < level_num; ++level) {
+          texture_cache::level const& info = texture.level_info(level);
+          glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, GLint(level), 0, 0, layer, GLsizei(info.width), GLsizei(info.height), 1,
+                                    format, GLsizei(info.size), texture.level_data(level));
+        }
+        texture_layer location{};
+        location.texture = array;
+        location.layer = layer;
+        layers[names[i]] = location;
+      }
+    }
+  }
+  glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+  return layers;
+}
+
+};
@@ -0,0 +1,200 @@
+#include "texture_cache.hpp"
+
+#include "block_compression.hpp"
+#include "mip_chain.hpp"
+#include "utils.hpp"
+
+#include <glbinding/gl/gl.h>
+// use gl definitions from glbinding
+using namespace gl;
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace texture_cache {
+
+namespace {
+  const char MAGIC[4] = {'T', 'E', 'X', 'C'};
+  // alignment of level data in file
+  const std::size_t ALIGNMENT = 16;
+
+  std::size_t aligned(std::size_t offset) {
+    return (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+  }
+}
+
+GLenum format(usage content) {
+  return content == usage::normal ? GL_COMPRESSED_RG_RGTC2 : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+}
+
+cached_texture::cached_texture()
+ :m_content{}
+ ,m_file{}
+ ,m_data{nullptr}
+ ,m_header{}
+ ,m_levels{}
+{}
+
+cached_texture::cached_texture(std::string const& cache_path)
+ :m_content{}
+ ,m_file{cache_path}
+ ,m_data{nullptr}
+ ,m_header{}
+ ,m_levels{}
+{
+  read(m_file.data(), m_file.size());
+  if (!valid()) {
+    m_file = mapped_file{};
+  }
+}
+
+cached_texture::cached_texture(std::vector<std::uint8_t>&& content)
+ :m_content{std::move(content)}
+ ,m_file{}
+ ,m_data{nullptr}
+ ,m_header{}
+ ,m_levels{}
+{
+  read(m_content.data(), m_content.size());
+}
+
+cached_texture::cached_texture(cached_texture&& other)
+ :m_content{std::move(other.m_content)}
+ ,m_file{std::move(other.m_file)}
+ ,m_data{other.m_data}
+ ,m_header(other.m_header)
+ ,m_levels{std::move(other.m_levels)}
+{
+  // moved vector and mapping keep their buffers
+  other.m_data = nullptr;
+}
+
+cached_texture& cached_texture::operator=(cached_texture&& other) {
+  m_content = std::move(other.m_content);
+  m_file = std::move(other.m_file);
+  m_data = other.m_data;
+  m_header = other.m_header;
+  m_levels = std::move(other.m_levels);
+  other.m_data = nullptr;
+  return *this;
+}
+
+void cached_texture::read(std::uint8_t const* content, std::size_t size) {
+  if (content == nullptr || size < sizeof(header)) return;
+  std::memcpy(&m_header, content, sizeof(header));
+  std::size_t table_end = sizeof(header) + std::size_t(m_header.level_num) * sizeof(level);
+  if (std::memcmp(m_header.magic, MAGIC, sizeof(MAGIC)) != 0
+   || m_header.version != VERSION
+   || (GLenum(m_header.format) != GL_COMPRESSED_RGB_S3TC_DXT1_EXT && GLenum(m_header.format) != GL_COMPRESSED_RG_RGTC2)
+   || m_header.level_num == 0
+   || table_end > size) {
+    return;
+  }
+
+  std::vector<level> levels(m_header.level_num);
+  std::memcpy(levels.data(), content + sizeof(header), levels.size() * sizeof(level));
+  for (auto const& current : levels) {
+    if (current.offset > size || current.size > size - current.offset
+     || current.size < block_compression::image_size(GLenum(m_header.format), current.width, current.height)) {
+      return;
+    }
+  }
+  m_levels = std::move(levels);
+  m_data = content;
+}
+
+bool cached_texture::valid() const {
+  return m_data != nullptr;
+}
+
+header const& cached_texture::file_header() const {
+  return m_header;
+}
+
+GLenum cached_texture::format() const {
+  return GLenum(m_header.format);
+}
+
+std::size_t cached_texture::level_num() const {
+  return m_levels.size();
+}
+
+level const& cached_texture::level_info(std::size_t index) const {
+  return m_levels.at(index);
+}
+
+std::uint8_t const* cached_texture::level_data(std::size_t index) const {
+  return m_data + m_levels.at(index).offset;
+}
+
+std::vector<std::uint8_t> encode(std::uint64_t source_hash, usage content, pixel_data const& image) {
+  if (image.width == 0 || image.height == 0) {
+    throw std::invalid_argument("Texture cache: empty image");
+  }
+  GLenum compressed_format = format(content);
+  std::vector<std::vector<std::uint8_t>> blocks{};
+  std::vector<level> levels{};
+  // normals are data, only color is filtered in linear light
+  for (auto const& current : mip_chain::build(image, content == usage::color)) {
+    blocks.push_back(block_compression::compress(current, compressed_format));
+    levels.push_back(level{0, blocks.back().size(), std::uint32_t(current.width), std::uint32_t(current.height)});
+  }
+
+  header head{};
+  std::memcpy(head.magic, MAGIC, sizeof(MAGIC));
+  head.version = VERSION;
+  head.source_hash = source_hash;
+  head.format = std::uint32_t(compressed_format);
+  head.width = std::uint32_t(image.width);
+  head.height = std::uint32_t(image.height);
+  head.level_num = std::uint32_t(levels.size());
+
+  std::size_t offset = sizeof(header) + levels.size() * sizeof(level);
+  for (auto& current_level : levels) {
+    offset = aligned(offset);
+    current_level.offset = offset;
+    offset += std::size_t(current_level.size);
+  }
+  std::vector<std::uint8_t> result(offset, 0);
+  std::memcpy(result.data(), &head, sizeof(header));
+  std::memcpy(result.data() + sizeof(header), levels.data(), levels.size() * sizeof(level));
+  for (std::size_t i = 0; i < levels.size(); ++i) {
+    std::copy(blocks[i].begin(), blocks[i].end(), result.begin() + std::ptrdiff_t(levels[i].offset));
+  }
+  return result;
+}
+
+std::string cache_path(std::string const& source_path, usage content, std::size_t max_extent) {
+  std::ostringstream path;
+  path << source_path << (content == usage::normal ? ".bc5." : ".bc1.") << max_extent << ".texcache";
+  return path.str();
+}
+
+bool store(std::string const& cache_path, std::vector<std::uint8_t> const& content) {
+  // write to temporary file so readers never map partial files
+  std::string temp_path = cache_path + ".tmp";
+  {
+    std::ofstream file{temp_path, std::ios::binary};
+    if (!file) return false;
+
+    file.write(reinterpret_cast<char const*>(content.data()), std::streamsize(content.size()));
+    if (!file) {
+      file.close();
+      std::remove(temp_path.c_str());
+      return false;
+    }
+  }
+  // rename does not replace existing files on windows
+  std::remove(cache_path.c_str());
+  return std::rename(temp_path.c_str(), cache_path.c_str()) == 0;
+}
+
+bool supported() {
+  return utils::has_extension("GL_EXT_texture_compression_s3tc");
+}
+
+};
@@ -1,5 +1,9 @@
 #include "texture_loader.hpp"
 
+#include "mesh_cache.hpp"
+#include "parallel.hpp"
+#include "texture_array.hpp"
+
 // request supported types
 #define STBI_ONLY_JPEG
 #define STBI_ONLY_PNG
@@ -11,23 +15,38 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
  
+#include <algorithm>
 #include <cstdint> 
 #include <cstring> 
+#include <iostream>
 #include <stdexcept> 
 
 namespace texture_loader {
-pixel_data file(std::string const& file_name) {
-  // match to opengl representation
-  stbi_set_flip_vertically_on_load(true);
 
+namespace {
+  // taken before the batch starts, so workers never set a value while its future is retrieved
+  template<typename T>
+  std::vector<std::future<T>> futures(std::vector<std::promise<T>>& promises) {
+    std::vector<std::future<T>> result{};
+    for (auto& promise : promises) {
+      result.push_back(promise.get_future());
+    }
+    return result;
+  }
+}
+
+pixel_data file(std::string const& file_name) {
   uint8_t* data_ptr;
   int width = 0;
   int height = 0;
   int format = STBI_default;
-  data_ptr = stbi_load(file_name.c_str(), &width, &height, &format, STBI_rgb_alpha);
+  // keep channels of file, so data matches the reported format
+  // the global flip setting of stb_image is never used, concurrent decodes could race on it
+  data_ptr = stbi_load(file_name.c_str(), &width, &height, &format, STBI_default);
 
   if(!data_ptr) {
-    throw std::logic_error(std::string{"stb_image: "} + stbi_failure_reason());
+    // reason is a global of stb_image, concurrent failures may report each others reason
+    throw std::logic_error(std::string{"stb_image: "} + file_name + " - " + stbi_failure_reason());
   }
 
   // determine format of image data, internal format should be sized
@@ -53,12 +72,91 @@ pixel_data file(std::string const& file_name) {
     throw std::logic_error("stb_image: misinterpreted data, incorrect format");
   }
 
-  std::vector<uint8_t> texture_data(width * height * num_components);
-  // copy data to vector
-  std::memcpy(&texture_data[0], data_ptr, texture_data.size());
+  std::size_t row_size = std::size_t(width) * num_components;
+  std::vector<uint8_t> texture_data(row_size * std::size_t(height));
+  // copy rows to vector in reverse, opengl expects the bottom row first
+  for (std::size_t y = 0; y < std::size_t(height); ++y) {
+    std::memcpy(&texture_data[y * row_size], data_ptr + (std::size_t(height) - 1 - y) * row_size, row_size);
+  }
   stbi_image_free(data_ptr);
 
   return pixel_data{texture_data, pixel_format, GL_UNSIGNED_BYTE, std::size_t(width), std::size_t(height)};
 }
 
+texture_cache::cached_texture compressed(std::string const& file_name, texture_cache::usage content, std::size_t max_extent) {
+  std::uint64_t source_hash = mesh_cache::hash_file(file_name);
+  std::string cache_path = texture_cache::cache_path(file_name, content, max_extent);
+
+  texture_cache::cached_texture cached{cache_path};
+  if (cached.valid()
+   && cached.file_header().source_hash == source_hash
+   && cached.format() == texture_cache::format(content)) {
+    return cached;
+  }
+
+  pixel_data image = file(file_name);
+  auto size = texture_array::bucket_size(image.width, image.height, max_extent);
+  std::vector<std::uint8_t> encoded = texture_cache::encode(source_hash, content,
+                                                            texture_array::resample(image, size.first, size.second));
+  if (!texture_cache::store(cache_path, encoded)) {
+    std::cerr << "Could not write texture cache " << cache_path << std::endl;
+  }
+  return texture_cache::cached_texture{std::move(encoded)};
+}
+
+decode_batch::decode_batch(std::vector<std::string> const& file_names)
+ :m_file_names(file_names)
+ ,m_promises(file_names.size())
+ ,m_images(futures(m_promises))
+ ,m_decodes{file_names.size(), [this](std::size_t i) {
+    try {
+      m_promises[i].set_value(file(m_file_names[i]));
+    }
+    catch (...) {
+      m_promises[i].set_exception(std::current_exception());
+    }
+  }}
+{}
+
+std::size_t decode_batch::size() const {
+  return m_decodes.size();
+}
+
+std::size_t decode_batch::next_ready() {
+  return m_decodes.next_finished();
+}
+
+std::future<pixel_data>& decode_batch::image(std::size_t index) {
+  return m_images.at(index);
+}
+
+compress_batch::compress_batch(std::vector<std::string> const& file_names,
+                               std::vector<texture_cache::usage> const& contents, std::size_t max_extent)
+ :m_file_names(file_names)
+ ,m_contents(contents)
+ ,m_max_extent{max_extent}
+ ,m_promises(file_names.size())
+ ,m_textures(futures(m_promises))
+ ,m_compressions{file_names.size(), [this](std::size_t i) {
+    try {
+      m_promises[i].set_value(compressed(m_file_names[i], m_contents.at(i), m_max_extent));
+    }
+    catch (...) {
+      m_promises[i].set_exception(std::current_exception());
+    }
+  }}
+{}
+
+std::size_t compress_batch::size() const {
+  return m_compressions.size();
+}
+
+std::size_t compress_batch::next_ready() {
+  return m_compressions.next_finished();
+}
+
+std::future<texture_cache::cached_texture>& compress_batch::texture(std::size_t index) {
+  return m_textures.at(index);
+}
+
 };
\ No newline at end of file
@@ -0,0 +1,170 @@
+#include "uniform_handle.hpp"
+
+#include <glbinding/gl/gl.h>
+// use gl definitions from glbinding
+using namespace gl;
+
+#include <glm/gtc/type_precision.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <iostream>
+
+namespace {
+  bool is_sampler(GLenum type) {
+    static GLenum const samplers[] = {
+      GL_SAMPLER_1D, GL_SAMPLER_2D, GL_SAMPLER_3D, GL_SAMPLER_CUBE, GL_SAMPLER_2D_RECT, GL_SAMPLER_BUFFER,
+      GL_SAMPLER_1D_ARRAY, GL_SAMPLER_2D_ARRAY, GL_SAMPLER_2D_MULTISAMPLE, GL_SAMPLER_2D_MULTISAMPLE_ARRAY,
+      GL_SAMPLER_1D_SHADOW, GL_SAMPLER_2D_SHADOW, GL_SAMPLER_CUBE_SHADOW, GL_SAMPLER_2D_ARRAY_SHADOW,
+      GL_INT_SAMPLER_2D, GL_INT_SAMPLER_3D, GL_INT_SAMPLER_2D_ARRAY, GL_INT_SAMPLER_BUFFER,
+      GL_UNSIGNED_INT_SAMPLER_2D, GL_UNSIGNED_INT_SAMPLER_3D, GL_UNSIGNED_INT_SAMPLER_2D_ARRAY, GL_UNSIGNED_INT_SAMPLER_BUFFER
+    };
+    return std::find(std::begin(samplers), std::end(samplers), type) != std::end(samplers);
+  }
+
+  // whether a uniform of GL type can be set with values of pointer type, and upload
+  bool accepts(GLint const*, GLenum type) {
+    return type == GL_INT || type == GL_BOOL || is_sampler(type);
+  }
+  void upload(GLint location, GLsizei count, GLint const* values) {
+    glUniform1iv(location, count, values);
+  }
+
+  bool accepts(GLuint const*, GLenum type) {
+    return type == GL_UNSIGNED_INT || type == GL_BOOL;
+  }
+  void upload(GLint location, GLsizei count, GLuint const* values) {
+    glUniform1uiv(location, count, values);
+  }
+
+  bool accepts(GLfloat const*, GLenum type) {
+    return type == GL_FLOAT;
+  }
+  void upload(GLint location, GLsizei count, GLfloat const* values) {
+    glUniform1fv(location, count, values);
+  }
+
+  bool accepts(glm::fvec2 const*, GLenum type) {
+    return type == GL_FLOAT_VEC2;
+  }
+  void upload(GLint location, GLsizei count, glm::fvec2 const* values) {
+    glUniform2fv(location, count, glm::value_ptr(*values));
+  }
+
+  bool accepts(glm::fvec3 const*, GLenum type) {
+    return type == GL_FLOAT_VEC3;
+  }
+  void upload(GLint location, GLsizei count, glm::fvec3 const* values) {
+    glUniform3fv(location, count, glm::value_ptr(*values));
+  }
+
+  bool accepts(glm::fvec4 const*, GLenum type) {
+    return type == GL_FLOAT_VEC4;
+  }
+  void upload(GLint location, GLsizei count, glm::fvec4 const* values) {
+    glUniform4fv(location, count, glm::value_ptr(*values));
+  }
+
+  bool accepts(glm::ivec2 const*, GLenum type) {
+    return type == GL_INT_VEC2 || type == GL_BOOL_VEC2;
+  }
+  void upload(GLint location, GLsizei count, glm::ivec2 const* values) {
+    glUniform2iv(location, count, glm::value_ptr(*values));
+  }
+
+  bool accepts(glm::ivec3 const*, GLenum type) {
+    return type == GL_INT_VEC3 || type == GL_BOOL_VEC3;
+  }
+  void upload(GLint location, GLsizei count, glm::ivec3 const* values) {
+    glUniform3iv(location, count, glm::value_ptr(*values));
+  }
+
+  bool accepts(glm::ivec4 const*, GLenum type) {
+    return type == GL_INT_VEC4 || type == GL_BOOL_VEC4;
+  }
+  void upload(GLint location, GLsizei count, glm::ivec4 const* values) {
+    glUniform4iv(location, count, glm::value_ptr(*values));
+  }
+
+  bool accepts(glm::fmat3 const*, GLenum type) {
+    return type == GL_FLOAT_MAT3;
+  }
+  void upload(GLint location, GLsizei count, glm::fmat3 const* values) {
+    glUniformMatrix3fv(location, count, GL_FALSE, glm::value_ptr(*values));
+  }
+
+  bool accepts(glm::fmat4 const*, GLenum type) {
+    return type == GL_FLOAT_MAT4;
+  }
+  void upload(GLint location, GLsizei count, glm::fmat4 const* values) {
+    glUniformMatrix4fv(location, count, GL_FALSE, glm::value_ptr(*values));
+  }
+}
+
+template<typename T>
+uniform_handle<T>::uniform_handle()
+ :m_program{nullptr}
+ ,m_name{}
+ ,m_generation{0}
+ ,m_location{-1}
+{}
+
+template<typename T>
+uniform_handle<T>::uniform_handle(shader_program const& program, std::string const& name)
+ :m_program{&program}
+ ,m_name{name}
+ ,m_generation{0}
+ ,m_location{-1}
+{}
+
+template<typename T>
+void uniform_handle<T>::resolve() const {
+  m_generation = m_program->generation;
+  m_location = -1;
+  for (auto const& uniform : m_program->uniforms) {
+    if (uniform.name != m_name) continue;
+    if (accepts(static_cast<T const*>(nullptr), uniform.type)) {
+      m_location = uniform.location;
+    }
+    else {
+      // output info similar to gl errors, dont throw to survive shader reloads
+      std::cerr << "OpenGL Error: uniform " << m_name << " in program " << m_program->handle
+                << " has type " << uniform.type << ", which does not match its handle" << std::endl;
+    }
+    return;
+  }
+  std::cerr << "OpenGL Error: " << m_name << " is not an active uniform variable in program "
+            << m_program->handle << std::endl;
+}
+
+template<typename T>
+void uniform_handle<T>::set(T const& value) const {
+  set(&value, 1);
+}
+
+template<typename T>
+void uniform_handle<T>::set(T const* values, GLsizei count) const {
+  GLint current = location();
+  if (current >= 0) {
+    upload(current, count, values);
+  }
+}
+
+GLuint uniform_block_index(shader_program const& program, std::string const& name) {
+  for (auto const& block : program.uniform_blocks) {
+    if (block.name == name) return block.index;
+  }
+  return GL_INVALID_INDEX;
+}
+
+template class uniform_handle<GLint>;
+template class uniform_handle<GLuint>;
+template class uniform_handle<GLfloat>;
+template class uniform_handle<glm::fvec2>;
+template class uniform_handle<glm::fvec3>;
+template class uniform_handle<glm::fvec4>;
+template class uniform_handle<glm::ivec2>;
+template class uniform_handle<glm::ivec3>;
+template class uniform_handle<glm::ivec4>;
+template class uniform_handle<glm::fmat3>;
+template class uniform_handle<glm::fmat4>;
@@ -1,4 +1,5 @@
 #include "utils.hpp"
+#include "mip_chain.hpp"
 #include "pixel_data.hpp"
 #include "structs.hpp"
 
@@ -6,20 +7,73 @@
 // use gl definitions from glbinding 
 using namespace gl;
 
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 #include <fstream>
+#include <stdexcept>
+#include <vector>
 
 namespace utils {
 
-texture_object create_texture_object(pixel_data const& tex) {
-  texture_object t_obj{};
+namespace {
+  // higher ratios cost bandwidth with barely visible gain
+  const GLfloat MAX_ANISOTROPY = 8.0f;
+}
+
+void set_mip_filtering(GLenum target, std::size_t level_num) {
+  glTexParameteri(target, GL_TEXTURE_BASE_LEVEL, 0);
+  glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, GLint(level_num - 1));
+  glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GLint(GL_LINEAR));
+  glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GLint(GL_LINEAR_MIPMAP_LINEAR));
+  if (has_extension("GL_EXT_texture_filter_anisotropic")) {
+    GLfloat max_anisotropy = 1.0f;
+    glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &max_anisotropy);
+    glTexParameterf(target, GL_TEXTURE_MAX_ANISOTROPY_EXT, std::min(max_anisotropy, MAX_ANISOTROPY));
+  }
+}
+
+texture_object create_texture_object(pixel_data const& tex, bool srgb) {
+  GLenum internal_format = GL_NONE;
+  if (tex.channels == GL_RED) internal_format = GL_R8;
+  else if (tex.channels == GL_RG) internal_format = GL_RG8;
+  else if (tex.channels == GL_RGB) internal_format = GL_RGB8;
+  else if (tex.channels == GL_RGBA) internal_format = GL_RGBA8;
+  else throw std::invalid_argument("Texture object: unsupported channel format");
 
-  throw std::logic_error("Texture Object creation not implemented yet");
+  std::vector<pixel_data> levels = mip_chain::build(tex, srgb);
 
+  texture_object t_obj{};
+  t_obj.target = GL_TEXTURE_2D;
+  glGenTextures(1, &t_obj.handle);
+  glBindTexture(GL_TEXTURE_2D, t_obj.handle);
+  GLint alignment = 4;
+  glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
+  // rows are tightly packed
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  // no immutable storage in GL 3.3, every level is specified once and the level range is fixed
+  for (std::size_t i = 0; i < levels.size(); ++i) {
+    glTexImage2D(GL_TEXTURE_2D, GLint(i), GLint(internal_format), GLsizei(levels[i].width), GLsizei(levels[i].height),
+                 0, tex.channels, GL_UNSIGNED_BYTE, levels[i].ptr());
+  }
+  glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+  set_mip_filtering(GL_TEXTURE_2D, levels.size());
+  glBindTexture(GL_TEXTURE_2D, 0);
   return t_obj;
 }
 
+bool has_extension(std::string const& name) {
+  GLint extension_num = 0;
+  glGetIntegerv(GL_NUM_EXTENSIONS, &extension_num);
+  for (GLint i = 0; i < extension_num; ++i) {
+    GLubyte const* extension = glGetStringi(GL_EXTENSIONS, GLuint(i));
+    if (extension != nullptr && name == reinterpret_cast<char const*>(extension)) {
+      return true;
+    }
+  }
+  return false;
+}
+
 void print_bound_textures() {
   GLint id1, id2, id3, active_unit, texture_units = 0;
   glGetIntegerv(GL_ACTIVE_TEXTURE, &active_unit);
@@ -1,7 +1,9 @@
 #version 150
 
+in vec4 pass_Color;
+
 out vec4 out_Color;
 
 void main() {
-  out_Color = vec4(1.0, 0.0, 0.0, 1.0);
+  out_Color = pass_Color;
 }
\ No newline at end of file
@@ -1,16 +1,19 @@
 #version 150
 #extension GL_ARB_explicit_attrib_location : require
-// glVertexAttribPointer mapped positions to first
+// attribute locations of line_batch
 layout(location = 0) in vec3 in_Position;
+layout(location = 1) in vec4 in_Color;
+// places instanced unit circles, identity for streamed lines and points
+layout(location = 2) in mat4 in_Transform;
 
 layout(std140) uniform ubo_data{
     mat4 ubo_view_matrix;
     mat4 ubo_projection_matrix;
 };
 
-//Matrix Uniforms uploaded with glUniform*
-uniform mat4 ModelMatrix;
+out vec4 pass_Color;
 
 void main() {
-	gl_Position = (ubo_projection_matrix  * ubo_view_matrix * ModelMatrix) * vec4(in_Position, 1.0);
+	gl_Position = (ubo_projection_matrix  * ubo_view_matrix * in_Transform) * vec4(in_Position, 1.0);
+	pass_Color = in_Color;
 }
\ No newline at end of file
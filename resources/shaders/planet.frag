@@ -1,9 +1,11 @@
 #version 150
 
-uniform sampler2D texDiffuse;
-uniform sampler2D texNormal;
+uniform sampler2DArray texDiffuse;
+uniform sampler2DArray texNormal;
 
-uniform int flags;          //control execution of shader
+flat in int pass_Flags;     //control execution of shader
+flat in int pass_Layer;     //array layer of diffuse map
+flat in int pass_NormalLayer; //array layer of normal map
 const int SHADE = 1;        //do Phong shading
 const int CEL = 2;          //do Cel shading
 const int NORMAL_MAP = 4;   //do normal mapping
@@ -48,18 +50,20 @@ vec3 specular(vec3 N, vec3 L, vec3 V)
 }
 
 void main() {
-    vec3 color = texture(texDiffuse, pass_TexCoord).rgb;
+    vec3 color = texture(texDiffuse, vec3(pass_TexCoord, pass_Layer)).rgb;
     vec3 l = normalize(toLight);
     vec3 v = normalize(toCamera);
     vec3 n = normalize(pass_Normal);
     
-    if ((flags & SHADE) > 0)
+    if ((pass_Flags & SHADE) > 0)
     {
-        if ((flags & NORMAL_MAP) > 0)
+        if ((pass_Flags & NORMAL_MAP) > 0)
         {
             //normal mapping calculations are done in tangent space
             //we convert necessary vectors here
-            vec3 ts_n = normalize(texture(texNormal, pass_TexCoord).rgb * 2.0 - 1.0);
+            //only x and y are stored, z of the unit normal is reconstructed
+            vec2 ts_xy = texture(texNormal, vec3(pass_TexCoord, pass_NormalLayer)).rg * 2.0 - 1.0;
+            vec3 ts_n = normalize(vec3(ts_xy, sqrt(max(0.0, 1.0 - dot(ts_xy, ts_xy)))));
             vec3 ts_l = normalize(TBN * l);
             vec3 ts_v = normalize(TBN * v);
             vec3 shading = ambient();
@@ -83,7 +87,7 @@ void main() {
         }
     }
     
-    if ((flags & CEL) > 0)
+    if ((pass_Flags & CEL) > 0)
     {
         //Cel shading - interior
         color = ceil(color * CEL_SHADES)/CEL_SHADES;
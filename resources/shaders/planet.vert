@@ -10,33 +10,42 @@ layout(std140) uniform ubo_data{
     mat4 ubo_view_matrix;
     mat4 ubo_projection_matrix;
 };
+// instance attributes, advanced once per drawn body
+layout(location = 5) in mat4 in_ModelMatrix;
+layout(location = 9) in mat3 in_NormalMatrix;
+layout(location = 12) in vec3 in_Color;
+layout(location = 13) in int in_Flags;
+layout(location = 14) in int in_Layer;
+layout(location = 15) in int in_NormalLayer;
 
-//Matrix Uniforms as specified with glUniformMatrix4fv
-uniform mat4 ModelMatrix;
-uniform mat4 NormalMatrix;
 uniform vec3 LightPosition;
-uniform vec3 Color;
 
 out vec3 pass_Normal;
 out vec2 pass_TexCoord;
 out vec3 pass_Color;
+flat out int pass_Flags;
+flat out int pass_Layer;
+flat out int pass_NormalLayer;
 out mat3 TBN;
 out vec3 toLight;
 out vec3 toCamera;
 
 void main(void)
 {
-    gl_Position = (ubo_projection_matrix * ubo_view_matrix * ModelMatrix) * vec4(in_Position, 1.0);
+    gl_Position = (ubo_projection_matrix * ubo_view_matrix * in_ModelMatrix) * vec4(in_Position, 1.0);
     
     //all computation is done in view space
-    vec4 viewSpacePosition = (ubo_view_matrix * ModelMatrix) * vec4(in_Position, 1.0);
+    vec4 viewSpacePosition = (ubo_view_matrix * in_ModelMatrix) * vec4(in_Position, 1.0);
     toCamera = normalize(-viewSpacePosition.xyz); //in view space camera position is always 0.0, 0.0, 0.0
     toLight = normalize((ubo_view_matrix * vec4(LightPosition, 1.0)).xyz - viewSpacePosition.xyz);
     
-    pass_Normal = normalize((NormalMatrix * vec4(in_Normal, 0.0)).xyz);
-    pass_Color = Color;
+    pass_Normal = normalize(in_NormalMatrix * in_Normal);
+    pass_Color = in_Color;
+    pass_Flags = in_Flags;
+    pass_Layer = in_Layer;
+    pass_NormalLayer = in_NormalLayer;
     pass_TexCoord = in_TexCoord;
-    vec3 tangent = normalize((NormalMatrix * vec4(in_Tangent, 0.0)).xyz);
+    vec3 tangent = normalize(in_NormalMatrix * in_Tangent);
     vec3 bitangent = cross(pass_Normal, tangent);
     TBN = transpose(mat3(tangent, bitangent, pass_Normal));
 }
@@ -4,5 +4,10 @@ in  vec3 pass_Color;
 out vec4 out_Color;
 
 void main() {
+  // round points, single pixel stars keep their center
+  vec2 offset = gl_PointCoord * 2.0 - 1.0;
+  if (dot(offset, offset) > 1.0) {
+    discard;
+  }
   out_Color = vec4(pass_Color, 1.0);
 }
\ No newline at end of file
@@ -1,18 +1,24 @@
 #version 150
 #extension GL_ARB_explicit_attrib_location : require
-// glVertexAttribPointer mapped positions to first
+// attribute locations of star_catalog
 layout(location = 0) in vec3 in_Position;
-// glVertexAttribPointer mapped color  to second attribute 
-layout(location = 1) in vec3 in_Color;
+layout(location = 1) in float in_Magnitude;
+layout(location = 2) in vec4 in_Color;
 
 layout(std140) uniform ubo_data{
     mat4 ubo_view_matrix;
     mat4 ubo_projection_matrix;
 };
 
+// magnitude of faintest drawn stars
+uniform float LimitMagnitude;
+
 out vec3 pass_Color;
 
 void main() {
     gl_Position = (ubo_projection_matrix  * ubo_view_matrix) * vec4(in_Position, 1.0);
-	pass_Color = in_Color;
+	// flux relative to the faintest stars, 5 magnitudes are a factor of 100
+	float flux = pow(10.0, 0.4 * (LimitMagnitude - in_Magnitude));
+	gl_PointSize = clamp(sqrt(flux) * 0.5, 1.0, 4.0);
+	pass_Color = in_Color.rgb * clamp(flux * 0.0625, 0.15, 1.0);
 }
\ No newline at end of file